@@ -0,0 +1,260 @@
+/*
+ * Time range queries of capture files
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#define _XOPEN_SOURCE 700
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "rpi_capture.h"
+
+#define NS	1000000000ULL
+
+static const char* ch_names[RPI_CAPTURE_CH] = {
+	"ax", "ay", "az", "gx", "gy", "gz", "mx", "my", "mz", "temp"
+};
+
+static rpi_capture_info_t info;
+
+static void usage(const char* prog) {
+	fprintf(stderr,
+		"Usage: %s FILE [-s SENSOR] [-f TIME] [-t TIME] [-a TIME [-w SEC]]\n"
+		"       [-d SEC] [-v]\n"
+		"  no range         capture summary\n"
+		"  -f, -t           from, to\n"
+		"  -a, -w           around TIME +- SEC, 1 s by default\n"
+		"  -d               mean/min/max/rms per SEC, 0: of the whole range,\n"
+		"                   raw samples without it\n"
+		"  -v               chunks decoded, to stderr\n"
+		"values in the units the capture was written with, raw counts\n"
+		"for sensors without one\n"
+		"TIME: YYYY-MM-DD HH:MM:SS[.frac]  local time\n"
+		"      HH:MM:SS[.frac]             on the day the capture starts\n"
+		"      +SEC, -SEC                  after the start, before the end\n",
+		prog);
+}
+
+// wall clock of ns since the epoch
+static const char* wall_str(uint64_t wall, char* s, size_t len) {
+	time_t sec = wall / NS;
+	struct tm tm;
+	size_t n;
+
+	localtime_r(&sec, &tm);
+	n = strftime(s, len, "%Y-%m-%d %H:%M:%S", &tm);
+	snprintf(s + n, len - n, ".%06u", (unsigned)(wall % NS / 1000));
+	return s;
+}
+
+// return 0: OK, *mono in ns of the samples
+static int parse_time(const char* arg, uint64_t* mono) {
+	struct tm tm;
+	time_t sec;
+	double frac = 0;
+	const char* p;
+
+	if (arg[0] == '+' || arg[0] == '-') {
+		double d = atof(arg + 1) * NS;
+
+		*mono = (arg[0] == '+')? info.t0 + (uint64_t)d: info.t1 - (uint64_t)d;
+		return 0;
+	}
+
+	sec = (info.t0 + info.epoch_ns) / NS;
+	localtime_r(&sec, &tm);
+	if ((p = strptime(arg, "%Y-%m-%d %H:%M:%S", &tm)) == NULL &&
+	    (p = strptime(arg, "%Y-%m-%dT%H:%M:%S", &tm)) == NULL &&
+	    (p = strptime(arg, "%H:%M:%S", &tm)) == NULL) {
+		return -1;
+	}
+	if (*p == '.') {
+		frac = atof(p);
+	} else if (*p != '\0') {
+		return -1;
+	}
+	tm.tm_isdst = -1;
+	if ((sec = mktime(&tm)) == (time_t)-1) {
+		return -1;
+	}
+	*mono = (uint64_t)sec * NS + (uint64_t)(frac * NS) - info.epoch_ns;
+	return 0;
+}
+
+// raw counts of channel k in the unit they were written in
+static double value(const rpi_capture_unit_t* u, int k, double raw) {
+	return raw * u->scale[k / 3] + u->offset[k / 3];
+}
+
+static int print_sample(void* arg, const rpi_sample_t* s,
+                        const rpi_capture_unit_t* u) {
+	char t[64];
+	int k;
+
+	printf("%s %04x", wall_str(s->ts + info.epoch_ns, t, sizeof t), s->flags);
+	for (k = 0; k < 3; k++) {
+		printf(" %10.4g", value(u, k, s->acc[k]));
+	}
+	for (k = 0; k < 3; k++) {
+		printf(" %10.4g", value(u, 3 + k, s->gyr[k]));
+	}
+	for (k = 0; k < 3; k++) {
+		printf(" %10.4g", value(u, 6 + k, s->mag[k]));
+	}
+	printf(" %10.4g\n", value(u, 9, s->temp));
+	return 0;
+}
+
+static void print_stats(uint64_t t, const rpi_capture_sum_t* sum,
+                        const rpi_capture_unit_t* u) {
+	double mean, ms, lo, hi, a, b;
+	char s[64];
+	int k;
+
+	printf("%s", wall_str(t + info.epoch_ns, s, sizeof s));
+	for (k = 0; k < RPI_CAPTURE_CH; k++) {
+		if (sum[k].n == 0) {
+			printf(" %6u - - - -", 0U);
+			continue;
+		}
+		// E[(a x + b)^2] = a^2 E[x^2] + 2ab E[x] + b^2
+		a = u->scale[k / 3];
+		b = u->offset[k / 3];
+		mean = (double)sum[k].sum / sum[k].n;
+		ms = a * a * sum[k].sumsq / sum[k].n + 2 * a * b * mean + b * b;
+		lo = value(u, k, (a < 0)? sum[k].max: sum[k].min);
+		hi = value(u, k, (a < 0)? sum[k].min: sum[k].max);
+		printf(" %6u %.4g %.4g %.4g %.4g", sum[k].n, value(u, k, mean),
+		       lo, hi, sqrt(ms > 0? ms: 0));
+	}
+	printf("\n");
+}
+
+static void print_info(rpi_capture_t* cap) {
+	char s[64];
+	int i;
+
+	printf("start   : %s\n", wall_str(info.t0 + info.epoch_ns, s, sizeof s));
+	printf("end     : %s\n", wall_str(info.t1 + info.epoch_ns, s, sizeof s));
+	printf("chunks  : %u, %.3lf s each at most, %s\n", info.chunks,
+	       info.period_ns * 1e-9, info.indexed? "indexed": "index rebuilt");
+	printf("sensors :");
+	for (i = 0; i < 32; i++) {
+		if (info.sensors & (1U << i)) {
+			printf(" %d", i);
+		}
+	}
+	printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+	rpi_capture_sum_t sum[RPI_CAPTURE_CH];
+	rpi_capture_unit_t unit;
+	rpi_capture_t* cap;
+	uint64_t from, to, at = 0, b, step = 0;
+	double win = 1.0;
+	int opt, sensor = 0, verbose = 0, around = 0, ranged = 0, stats = 0;
+	int rt = 0, decoded = 0, k;
+	const char* arg_from = NULL;
+	const char* arg_to = NULL;
+	const char* arg_at = NULL;
+
+	if (argc < 2 || argv[1][0] == '-') {
+		usage(argv[0]);
+		return 1;
+	}
+	if ((cap = rpi_capture_open(argv[1])) == NULL) {
+		fprintf(stderr, "%s: not a capture file\n", argv[1]);
+		return 1;
+	}
+	rpi_capture_info(cap, &info);
+	from = info.t0;
+	to = info.t1;
+
+	optind = 2;
+	while ((opt = getopt(argc, argv, "s:f:t:a:w:d:v")) != -1) {
+		switch (opt) {
+		case 's': sensor = atoi(optarg); break;
+		case 'f': arg_from = optarg; ranged = 1; break;
+		case 't': arg_to = optarg; ranged = 1; break;
+		case 'a': arg_at = optarg; around = ranged = 1; break;
+		case 'w': win = atof(optarg); break;
+		case 'd': step = atof(optarg) * NS; stats = ranged = 1; break;
+		case 'v': verbose = 1; break;
+		default: usage(argv[0]); rpi_capture_close(cap); return 1;
+		}
+	}
+	if ((arg_from && parse_time(arg_from, &from)) ||
+	    (arg_to && parse_time(arg_to, &to)) ||
+	    (arg_at && parse_time(arg_at, &at))) {
+		fprintf(stderr, "bad time\n");
+		rpi_capture_close(cap);
+		return 1;
+	}
+	if (around) {
+		from = at - (uint64_t)(win * NS);
+		to = at + (uint64_t)(win * NS);
+	}
+
+	if (!ranged) {
+		print_info(cap);
+	} else if (!stats) {
+		rt = rpi_capture_read(cap, sensor, from, to, print_sample, NULL);
+	} else {
+		printf("# time");
+		for (k = 0; k < RPI_CAPTURE_CH; k++) {
+			printf(" %s_n %s_mean %s_min %s_max %s_rms", ch_names[k],
+			       ch_names[k], ch_names[k], ch_names[k], ch_names[k]);
+		}
+		printf("\n");
+		// buckets aligned to the wall clock, like the chunks
+		b = step? from - (from + info.epoch_ns) % step: from;
+		for (; rt >= 0 && b <= to; b += step? step: to - b + 1) {
+			uint64_t end = step? b + step - 1: to;
+
+			rt = rpi_capture_stats(cap, sensor, (b < from)? from: b,
+			                       (end > to)? to: end, sum, &unit);
+			decoded += (rt > 0)? rt: 0;
+			if (rt >= 0 && sum[0].n + sum[3].n + sum[6].n + sum[9].n) {
+				print_stats(b, sum, &unit);
+			}
+		}
+	}
+	if (verbose) {
+		fprintf(stderr, "%d chunks decoded\n", decoded);
+	}
+	if (rt == RPI_CAPTURE_E_UNIT) {
+		fprintf(stderr, "%s: unit changed within the range, "
+		        "split it with -d\n", argv[1]);
+	} else if (rt < 0) {
+		fprintf(stderr, "%s: read error\n", argv[1]);
+	}
+	rpi_capture_close(cap);
+	return rt < 0? 1: 0;
+}
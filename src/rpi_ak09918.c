@@ -30,6 +30,8 @@
 #include <unistd.h>
 #include "rpi_ak09918.h"
 #include "rpi_i2c.h"
+#include "rpi_transport.h"
+#include "rpi_shadow.h"
 
 /***************************************************************
  AK09918 I2C Register
@@ -56,6 +58,30 @@
 #define AK09918_DOR_BIT     0x02    // Data Over Run
 #define AK09918_DRDY_BIT    0x01    // Data Ready
 
+#define AK09918_WIA1_ID     0x48    // Company ID of AKM
+
+static inline int ak_read_byte(rpi_ak09918_t* dev, uint8_t reg) {
+	return rpi_tr_read_byte(dev->tr, dev->addr, reg);
+}
+
+static inline int ak_read_word(rpi_ak09918_t* dev, uint8_t reg) {
+	return rpi_tr_read_word(dev->tr, dev->addr, reg);
+}
+
+static inline int ak_write_byte(rpi_ak09918_t* dev, uint8_t reg, uint8_t data) {
+	return rpi_tr_write_byte(dev->tr, dev->addr, reg, data);
+}
+
+static void ak_recover(rpi_ak09918_t* dev) {
+	// CNTL2 resets to power-down, only tells in continuous modes
+	uint8_t sentinel = (dev->mode >= AK09918_CONTINUOUS_10HZ &&
+	                    dev->mode <= AK09918_CONTINUOUS_100HZ)?
+	                   AK09918_CNTL2: AK09918_WIA1;
+
+	dev->status |= rpi_shadow_recover(&dev->shadow, dev->tr, dev->addr,
+		AK09918_WIA1, AK09918_WIA1_ID, sentinel);
+}
+
 static const char* ak09918_err_strings[] = {
 	"AK09918_ERR_OK: OK",
 	"AK09918_ERR_DOR: Data skipped(read too slowly)",
@@ -93,19 +119,53 @@ int rpi_ak09918_init(rpi_ak09918_t* dev,
 	int i2c_addr,
 	int mode
 ) {
-	int rt;
-
-	dev->addr = i2c_addr;
-	dev->mode = mode;
+	rpi_transport_t* tr;
 
-	if ((rt = rpi_i2c_init(i2c_dev)) < 0) {
+	if ((tr = rpi_transport_i2c_bus(i2c_dev)) == NULL) {
 		return -AK09918_ERR_READ_FAILED;
 	}
+	return rpi_ak09918_init_tr(dev, tr, i2c_addr, mode);
+}
+
+int rpi_ak09918_init_tr(rpi_ak09918_t* dev,
+	rpi_transport_t* tr,
+	int i2c_addr,
+	int mode
+) {
+	rpi_startup_t job;
+
+	rpi_ak09918_startup(&job, dev, tr, i2c_addr, mode);
+	rpi_startup_run(&job, 1);
+	return job.rt;
+}
+
+static int ak_startup_step(rpi_startup_t* job) {
+	rpi_ak09918_t* dev = job->dev;
 
 	rpi_ak09918_set_mode(dev, dev->mode);
 
-	rt = i2c_read_word(dev->addr, AK09918_WIA1);
-	return rt;
+	job->rt = ak_read_word(dev, AK09918_WIA1);
+	return RPI_STARTUP_DONE;
+}
+
+void rpi_ak09918_startup(rpi_startup_t* job,
+	rpi_ak09918_t* dev,
+	rpi_transport_t* tr,
+	int i2c_addr,
+	int mode
+) {
+	dev->addr = i2c_addr;
+	dev->mode = mode;
+	dev->tr = tr;
+	dev->status = 0;
+	dev->testing = 0;
+	rpi_shadow_clear(&dev->shadow);
+
+	job->step = ak_startup_step;
+	job->dev = dev;
+	job->tr = tr;
+	job->state = 0;
+	job->rt = 0;
 }
 
 int rpi_ak09918_get_mode(rpi_ak09918_t* dev) {
@@ -116,9 +176,10 @@ int rpi_ak09918_set_mode(
 	rpi_ak09918_t* dev,
 	AK09918_mode_type_t mode
 ) {
-	if (i2c_write_byte(dev->addr, AK09918_CNTL2, mode)) {
+	if (ak_write_byte(dev, AK09918_CNTL2, mode)) {
 		return AK09918_ERR_WRITE_FAILED;
 	}
+	rpi_shadow_set(&dev->shadow, AK09918_CNTL2, mode);
 	dev->mode = mode;
 	return AK09918_ERR_OK;
 }
@@ -126,7 +187,7 @@ int rpi_ak09918_set_mode(
 int rpi_ak09918_reset(rpi_ak09918_t* dev) {
 	int r;
 
-	r = i2c_write_byte(dev->addr, AK09918_CNTL3, AK09918_SRST_BIT);
+	r = ak_write_byte(dev, AK09918_CNTL3, AK09918_SRST_BIT);
 	if (r < 0) {
 		return AK09918_ERR_WRITE_FAILED;
 	}
@@ -136,7 +197,7 @@ int rpi_ak09918_reset(rpi_ak09918_t* dev) {
 int rpi_ak09918_is_ready(rpi_ak09918_t* dev) {
 	int reg;
 
-	reg = i2c_read_byte(dev->addr, AK09918_ST1);
+	reg = ak_read_byte(dev, AK09918_ST1);
 	if (reg < 0) {
 		return AK09918_ERR_READ_FAILED;
 	}
@@ -149,7 +210,7 @@ int rpi_ak09918_is_ready(rpi_ak09918_t* dev) {
 int rpi_ak09918_is_skip(rpi_ak09918_t* dev) {
 	int reg;
 
-	reg = i2c_read_byte(dev->addr, AK09918_ST1);
+	reg = ak_read_byte(dev, AK09918_ST1);
 	if (reg < 0) {
 		return AK09918_ERR_READ_FAILED;
 	}
@@ -170,19 +231,21 @@ int rpi_ak09918_read_raw(
 		int count = 0;
 
 		for (;;) {
-			rt = i2c_read_byte(dev->addr, AK09918_CNTL2);
+			rt = ak_read_byte(dev, AK09918_CNTL2);
 			if (rt == 0) {
 				break;
 			}
 			if (count++ >= 15) {
 				return AK09918_ERR_TIMEOUT;
 			}
-			rpi_delay_ms(1);
+			rpi_tr_delay_ms(dev->tr, 1);
 		}
 	}
 
-	rt = rpi_i2c_read(dev->addr, AK09918_HXL, buf, sizeof buf);
+	rt = rpi_tr_read(dev->tr, dev->addr, AK09918_HXL, buf, sizeof buf);
 	if (rt < 0) {
+		dev->status |= RPI_STATUS_COM_FAIL;
+		ak_recover(dev);
 		return AK09918_ERR_READ_FAILED;
 	}
 	*rx = *(int16_t*)&buf[0];
@@ -194,6 +257,58 @@ int rpi_ak09918_read_raw(
 	return AK09918_ERR_OK;
 }
 
+int rpi_ak09918_data_xfer(rpi_ak09918_t* dev, rpi_xfer_t* x, uint8_t* buf) {
+	// ST1 .. ST2, reading ST2 releases the data registers
+	x[0].dev = dev->addr;
+	x[0].reg = AK09918_ST1;
+	x[0].flags = RPI_XFER_READ;
+	x[0].len = AK09918_DATA_LEN;
+	x[0].data = buf;
+	if (dev->mode != AK09918_NORMAL) {
+		return 1;
+	}
+
+	// single measurement: start the next one right away
+	buf[AK09918_DATA_LEN] = AK09918_NORMAL;
+	x[1].dev = dev->addr;
+	x[1].reg = AK09918_CNTL2;
+	x[1].flags = RPI_XFER_WRITE;
+	x[1].len = 1;
+	x[1].data = &buf[AK09918_DATA_LEN];
+	return 2;
+}
+
+int rpi_ak09918_data_decode(rpi_ak09918_t* dev, const uint8_t* buf, rpi_sample_t* s) {
+	if (!(buf[0] & AK09918_DRDY_BIT) || dev->testing) {
+		return 0;
+	}
+	if (buf[0] & AK09918_DOR_BIT) {
+		dev->status |= RPI_STATUS_OVERFLOW;
+	}
+	// magnetic sensor overflow, the value is meaningless
+	if (buf[8] & AK09918_HOFL_BIT) {
+		return 0;
+	}
+	s->mag[0] = (int16_t)(buf[2] << 8 | buf[1]);
+	s->mag[1] = (int16_t)(buf[4] << 8 | buf[3]);
+	s->mag[2] = (int16_t)(buf[6] << 8 | buf[5]);
+	s->flags |= RPI_SAMPLE_MAG;
+	return 1;
+}
+
+int rpi_ak09918_plan(rpi_plan_t* plan, AK09918_mode_type_t mode) {
+	uint64_t ns;
+
+	switch (mode) {
+	case AK09918_CONTINUOUS_10HZ:  ns = 100000000; break;
+	case AK09918_CONTINUOUS_20HZ:  ns =  50000000; break;
+	case AK09918_CONTINUOUS_50HZ:  ns =  20000000; break;
+	case AK09918_CONTINUOUS_100HZ: ns =  10000000; break;
+	default: return -1;
+	}
+	return rpi_plan_add(plan, "ak09918", ns, AK09918_DATA_LEN, 0, 0) < 0? -1: 0;
+}
+
 int rpi_ak09918_read(
 	rpi_ak09918_t* dev,
 	double* x, double* y, double* z
@@ -214,50 +329,100 @@ int rpi_ak09918_read(
 // 3. Check Data Ready or not by polling DRDY bit of ST1 register.
 // 4. When Data Ready, proceed to the next step.
 //    Read measurement data. (HXL to HZH)
-int rpi_ak09918_self_test(rpi_ak09918_t* dev) {
-	uint8_t buf[8];
+/*
+ *   step 0: drop buffered data, power down	wait 1ms
+ *   step 1: self-test mode			wait 1ms
+ *   step 2: poll DRDY every 1ms, judge the result, restore the mode
+ */
+static int ak_selftest_step(rpi_startup_t* job) {
+	rpi_ak09918_t* dev = job->dev;
+	uint8_t buf[AK09918_DATA_LEN];
 	int32_t x, y, z;
-	int rt, l_mode;
+	int rt;
 
-	l_mode = dev->mode;
+	switch (job->state) {
+	case 0:
+		dev->testing = 1;
+		dev->saved_mode = dev->mode;
+		/* skip the buffer data or else self testing will failed */
+		rpi_tr_read(dev->tr, dev->addr, AK09918_ST1, buf, sizeof buf);
+		if ((rt = rpi_ak09918_set_mode(dev, AK09918_POWER_DOWN))) {
+			break;
+		}
+		job->state++;
+		return 1;
 
-	/* skip the buffer data or else self testing will failed */
-	rpi_ak09918_read_raw(dev, &x, &y, &z);
+	case 1:
+		if ((rt = rpi_ak09918_set_mode(dev, AK09918_SELF_TEST))) {
+			break;
+		}
+		job->state++;
+		return 1;
 
-	rt = rpi_ak09918_set_mode(dev, AK09918_POWER_DOWN);
-	rpi_delay_ms(1);
-	rt = rpi_ak09918_set_mode(dev, AK09918_SELF_TEST);
+	default:
+		if ((rt = rpi_ak09918_is_ready(dev)) == AK09918_ERR_NOT_RDY) {
+			if (job->state++ - 2 < AK09918_SELFTEST_MS) {
+				return 1;
+			}
+			rt = AK09918_ERR_TIMEOUT;
+			break;
+		}
+		if (rt != AK09918_ERR_OK) {
+			break;
+		}
 
-	for (;;) {
-		if ((rt = rpi_ak09918_is_ready(dev)) == AK09918_ERR_OK) {
+		/* HXL .. ST2, ST2 ends the measurement */
+		if (rpi_tr_read(dev->tr, dev->addr, AK09918_HXL, buf, 8) < 0) {
+			rt = AK09918_ERR_READ_FAILED;
 			break;
 		}
-		if (rt == AK09918_ERR_READ_FAILED) {
-			rpi_ak09918_set_mode(dev, l_mode);
-			return rt;
+		x = (int16_t)(buf[1] << 8 | buf[0]);
+		y = (int16_t)(buf[3] << 8 | buf[2]);
+		z = (int16_t)(buf[5] << 8 | buf[4]);
+
+		if (( -200 <= x && x <= 200 ) &&
+		    ( -200 <= y && y <= 200 ) &&
+		    (-1000 <= z && z <= -150)
+		) {
+			rt = AK09918_ERR_OK;
+		} else {
+			rt = AK09918_ERR_SELFTEST_FAILED;
 		}
-		rpi_delay_ms(1);
+		break;
 	}
 
-	rt = rpi_i2c_read(dev->addr, AK09918_HXL, buf, sizeof buf);
-	if (rt < 0) {
-		rpi_ak09918_set_mode(dev, l_mode);
-		return AK09918_ERR_READ_FAILED;
-	}
-	x = *(int16_t*)&buf[0];
-	y = *(int16_t*)&buf[2];
-	z = *(int16_t*)&buf[4];
-
-	if (( -200 <= x && x <= 200 ) &&
-	    ( -200 <= y && y <= 200 ) &&
-	    (-1000 <= z && z <= -150)
-	) {
-		rt = AK09918_ERR_OK;
-	} else {
-		rt = AK09918_ERR_SELFTEST_FAILED;
-	}
+	rpi_ak09918_set_mode(dev, dev->saved_mode);
+	dev->testing = 0;
+	job->rt = rt;
+	return RPI_STARTUP_DONE;
+}
 
-	rpi_ak09918_set_mode(dev, l_mode);
-	return rt;
+void rpi_ak09918_selftest(rpi_startup_t* job, rpi_ak09918_t* dev) {
+	job->step = ak_selftest_step;
+	job->dev = dev;
+	job->tr = dev->tr;
+	job->state = 0;
+	job->rt = 0;
+	job->due = 0;
 }
 
+int rpi_ak09918_self_test(rpi_ak09918_t* dev) {
+	rpi_startup_t job;
+
+	rpi_ak09918_selftest(&job, dev);
+	rpi_startup_run(&job, 1);
+	return job.rt;
+}
+
+int rpi_ak09918_status(rpi_ak09918_t* dev) {
+	int status = dev->status;
+
+	dev->status = 0;
+	return status;
+}
+
+int rpi_ak09918_recover(rpi_ak09918_t* dev) {
+	ak_recover(dev);
+	return (dev->status & RPI_STATUS_LOST)?
+	       AK09918_ERR_READ_FAILED: AK09918_ERR_OK;
+}
@@ -30,10 +30,22 @@
 #define __RPI_AK09918_H__
 
 #include <stdint.h>
+#include "rpi_transport.h"
+#include "rpi_shadow.h"
+#include "rpi_startup.h"
+#include "rpi_sample.h"
+#include "rpi_plan.h"
 
 
 #define AK09918_I2C_ADDR	0x0C	// I2C address (Can't be changed)
 
+// ST1 .. ST2 burst, and the buffer rpi_ak09918_data_xfer() needs
+#define AK09918_DATA_LEN	9
+#define AK09918_DATA_BUF	(AK09918_DATA_LEN + 1)
+
+// self-test result wait, the measurement takes about 8ms
+#define AK09918_SELFTEST_MS	20
+
 // #define AK09918_MEASURE_PERIOD 9	// Must not be changed
 // AK09918 has following seven operation modes:
 // (1) Power-down mode: AK09918 doesn't measure
@@ -68,6 +80,11 @@ typedef enum {
 typedef struct {
 	uint8_t addr;
 	uint8_t mode;
+	rpi_transport_t* tr;
+	rpi_shadow_t shadow;
+	uint8_t status;
+	uint8_t testing;	// self-test running, no data
+	uint8_t saved_mode;	// to restore after it
 } rpi_ak09918_t;
 
 void* rpi_ak09918_alloc(void);
@@ -82,6 +99,23 @@ int rpi_ak09918_init(
 	int mode
 );
 
+// same as rpi_ak09918_init(), on any bus transport
+int rpi_ak09918_init_tr(
+	rpi_ak09918_t* dev,
+	rpi_transport_t* tr,
+	int i2c_addr,
+	int mode
+);
+
+// init as a job of rpi_startup_run(), with other devices
+void rpi_ak09918_startup(
+	rpi_startup_t* job,
+	rpi_ak09918_t* dev,
+	rpi_transport_t* tr,
+	int i2c_addr,
+	int mode
+);
+
 // get the working mode of AK09918
 int rpi_ak09918_get_mode(rpi_ak09918_t* dev);
 
@@ -115,7 +149,32 @@ int rpi_ak09918_read_raw(
 	int32_t *rx, int32_t *ry, int32_t *rz
 );
 
-// Start a self-test, if pass, return AK09918_ERR_OK
+// Start a self-test, if pass, return AK09918_ERR_OK,
+// AK09918_ERR_TIMEOUT if no result within AK09918_SELFTEST_MS
 int rpi_ak09918_self_test(rpi_ak09918_t* dev);
 
+// the same self-test as a job for rpi_startup_poll(), the data
+// stream of dev is paused while it runs, then the mode restored
+void rpi_ak09918_selftest(rpi_startup_t* job, rpi_ak09918_t* dev);
+
+// RPI_STATUS_* since last call
+int rpi_ak09918_status(rpi_ak09918_t* dev);
+
+// check the chip and apply the working mode again if it was reset
+int rpi_ak09918_recover(rpi_ak09918_t* dev);
+
+// The data burst as transactions of a caller's batch,
+// x: room for 2, buf: AK09918_DATA_BUF bytes.
+// In single measurement mode the next measurement is started too.
+// Not while dev->testing: it would clear the DRDY of the self-test.
+// return transactions filled in
+int rpi_ak09918_data_xfer(rpi_ak09918_t* dev, rpi_xfer_t* x, uint8_t* buf);
+
+// after the batch, return 1: new field in s->mag, 0: no new data
+int rpi_ak09918_data_decode(rpi_ak09918_t* dev, const uint8_t* buf, rpi_sample_t* s);
+
+// the data burst of a continuous mode as a stream of plan
+// return 0: OK, <0: not a continuous mode or plan full
+int rpi_ak09918_plan(rpi_plan_t* plan, AK09918_mode_type_t mode);
+
 #endif//__RPI_AK09918_H__
@@ -0,0 +1,117 @@
+/*
+ * ICM20600 + AK09918 9-DoF board as one device
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <string.h>
+#include "rpi_akicm.h"
+#include "rpi_shadow.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NS_PER_MS	1000000ULL
+
+// field period of the AK09918 mode, single: conversion time
+static uint64_t mag_period(int mode) {
+	switch (mode) {
+	case AK09918_CONTINUOUS_10HZ:  return 100 * NS_PER_MS;
+	case AK09918_CONTINUOUS_20HZ:  return  50 * NS_PER_MS;
+	case AK09918_CONTINUOUS_50HZ:  return  20 * NS_PER_MS;
+	case AK09918_CONTINUOUS_100HZ: return  10 * NS_PER_MS;
+	case AK09918_NORMAL:           return  10 * NS_PER_MS;
+	default:                       return   0;
+	}
+}
+
+int rpi_akicm_init(rpi_akicm_t* dev, rpi_icm20600_t* icm, rpi_ak09918_t* ak) {
+	if (icm->tr != ak->tr) {
+		return -1;
+	}
+	memset(dev, 0, sizeof *dev);
+	dev->icm = icm;
+	dev->ak = ak;
+	dev->mag_period = mag_period(ak->mode);
+	return 0;
+}
+
+int rpi_akicm_read(void* arg, rpi_sample_t* s) {
+	rpi_akicm_t* dev = arg;
+	rpi_transport_t* tr = dev->icm->tr;
+	uint8_t icm_buf[ICM20600_DATA_LEN];
+	uint8_t ak_buf[AK09918_DATA_BUF];
+	rpi_xfer_t x[3];
+	uint64_t t0, t1;
+	int n, mag, trig = 0;
+
+	rpi_icm20600_data_xfer(dev->icm, &x[0], icm_buf);
+	n = 1;
+
+	t0 = rpi_tr_timestamp(tr);
+	// the AK09918 only when a new field can be there, and not during
+	// its self-test: reading ST2 would take the DRDY the test waits for
+	mag = dev->mag_period && t0 >= dev->mag_due && !dev->ak->testing;
+	if (mag) {
+		// a second transfer starts the next single measurement
+		trig = rpi_ak09918_data_xfer(dev->ak, &x[n], ak_buf) > 1;
+		n += 1 + trig;
+	}
+
+	if (rpi_tr_batch(tr, x, n) != RPI_TR_OK) {
+		dev->icm->status |= RPI_STATUS_COM_FAIL;
+		rpi_icm20600_recover(dev->icm);
+		if (mag) {
+			dev->ak->status |= RPI_STATUS_COM_FAIL;
+			rpi_ak09918_recover(dev->ak);
+		}
+		return RPI_TR_FAIL;
+	}
+	t1 = rpi_tr_timestamp(tr);
+	s->ts = t0 + (t1 - t0) / 2;
+
+	s->flags = 0;
+	rpi_icm20600_data_decode(dev->icm, icm_buf, s);
+
+	if (mag && rpi_ak09918_data_decode(dev->ak, ak_buf, s)) {
+		memcpy(dev->mag, s->mag, sizeof dev->mag);
+		dev->mag_valid = 1;
+		trig = 1;
+	} else {
+		// continuous with DRDY clear: due again at the next call
+		memcpy(s->mag, dev->mag, sizeof s->mag);
+	}
+	// a field read, or a conversion started: a little early rather
+	// than a field late
+	if (trig) {
+		dev->mag_due = t0 + dev->mag_period - dev->mag_period / 8;
+	}
+	return RPI_TR_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,72 @@
+/*
+ * ICM20600 + AK09918 9-DoF board as one device
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_AKICM_H__
+#define __RPI_AKICM_H__
+
+#include <stdint.h>
+#include "rpi_icm20600.h"
+#include "rpi_ak09918.h"
+#include "rpi_sample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Both chips of the Grove IMU 9DoF board, read with one batch:
+ * the ICM20600 data block and, when a new field is due, the
+ * AK09918 ST1..ST2 block.
+ */
+typedef struct {
+	rpi_icm20600_t* icm;
+	rpi_ak09918_t* ak;
+	uint64_t mag_period;	// ns between AK09918 fields
+	uint64_t mag_due;	// next time the AK09918 is read
+	uint8_t mag_valid;	// mag[] holds a field
+	int16_t mag[3];		// last field, 0 before the first
+} rpi_akicm_t;
+
+// both initialized on the same transport
+// return 0: OK, -1: not on one bus
+int rpi_akicm_init(rpi_akicm_t* dev, rpi_icm20600_t* icm, rpi_ak09918_t* ak);
+
+/*
+ * One 9-DoF sample, raw, stamped with the middle of the batch.
+ * s->flags tells what is new in this call; s->mag keeps the last
+ * field when no new one was due or ready.
+ * As rpi_sample_fn for rpi_array_add().
+ * return 0: OK, <0: bus error
+ */
+int rpi_akicm_read(void* dev, rpi_sample_t* s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_AKICM_H__
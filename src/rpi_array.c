@@ -0,0 +1,244 @@
+/*
+ * Sensor array over several buses
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <sched.h>
+#include "rpi_array.h"
+#include "rpi_transport.h"
+#include "rpi_trace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void* bus_worker(void* arg) {
+	rpi_array_bus_t* bus = arg;
+	rpi_array_t* arr = bus->arr;
+	rpi_array_sensor_t* sn;
+	rpi_sample_t s;
+	uint64_t next, t0, t1;
+	int i;
+
+	#if RPI_TRACE
+	char name[16];
+
+	snprintf(name, sizeof name, "bus %d", bus->index);
+	rpi_trace_thread(name);
+	#endif
+
+	bus->rt.cpu = bus->cpu;
+	bus->rt_refused = rpi_rt_enter(&bus->rt);
+
+	next = rpi_time_ns();
+	while (__atomic_load_n(&arr->running, __ATOMIC_ACQUIRE)) {
+		for (i = 0; i < arr->sensors; i++) {
+			sn = &arr->sensor[i];
+			if (sn->bus != bus->index) {
+				continue;
+			}
+
+			memset(&s, 0, sizeof s);
+			t0 = rpi_time_ns();
+			if (sn->read(sn->dev, &s) < 0) {
+				sn->errors++;
+				continue;
+			}
+			t1 = rpi_time_ns();
+			// middle of the transaction
+			s.ts = t0 + (t1 - t0) / 2;
+			s.sensor = i;
+			RPI_TRACE_BEGIN(RPI_TRACE_ENQUEUE);
+			if (rpi_ring_push(&sn->ring, &s) < 0) {
+				sn->dropped++;
+			}
+			RPI_TRACE_END(RPI_TRACE_ENQUEUE);
+		}
+		// later samples of this bus are stamped after this
+		__atomic_store_n(&bus->mark, rpi_time_ns(), __ATOMIC_RELEASE);
+
+		next += arr->period;
+		if (next < rpi_time_ns()) {
+			// too slow for the period, skip the missed cycles
+			bus->overruns++;
+			next = rpi_time_ns();
+			continue;
+		}
+		rpi_rt_sleep_until(next);
+		// how late the poll cycle started
+		t0 = rpi_time_ns();
+		rpi_rt_jitter_add(&bus->jitter, t0 - next);
+		RPI_TRACE_SPAN(RPI_TRACE_WAKE, next, t0);
+	}
+
+	// nothing more will come from this bus
+	__atomic_store_n(&bus->mark, UINT64_MAX, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+int rpi_array_init(rpi_array_t* arr, uint32_t period_us, uint32_t ring_size) {
+	memset(arr, 0, sizeof *arr);
+	arr->period = (uint64_t)period_us * 1000;
+	arr->ring_size = ring_size;
+	return 0;
+}
+
+int rpi_array_bus(rpi_array_t* arr, int cpu) {
+	rpi_array_bus_t* bus;
+
+	if (arr->buses >= RPI_ARRAY_MAX_BUS) {
+		return -1;
+	}
+	bus = &arr->bus[arr->buses];
+	bus->arr = arr;
+	bus->index = arr->buses;
+	bus->cpu = cpu;
+	bus->mark = 0;
+	// pinning only
+	memset(&bus->rt, 0, sizeof bus->rt);
+	bus->rt.policy = SCHED_OTHER;
+	return arr->buses++;
+}
+
+int rpi_array_bus_rt(rpi_array_t* arr, int bus, const rpi_rt_cfg_t* cfg) {
+	if (arr->running || bus < 0 || bus >= arr->buses) {
+		return -1;
+	}
+	arr->bus[bus].rt = *cfg;
+	return 0;
+}
+
+int rpi_array_add(rpi_array_t* arr, int bus, rpi_sample_fn read, void* dev) {
+	rpi_array_sensor_t* sn;
+
+	if (arr->running || bus < 0 || bus >= arr->buses ||
+	    arr->sensors >= RPI_ARRAY_MAX_SENSOR) {
+		return -1;
+	}
+	sn = &arr->sensor[arr->sensors];
+	sn->bus = bus;
+	sn->read = read;
+	sn->dev = dev;
+	sn->errors = sn->dropped = 0;
+	if (rpi_ring_init(&sn->ring, arr->ring_size, sizeof(rpi_sample_t)) < 0) {
+		return -1;
+	}
+	return arr->sensors++;
+}
+
+// stop and join the first count workers
+static void array_join(rpi_array_t* arr, int count) {
+	int i;
+
+	__atomic_store_n(&arr->running, 0, __ATOMIC_RELEASE);
+	for (i = 0; i < count; i++) {
+		pthread_join(arr->bus[i].thread, NULL);
+	}
+}
+
+int rpi_array_start(rpi_array_t* arr) {
+	int i;
+
+	if (arr->running) {
+		return -1;
+	}
+	arr->running = 1;
+	for (i = 0; i < arr->buses; i++) {
+		arr->bus[i].mark = 0;
+		memset(&arr->bus[i].jitter, 0, sizeof arr->bus[i].jitter);
+		if (pthread_create(&arr->bus[i].thread, NULL, bus_worker, &arr->bus[i])) {
+			// the buses stay configured, a later start may succeed
+			array_join(arr, i);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int rpi_array_stop(rpi_array_t* arr) {
+	if (!arr->running) {
+		return 0;
+	}
+	array_join(arr, arr->buses);
+	return 0;
+}
+
+void rpi_array_free(rpi_array_t* arr) {
+	int i;
+
+	rpi_array_stop(arr);
+	for (i = 0; i < arr->sensors; i++) {
+		rpi_ring_free(&arr->sensor[i].ring);
+	}
+	arr->sensors = 0;
+}
+
+int rpi_array_read(rpi_array_t* arr, rpi_sample_t* out, int max) {
+	rpi_array_sensor_t* sn;
+	rpi_sample_t* p;
+	rpi_sample_t* best;
+	uint64_t bound, mark;
+	int i, n, pick;
+
+	for (n = 0; n < max; n++) {
+		best = NULL;
+		pick = -1;
+		bound = UINT64_MAX;
+
+		for (i = 0; i < arr->sensors; i++) {
+			sn = &arr->sensor[i];
+			// the mark first: an empty ring after it is really empty
+			mark = __atomic_load_n(&arr->bus[sn->bus].mark, __ATOMIC_ACQUIRE);
+			if ((p = rpi_ring_peek(&sn->ring)) == NULL) {
+				if (mark < bound) {
+					bound = mark;
+				}
+				continue;
+			}
+			if (best == NULL || p->ts < best->ts) {
+				best = p;
+				pick = i;
+			}
+		}
+
+		// an idle bus may still deliver something older
+		if (best == NULL || best->ts > bound) {
+			break;
+		}
+		out[n] = *best;
+		rpi_ring_drop(&arr->sensor[pick].ring);
+		// end to end, the sample timestamp is mid transaction
+		RPI_TRACE_SPAN(RPI_TRACE_DEQUEUE, out[n].ts, rpi_time_ns());
+	}
+	return n;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Sensor array over several buses
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_ARRAY_H__
+#define __RPI_ARRAY_H__
+
+#include <stdint.h>
+#include <pthread.h>
+#include "rpi_sample.h"
+#include "rpi_ring.h"
+#include "rpi_rt.h"
+
+#define RPI_ARRAY_MAX_BUS	8
+#define RPI_ARRAY_MAX_SENSOR	32
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rpi_array rpi_array_t;
+
+// one acquisition worker, reads its sensors in turn
+typedef struct {
+	rpi_array_t* arr;
+	int index;
+	int cpu;		// pinned to, -1: not pinned
+	rpi_rt_cfg_t rt;	// rpi_array_bus_rt(), policy SCHED_OTHER: off
+	int rt_refused;		// RPI_RT_NO_* the worker did not get
+	pthread_t thread;
+	// everything this worker read before it is in the rings
+	uint64_t mark;
+	uint32_t overruns;	// cycles longer than the period
+	rpi_rt_jitter_t jitter;	// wake-ups late against the period
+} rpi_array_bus_t;
+
+typedef struct {
+	int bus;
+	rpi_sample_fn read;
+	void* dev;
+	rpi_ring_t ring;	// worker -> rpi_array_read()
+	uint32_t errors;
+	uint32_t dropped;	// ring full
+} rpi_array_sensor_t;
+
+struct rpi_array {
+	uint64_t period;	// ns
+	uint32_t ring_size;
+	int running;
+	int buses;
+	int sensors;
+	rpi_array_bus_t bus[RPI_ARRAY_MAX_BUS];
+	rpi_array_sensor_t sensor[RPI_ARRAY_MAX_SENSOR];
+};
+
+/*
+ * Sensors on different buses are sampled in parallel, one thread per
+ * bus; rpi_array_read() merges them into a single stream ordered by
+ * timestamp.
+ *   period_us: sampling period of every sensor
+ *   ring_size: samples buffered per sensor
+ */
+int rpi_array_init(rpi_array_t* arr, uint32_t period_us, uint32_t ring_size);
+
+// a worker for one bus, cpu: core to run on or -1
+// return bus index, <0: too many buses
+int rpi_array_bus(rpi_array_t* arr, int cpu);
+
+/*
+ * Run the worker of bus in real-time, before rpi_array_start(),
+ * cfg->cpu is replaced by the core of rpi_array_bus(). Refused
+ * steps do not stop the worker, see rpi_array_bus_t.rt_refused.
+ * return 0: OK, <0: no such bus or running
+ */
+int rpi_array_bus_rt(rpi_array_t* arr, int bus, const rpi_rt_cfg_t* cfg);
+
+/*
+ * A sensor already initialized on that bus, eg.
+ *   rpi_array_add(arr, bus, rpi_bmi088_sample, &bmi088);
+ * All sensors of one bus must be added to the same worker.
+ * return sensor index, <0: error
+ */
+int rpi_array_add(rpi_array_t* arr, int bus, rpi_sample_fn read, void* dev);
+
+// start the workers, return 0: OK, <0: error
+int rpi_array_start(rpi_array_t* arr);
+
+// stop and join the workers, buffered samples stay readable
+int rpi_array_stop(rpi_array_t* arr);
+
+void rpi_array_free(rpi_array_t* arr);
+
+/*
+ * Non-blocking, up to max samples of all sensors in timestamp order.
+ * A sample is only handed out once no worker can deliver an older one.
+ * return samples written
+ */
+int rpi_array_read(rpi_array_t* arr, rpi_sample_t* out, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_ARRAY_H__
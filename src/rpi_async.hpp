@@ -0,0 +1,395 @@
+/*
+ * Coroutine reads of the sensors on one epoll thread
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_ASYNC_HPP__
+#define __RPI_ASYNC_HPP__
+
+#include <coroutine>
+#include <exception>
+#include <vector>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#include "rpi_imu.hpp"
+
+extern "C" {
+#include "rpi_transport.h"
+#include "rpi_block.h"
+#include "rpi_gpio.h"
+#include "rpi_icm20600.h"
+#include "rpi_ak09918.h"
+#if __has_include("bmi08x.h")
+#include "rpi_bmi088.h"
+#endif
+}
+
+/*
+ * Header-only, needs C++20.
+ *
+ * One thread runs a reactor, every sensor is a coroutine waiting on
+ * its trigger: the INT pin as a GPIO event fd, or a timerfd for
+ * sensors read on a schedule. A wake-up resumes the coroutine right
+ * in reactor::run(), no thread switch, no queue in between.
+ *
+ * Usage:
+ *   rpi::reactor r;
+ *   rpi::trigger drdy(rpi_gpio_event_open("/dev/gpiochip0", 17, RPI_GPIO_RISING));
+ *   rpi::trigger every(rpi::period{ 10000000 });
+ *   rpi::async_sensor<rpi_icm20600_t> imu(r, icm.handle(), drdy);
+ *   rpi::async_sensor<rpi_ak09918_t> mag(r, &ak, every);
+ *
+ *   rpi::task stream(rpi::async_sensor<rpi_icm20600_t>& imu) {
+ *       rpi_block_t* b = ...;
+ *       for (;;) {
+ *           if (co_await imu.next_batch(b) < 0) co_return;
+ *           ...
+ *       }
+ *   }
+ *   stream(imu);
+ *   r.run();
+ */
+namespace rpi {
+
+// started at once, runs on the reactor thread, frame freed at the end
+struct task {
+	struct promise_type {
+		task get_return_object() { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+/*
+ * epoll over the fds coroutines wait on, one waiter per fd, armed
+ * one shot. Not thread safe: arm and run on the same thread.
+ */
+class reactor: noncopyable {
+public:
+	static constexpr int EVENTS = 16;
+
+	reactor(): ep_(epoll_create1(EPOLL_CLOEXEC)), armed_(0), stop_(false) {}
+	~reactor() {
+		if (ep_ >= 0) {
+			close(ep_);
+		}
+	}
+
+	explicit operator bool() const { return ep_ >= 0; }
+
+	// resume h once fd is readable, return 0: OK, <0: epoll error
+	int arm(int fd, std::coroutine_handle<> h) {
+		struct epoll_event ev;
+
+		if (fd < 0) {
+			return -1;
+		}
+		if ((size_t)fd >= waiter_.size()) {
+			waiter_.resize(fd + 1, nullptr);
+		}
+		ev.events = EPOLLIN | EPOLLONESHOT;
+		ev.data.fd = fd;
+		if (epoll_ctl(ep_, EPOLL_CTL_MOD, fd, &ev) < 0 &&
+		    (errno != ENOENT || epoll_ctl(ep_, EPOLL_CTL_ADD, fd, &ev) < 0)) {
+			return -1;
+		}
+		// armed again before it fired: the new waiter replaces the old
+		if (waiter_[fd] == nullptr) {
+			armed_++;
+		}
+		waiter_[fd] = h.address();
+		return 0;
+	}
+
+	/*
+	 * Before fd is closed. A coroutine still waiting on it is
+	 * dropped, never resumed, and no longer counts for run().
+	 */
+	void forget(int fd) {
+		epoll_ctl(ep_, EPOLL_CTL_DEL, fd, NULL);
+		if (fd >= 0 && (size_t)fd < waiter_.size() && waiter_[fd] != nullptr) {
+			waiter_[fd] = nullptr;
+			armed_--;
+		}
+	}
+
+	struct readable {
+		reactor& r;
+		int fd;
+		int rt;
+
+		bool await_ready() { return false; }
+		bool await_suspend(std::coroutine_handle<> h) {
+			return (rt = r.arm(fd, h)) == 0;
+		}
+		int await_resume() { return rt; }
+	};
+
+	// co_await r.wait(fd): 0 once fd is readable, <0 error
+	readable wait(int fd) { return readable{ *this, fd, 0 }; }
+
+	/*
+	 * Resume what is ready within timeout_ms (-1: forever),
+	 * return coroutines resumed, <0: epoll error
+	 */
+	int run_once(int timeout_ms) {
+		struct epoll_event ev[EVENTS];
+		int i, n, resumed;
+
+		if ((n = epoll_wait(ep_, ev, EVENTS, timeout_ms)) < 0) {
+			return errno == EINTR? 0: -1;
+		}
+		for (i = 0, resumed = 0; i < n; i++) {
+			void* h = waiter_[ev[i].data.fd];
+
+			// forgotten by a coroutine resumed before it
+			if (h == nullptr) {
+				continue;
+			}
+			waiter_[ev[i].data.fd] = nullptr;
+			armed_--;
+			resumed++;
+			std::coroutine_handle<>::from_address(h).resume();
+		}
+		return resumed;
+	}
+
+	// until stop() or nobody waits any more, return 0: OK, <0: epoll error
+	int run() {
+		stop_ = false;
+		while (!stop_ && armed_ > 0) {
+			if (run_once(-1) < 0) {
+				return -1;
+			}
+		}
+		return 0;
+	}
+
+	// from a coroutine, waiting ones stay suspended for the next run()
+	void stop() { stop_ = true; }
+
+	int armed() const { return armed_; }
+
+private:
+	int ep_;
+	int armed_;
+	bool stop_;
+	std::vector<void*> waiter_;	// by fd, armed one shot
+};
+
+// timerfd schedule of a trigger
+struct period {
+	uint64_t ns;
+	uint64_t phase_ns = 0;	// first one at now + phase_ns, 0: now + ns
+};
+
+/*
+ * What wakes a sensor up: edges of its INT pin (data ready, FIFO
+ * watermark) from rpi_gpio_event_open(), left open for the caller,
+ * or a timerfd of its own on CLOCK_MONOTONIC.
+ */
+class trigger: noncopyable {
+public:
+	explicit trigger(int gpio_fd): fd_(gpio_fd), timer_(false) {}
+
+	explicit trigger(period p): timer_(true) {
+		struct itimerspec its;
+		uint64_t first = p.phase_ns? p.phase_ns: p.ns;
+
+		its.it_interval.tv_sec = p.ns / 1000000000ULL;
+		its.it_interval.tv_nsec = p.ns % 1000000000ULL;
+		its.it_value.tv_sec = first / 1000000000ULL;
+		its.it_value.tv_nsec = first % 1000000000ULL;
+		fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if (fd_ >= 0 && timerfd_settime(fd_, 0, &its, NULL) < 0) {
+			close(fd_);
+			fd_ = -1;
+		}
+	}
+
+	~trigger() {
+		if (timer_ && fd_ >= 0) {
+			close(fd_);
+		}
+	}
+
+	explicit operator bool() const { return fd_ >= 0; }
+	int fd() const { return fd_; }
+
+	/*
+	 * After fd turned readable: events since the last take(), *ts the
+	 * time of the latest; return 0: none after all, <0: error
+	 */
+	int take(uint64_t* ts) {
+		uint64_t n;
+		int rt, count = 0;
+
+		if (timer_) {
+			if (read(fd_, &n, sizeof n) != sizeof n) {
+				return errno == EAGAIN? 0: -1;
+			}
+			*ts = rpi_time_ns();
+			return (int)n;
+		}
+		while ((rt = rpi_gpio_event_wait(fd_, 0, ts)) > 0) {
+			count++;
+		}
+		return rt < 0? rt: count;
+	}
+
+private:
+	int fd_;
+	bool timer_;
+};
+
+/*
+ * Reads of the drivers into a block, rows added or <0: bus error.
+ * ts: time of the trigger; sample_ns: period of FIFO rows, 0: the
+ * driver's from its configuration, which follows a reconfigure.
+ */
+inline int async_add(rpi_block_t* b, rpi_sample_t& s, uint64_t ts) {
+	s.ts = ts;
+	s.sensor = b->sensor;
+	return rpi_block_add(b, &s) < 0? 0: 1;
+}
+
+// FIFO running: all of it, else one sample of the data registers
+inline int async_fill(rpi_icm20600_t* dev, rpi_block_t* b, uint64_t ts, uint64_t sample_ns) {
+	rpi_sample_t s;
+
+	if (dev->fifo) {
+		return rpi_icm20600_fifo_block(dev, b, sample_ns);
+	}
+	if (rpi_block_room(b) == 0) {
+		return 0;
+	}
+	if (rpi_icm20600_sample(dev, &s) != RPI_TR_OK) {
+		return RPI_TR_FAIL;
+	}
+	return async_add(b, s, ts);
+}
+
+inline int async_fill(rpi_ak09918_t* dev, rpi_block_t* b, uint64_t ts, uint64_t) {
+	uint8_t buf[AK09918_DATA_BUF];
+	rpi_xfer_t x[2];
+	rpi_sample_t s;
+	int n;
+
+	// the self-test polls DRDY itself, a read of ST2 here clears it
+	if (dev->testing || rpi_block_room(b) == 0) {
+		return 0;
+	}
+	n = rpi_ak09918_data_xfer(dev, x, buf);
+	if (rpi_tr_batch(dev->tr, x, n) != RPI_TR_OK) {
+		return RPI_TR_FAIL;
+	}
+	// the decode fills mag only, no stale stack in the other fields
+	memset(&s, 0, sizeof s);
+	if (rpi_ak09918_data_decode(dev, buf, &s) <= 0) {
+		return 0;
+	}
+	return async_add(b, s, ts);
+}
+
+#ifdef __RPI_BMI088_H__
+inline int async_fill(rpi_bmi088_t* dev, rpi_block_t* b, uint64_t ts, uint64_t) {
+	rpi_sample_t s;
+	int rt;
+
+	if (rpi_block_room(b) == 0) {
+		return 0;
+	}
+	if ((rt = rpi_bmi088_sample(dev, &s)) != BMI08X_OK) {
+		return rt;
+	}
+	return async_add(b, s, ts);
+}
+#endif
+
+/*
+ * A driver handle (rpi_icm20600_t, rpi_bmi088_t, rpi_ak09918_t)
+ * on a trigger of its own; co_await next_batch(b) suspends until
+ * the trigger fires, then appends what the device has to b.
+ * sample_ns: FIFO row period, 0: as the device is configured.
+ */
+template <typename Dev>
+class async_sensor: noncopyable {
+public:
+	async_sensor(reactor& r, Dev* dev, trigger& trig, uint64_t sample_ns = 0):
+		r_(r), dev_(dev), trig_(trig), sample_ns_(sample_ns), events_(0), missed_(0) {}
+
+	struct batch {
+		async_sensor& s;
+		rpi_block_t* b;
+		int rt;
+
+		bool await_ready() { return false; }
+		bool await_suspend(std::coroutine_handle<> h) {
+			return (rt = s.r_.arm(s.trig_.fd(), h)) == 0;
+		}
+		// rows added to b, 0: nothing new, <0: error
+		int await_resume() {
+			return rt < 0? rt: s.collect(b);
+		}
+	};
+
+	batch next_batch(rpi_block_t* b) { return batch{ *this, b, 0 }; }
+
+	Dev* handle() { return dev_; }
+	// trigger events, and those folded into a later read
+	uint64_t events() const { return events_; }
+	uint64_t missed() const { return missed_; }
+
+private:
+	int collect(rpi_block_t* b) {
+		uint64_t ts = 0;
+		int n;
+
+		if ((n = trig_.take(&ts)) <= 0) {
+			return n;
+		}
+		events_ += n;
+		missed_ += n - 1;
+		return async_fill(dev_, b, ts, sample_ns_);
+	}
+
+	reactor& r_;
+	Dev* dev_;
+	trigger& trig_;
+	uint64_t sample_ns_;
+	uint64_t events_;
+	uint64_t missed_;
+};
+
+} // namespace rpi
+
+#endif//__RPI_ASYNC_HPP__
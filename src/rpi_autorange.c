@@ -0,0 +1,84 @@
+/*
+ * Range selection from saturation of the samples
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "rpi_autorange.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void rpi_autorange_init(rpi_autorange_t* ar, int levels, int level, uint32_t hold) {
+	ar->hi = RPI_AUTORANGE_HI;
+	ar->lo = RPI_AUTORANGE_LO;
+	ar->hold = hold;
+	ar->levels = levels;
+	ar->level = level;
+	ar->pending = 0;
+	ar->quiet = 0;
+	ar->changes = 0;
+}
+
+int rpi_autorange_update(rpi_autorange_t* ar, const int16_t v[3]) {
+	int32_t m = 0, a;
+	int i;
+
+	if (ar->pending) {
+		return ar->level;
+	}
+	for (i = 0; i < 3; i++) {
+		a = v[i] < 0? -(int32_t)v[i]: v[i];
+		m = a > m? a: m;
+	}
+
+	if (m >= ar->hi) {
+		ar->quiet = 0;
+		if (ar->level + 1 < ar->levels) {
+			ar->level++;
+			ar->pending = 1;
+			ar->changes++;
+		}
+	} else if (m >= ar->lo) {
+		ar->quiet = 0;
+	} else if (++ar->quiet >= ar->hold && ar->level > 0) {
+		ar->quiet = 0;
+		ar->level--;
+		ar->pending = 1;
+		ar->changes++;
+	}
+	return ar->level;
+}
+
+void rpi_autorange_landed(rpi_autorange_t* ar, int level) {
+	ar->pending = 0;
+	ar->quiet = 0;
+	ar->level = (level < ar->levels)? level: ar->levels - 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,78 @@
+/*
+ * Range selection from saturation of the samples
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_AUTORANGE_H__
+#define __RPI_AUTORANGE_H__
+
+#include <stdint.h>
+
+// raw thresholds of rpi_autorange_init()
+#define RPI_AUTORANGE_HI	32000
+#define RPI_AUTORANGE_LO	12000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Range policy of one sensor, levels 0 (narrowest) .. levels - 1.
+ * An axis at hi or beyond is clipping or near it: one level wider.
+ * Every axis below lo for hold samples in a row: one level narrower;
+ * lo under half of hi keeps the doubled values clear of hi.
+ * After a change, samples are ignored until the driver reports the
+ * configuration taken (RPI_SAMPLE_RANGE), rpi_autorange_landed() then.
+ */
+typedef struct {
+	int32_t hi;
+	int32_t lo;
+	uint32_t hold;
+	uint8_t levels;
+	uint8_t level;		// wanted
+	uint8_t pending;	// level asked, not in the samples yet
+	uint32_t quiet;		// samples below lo so far
+	uint32_t changes;
+} rpi_autorange_t;
+
+// thresholds RPI_AUTORANGE_HI and _LO
+void rpi_autorange_init(rpi_autorange_t* ar, int levels, int level, uint32_t hold);
+
+// one raw sample, return the level wanted
+int rpi_autorange_update(rpi_autorange_t* ar, const int16_t v[3]);
+
+/*
+ * The driver took the configuration queued last, of range level:
+ * nothing pending, and level follows it, also when another
+ * reconfigure changed or reverted the one asked for.
+ */
+void rpi_autorange_landed(rpi_autorange_t* ar, int level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_AUTORANGE_H__
@@ -0,0 +1,164 @@
+/*
+ * Pooled sample blocks
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "rpi_block.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HEAD_INDEX(h)	((uint32_t)(h))
+#define HEAD_TAG(h)	((uint32_t)((h) >> 32))
+#define HEAD(tag, idx)	((uint64_t)(tag) << 32 | (idx))
+
+// Treiber stack of block indexes, the tag defeats ABA
+static void pool_push(rpi_block_pool_t* pool, rpi_block_t* b) {
+	uint64_t head, next;
+	uint32_t idx = b - pool->blocks + 1;
+
+	head = __atomic_load_n(&pool->head, __ATOMIC_RELAXED);
+	do {
+		__atomic_store_n(&b->next, HEAD_INDEX(head), __ATOMIC_RELAXED);
+		next = HEAD(HEAD_TAG(head) + 1, idx);
+	} while (!__atomic_compare_exchange_n(&pool->head, &head, next, 1,
+	                                      __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static rpi_block_t* pool_pop(rpi_block_pool_t* pool) {
+	uint64_t head, next;
+	rpi_block_t* b;
+
+	head = __atomic_load_n(&pool->head, __ATOMIC_ACQUIRE);
+	do {
+		if (HEAD_INDEX(head) == 0) {
+			return NULL;
+		}
+		b = &pool->blocks[HEAD_INDEX(head) - 1];
+		// stale if b was taken meanwhile, then the CAS fails
+		next = HEAD(HEAD_TAG(head) + 1,
+			__atomic_load_n(&b->next, __ATOMIC_RELAXED));
+	} while (!__atomic_compare_exchange_n(&pool->head, &head, next, 1,
+	                                      __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+	return b;
+}
+
+int rpi_block_pool_init(rpi_block_pool_t* pool, uint32_t count) {
+	uint32_t i;
+	void* p;
+
+	memset(pool, 0, sizeof *pool);
+	if (posix_memalign(&p, 64, (size_t)count * sizeof(rpi_block_t))) {
+		return -1;
+	}
+	pool->blocks = p;
+	pool->size = count;
+	// touch it all now, not on the first samples
+	memset(pool->blocks, 0, (size_t)count * sizeof(rpi_block_t));
+	for (i = count; i > 0; i--) {
+		pool->blocks[i - 1].pool = pool;
+		pool_push(pool, &pool->blocks[i - 1]);
+	}
+	return 0;
+}
+
+void rpi_block_pool_free(rpi_block_pool_t* pool) {
+	free(pool->blocks);
+	pool->blocks = NULL;
+	pool->size = 0;
+	pool->head = 0;
+}
+
+rpi_block_t* rpi_block_get(rpi_block_pool_t* pool) {
+	rpi_block_t* b;
+
+	if ((b = pool_pop(pool)) == NULL) {
+		return NULL;
+	}
+	__atomic_add_fetch(&pool->used, 1, __ATOMIC_RELAXED);
+	b->count = 0;
+	b->sensor = 0;
+	b->refs = 1;
+	return b;
+}
+
+void rpi_block_ref(rpi_block_t* b) {
+	__atomic_add_fetch(&b->refs, 1, __ATOMIC_RELAXED);
+}
+
+void rpi_block_put(rpi_block_t* b) {
+	// the last holder must see every write of the others
+	if (__atomic_sub_fetch(&b->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+		return;
+	}
+	__atomic_sub_fetch(&b->pool->used, 1, __ATOMIC_RELAXED);
+	pool_push(b->pool, b);
+}
+
+int rpi_block_add(rpi_block_t* b, const rpi_sample_t* s) {
+	int i = b->count;
+
+	if (i >= RPI_BLOCK_LEN) {
+		return -1;
+	}
+	b->ts[i] = s->ts;
+	b->acc[0][i] = s->acc[0];
+	b->acc[1][i] = s->acc[1];
+	b->acc[2][i] = s->acc[2];
+	b->gyr[0][i] = s->gyr[0];
+	b->gyr[1][i] = s->gyr[1];
+	b->gyr[2][i] = s->gyr[2];
+	b->mag[0][i] = s->mag[0];
+	b->mag[1][i] = s->mag[1];
+	b->mag[2][i] = s->mag[2];
+	b->temp[i] = s->temp;
+	b->flags[i] = s->flags;
+	b->count = i + 1;
+	return RPI_BLOCK_LEN - b->count;
+}
+
+void rpi_block_sample(const rpi_block_t* b, int i, rpi_sample_t* s) {
+	s->ts = b->ts[i];
+	s->sensor = b->sensor;
+	s->flags = b->flags[i];
+	s->acc[0] = b->acc[0][i];
+	s->acc[1] = b->acc[1][i];
+	s->acc[2] = b->acc[2][i];
+	s->gyr[0] = b->gyr[0][i];
+	s->gyr[1] = b->gyr[1][i];
+	s->gyr[2] = b->gyr[2][i];
+	s->mag[0] = b->mag[0][i];
+	s->mag[1] = b->mag[1][i];
+	s->mag[2] = b->mag[2][i];
+	s->temp = b->temp[i];
+}
+
+#ifdef __cplusplus
+}
+#endif
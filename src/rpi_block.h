@@ -0,0 +1,101 @@
+/*
+ * Pooled sample blocks
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_BLOCK_H__
+#define __RPI_BLOCK_H__
+
+#include <stdint.h>
+#include "rpi_sample.h"
+
+// samples of one block
+#define RPI_BLOCK_LEN		64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct rpi_block_pool;
+
+/*
+ * Samples of one sensor as struct of arrays, every row starts
+ * on a cache line: acc[0] .. acc[0] + count are the x values,
+ * straight input of rpi_convert_s16soa() and the filters.
+ * Handed around by pointer, through rings too, and returned to
+ * its pool by the last rpi_block_put().
+ */
+typedef struct rpi_block {
+	uint64_t ts[RPI_BLOCK_LEN];		// ns, CLOCK_MONOTONIC
+	int16_t acc[3][RPI_BLOCK_LEN];
+	int16_t gyr[3][RPI_BLOCK_LEN];
+	int16_t mag[3][RPI_BLOCK_LEN];
+	int16_t temp[RPI_BLOCK_LEN];
+	uint16_t flags[RPI_BLOCK_LEN];		// RPI_SAMPLE_*
+	uint16_t sensor;
+	uint16_t count;
+	uint32_t refs;
+	uint32_t next;				// free list, index + 1
+	struct rpi_block_pool* pool;
+} __attribute__((aligned(64))) rpi_block_t;
+
+/*
+ * All blocks are allocated by rpi_block_pool_init(), get and put
+ * are lock free from any thread and never call malloc.
+ */
+typedef struct rpi_block_pool {
+	rpi_block_t* blocks;
+	uint32_t size;
+	uint64_t head;		// ABA tag << 32 | index + 1, 0: empty
+	uint32_t used;
+} rpi_block_pool_t;
+
+// return 0: OK, <0: no memory
+int rpi_block_pool_init(rpi_block_pool_t* pool, uint32_t count);
+// every block must be back
+void rpi_block_pool_free(rpi_block_pool_t* pool);
+
+// an empty block with one reference, NULL: pool exhausted
+rpi_block_t* rpi_block_get(rpi_block_pool_t* pool);
+// one more holder, eg. a logger next to the filter
+void rpi_block_ref(rpi_block_t* b);
+// drop a reference, the last one returns b to its pool
+void rpi_block_put(rpi_block_t* b);
+
+// append one sample, return free room left, <0: block full
+int rpi_block_add(rpi_block_t* b, const rpi_sample_t* s);
+// sample i as rpi_sample_t
+void rpi_block_sample(const rpi_block_t* b, int i, rpi_sample_t* s);
+
+static inline int rpi_block_room(const rpi_block_t* b) {
+	return RPI_BLOCK_LEN - b->count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_BLOCK_H__
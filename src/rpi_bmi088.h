@@ -1,71 +1,257 @@
-/*    
- * BMI088 program
- *
- * Tested with Seeed Grove - 6-Axis Accelerometer&Gyroscope (BMI088)
- * Author      : Peter Yang
- * Create Time : Dec 2018
- * Change Log  :
- *     11:09 2018/12/20 Initial version
- *
- * The MIT License (MIT)
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software", to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- * 
- * The above copyright notice and this permission notice shall be included in
- * all copies or substantial portions of the Software.
- * 
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
- * THE SOFTWARE.
- */
-#ifndef __RPI_BMI088_H__
-#define __RPI_BMI088_H__
-
-#include "bmi08x.h"
-
-#define BMI088_I2C_ADDR		0x19
-
-typedef struct {
-	struct bmi08x_dev bmi;
-	struct bmi08x_sensor_data acc;
-	struct bmi08x_sensor_data gyr;
-	double accel_range;
-	double gyro_range;
-} rpi_bmi088_t;
-
-void* rpi_bmi088_alloc(void);
-int rpi_bmi088_free(rpi_bmi088_t* dev);
-
-extern int rpi_bmi088_init(
-	rpi_bmi088_t* dev,
-	const char* i2c_dev,
-	int accel_addr,
-	int gyro_addr,
-	const struct bmi08x_cfg* accel,
-	const struct bmi08x_cfg* gyro
-);
-
-extern int rpi_bmi088_get_accel(
-	rpi_bmi088_t* dev,
-	double* x, double* y, double* z
-);
-
-extern uint32_t rpi_bmi088_get_sensor_time(
-	rpi_bmi088_t* dev
-);
-
-extern int rpi_bmi088_get_gyro(
-	rpi_bmi088_t* dev,
-	double* x, double* y, double* z
-);
-
-#endif//__RPI_BMI088_H__
+/*    
+ * BMI088 program
+ *
+ * Tested with Seeed Grove - 6-Axis Accelerometer&Gyroscope (BMI088)
+ * Author      : Peter Yang
+ * Create Time : Dec 2018
+ * Change Log  :
+ *     11:09 2018/12/20 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_BMI088_H__
+#define __RPI_BMI088_H__
+
+#include "bmi08x.h"
+#include "rpi_transport.h"
+#include "rpi_shadow.h"
+#include "rpi_startup.h"
+#include "rpi_sample.h"
+#include "rpi_tcomp.h"
+#include "rpi_plan.h"
+#include "rpi_autorange.h"
+
+#define BMI088_I2C_ADDR		0x19
+
+// devices initialized at the same time
+#define RPI_BMI088_MAX_DEV	8
+
+// no data now: a self-test excites the accel, or a new
+// configuration settles; the bus is fine
+#define RPI_BMI088_E_BUSY	(-20)
+
+typedef struct {
+	struct bmi08x_dev bmi;
+	rpi_transport_t* tr;
+	uint8_t accel_addr;
+	uint8_t gyro_addr;
+	struct bmi08x_sensor_data acc;
+	struct bmi08x_sensor_data gyr;
+	double accel_range;
+	double gyro_range;
+	uint8_t sync_mode;
+	rpi_shadow_t acc_shadow;
+	rpi_shadow_t gyro_shadow;
+	uint8_t status;
+	uint16_t reads;
+	uint32_t sensor_time;
+	int16_t temp_raw;	// 0.125 degree, 23 at 0
+	uint64_t temp_ts;
+	const rpi_tcomp_t* tcomp[2];	// accel, gyro
+	uint8_t testing;	// self-test running, accel excited
+	int16_t test_acc[3];
+	// rpi_bmi088_reconfigure(), one control thread to the sampling one
+	struct bmi08x_cfg acc_want;
+	struct bmi08x_cfg gyro_want;
+	uint32_t want_seq;	// odd while the wants are written
+	uint32_t conf_seq;	// want_seq applied
+	uint8_t settle;		// RPI_SAMPLE_* left out until settle_ts
+	uint8_t mark;		// RPI_SAMPLE_RANGE on the next sample
+	uint64_t settle_ts;
+} rpi_bmi088_t;
+
+void* rpi_bmi088_alloc(void);
+int rpi_bmi088_free(rpi_bmi088_t* dev);
+
+// release what rpi_bmi088_init*() took, for devices not from alloc
+int rpi_bmi088_deinit(rpi_bmi088_t* dev);
+
+extern int rpi_bmi088_init(
+	rpi_bmi088_t* dev,
+	const char* i2c_dev,
+	int accel_addr,
+	int gyro_addr,
+	const struct bmi08x_cfg* accel,
+	const struct bmi08x_cfg* gyro
+);
+
+// same as rpi_bmi088_init(), on any bus transport
+extern int rpi_bmi088_init_tr(
+	rpi_bmi088_t* dev,
+	rpi_transport_t* tr,
+	int accel_addr,
+	int gyro_addr,
+	const struct bmi08x_cfg* accel,
+	const struct bmi08x_cfg* gyro
+);
+
+// init as a job of rpi_startup_run(), with other devices
+extern void rpi_bmi088_startup(
+	rpi_startup_t* job,
+	rpi_bmi088_t* dev,
+	rpi_transport_t* tr,
+	int accel_addr,
+	int gyro_addr,
+	const struct bmi08x_cfg* accel,
+	const struct bmi08x_cfg* gyro
+);
+
+// SPI interface, accel and gyro are on separate chip selects
+//   eg. accel_dev = "/dev/spidev0.0", gyro_dev = "/dev/spidev0.1"
+//   speed_hz up to 10000000
+extern int rpi_bmi088_init_spi(
+	rpi_bmi088_t* dev,
+	const char* accel_dev,
+	const char* gyro_dev,
+	uint32_t speed_hz,
+	const struct bmi08x_cfg* accel,
+	const struct bmi08x_cfg* gyro
+);
+
+/*
+ * Change range, ODR and bandwidth while streaming, from one control
+ * thread; power is kept as it is, and in data sync mode the ODR and
+ * bandwidth belong to rpi_bmi088_set_sync(). The next read of the
+ * sampling thread writes the registers which differ and the scales
+ * first, or after a self-test in progress. Samples within two output
+ * periods leave out the sensors changed and get_* of them return
+ * RPI_BMI088_E_BUSY; the first sample after carries RPI_SAMPLE_RANGE,
+ * also when nothing needed to change.
+ */
+extern void rpi_bmi088_reconfigure(
+	rpi_bmi088_t* dev,
+	const struct bmi08x_cfg* accel,
+	const struct bmi08x_cfg* gyro
+);
+
+// the configuration last queued
+extern void rpi_bmi088_get_config(
+	rpi_bmi088_t* dev,
+	struct bmi08x_cfg* accel,
+	struct bmi08x_cfg* gyro
+);
+
+/*
+ * Auto-ranging of accel (ar[0], levels BMI088_ACCEL_RANGE_*) and
+ * gyro (ar[1], levels 0 for 125dps .. 4 for 2000dps) from the samples
+ * of dev as they are consumed; a range wanted is queued with
+ * rpi_bmi088_reconfigure(). return 1: queued, 0: none
+ */
+extern int rpi_bmi088_autorange(
+	rpi_bmi088_t* dev,
+	rpi_autorange_t ar[2],
+	const rpi_sample_t* s
+);
+
+// return BMI08X_OK, RPI_BMI088_E_BUSY or a bus error; also get_gyro
+extern int rpi_bmi088_get_accel(
+	rpi_bmi088_t* dev,
+	double* x, double* y, double* z
+);
+
+extern uint32_t rpi_bmi088_get_sensor_time(
+	rpi_bmi088_t* dev
+);
+
+extern int rpi_bmi088_get_gyro(
+	rpi_bmi088_t* dev,
+	double* x, double* y, double* z
+);
+
+/*
+ * Data synchronization mode, gyro data-ready triggers the accel
+ * sampling so both sensors are taken at the same instant.
+ *   mode: BMI08X_ACCEL_DATA_SYNC_MODE_OFF
+ *         BMI08X_ACCEL_DATA_SYNC_MODE_400HZ
+ *         BMI08X_ACCEL_DATA_SYNC_MODE_1000HZ
+ *         BMI08X_ACCEL_DATA_SYNC_MODE_2000HZ
+ * Call after rpi_bmi088_init(), it overrides the ODR/bandwidth of both.
+ *
+ * Interrupt pins in sync mode:
+ *   INT3 gyro  data-ready output, must be wired to INT1 on the board
+ *   INT1 accel sync input
+ *   INT2 accel synchronized data-ready, connect it to the host
+ */
+extern int rpi_bmi088_set_sync(
+	rpi_bmi088_t* dev,
+	int mode
+);
+
+// matched accel(mg) + gyro(dps) pair, only in sync mode,
+// RPI_BMI088_E_BUSY during a self-test or while either settles;
+// no data-ready check, call on the INT2 edge: polled faster than
+// the sync rate it returns the same pair again
+extern int rpi_bmi088_get_sync(
+	rpi_bmi088_t* dev,
+	double acc[3],
+	double gyr[3]
+);
+
+// accel and gyro raw, synchronized in data sync mode,
+// as rpi_sample_fn for rpi_array_add()
+extern int rpi_bmi088_sample(void* dev, rpi_sample_t* s);
+
+// centigrade degree of the accel die, updated every RPI_TEMP_PERIOD
+// in the accel burst of the getters
+extern int rpi_bmi088_get_temperature(
+	rpi_bmi088_t* dev,
+	double* temperature
+);
+
+// compensate accel and gyro for temperature, NULL: off
+extern void rpi_bmi088_set_tcomp(
+	rpi_bmi088_t* dev,
+	const rpi_tcomp_t* accel,
+	const rpi_tcomp_t* gyro
+);
+
+/*
+ * Self-test of both chips as a job for rpi_startup_poll(), about
+ * 110ms of waits that never block. Meanwhile rpi_bmi088_sample()
+ * leaves out the accel and get_accel/get_sync return
+ * RPI_BMI088_E_BUSY, the accel configuration is written back at
+ * the end. job->rt: BMI08X_OK, BMI08X_W_SELF_TEST_FAIL, also when
+ * the gyro gave no result in time, or BMI08X_E_COM_FAIL.
+ */
+extern void rpi_bmi088_selftest(
+	rpi_startup_t* job,
+	rpi_bmi088_t* dev
+);
+
+// accel and gyro data reads at their ODR as streams of plan,
+// return 0: OK, <0: plan full
+extern int rpi_bmi088_plan(
+	rpi_plan_t* plan,
+	const struct bmi08x_cfg* accel,
+	const struct bmi08x_cfg* gyro
+);
+
+// RPI_STATUS_* since last call
+extern int rpi_bmi088_status(
+	rpi_bmi088_t* dev
+);
+
+// check both chips and apply the configuration again if reset
+extern int rpi_bmi088_recover(
+	rpi_bmi088_t* dev
+);
+
+#endif//__RPI_BMI088_H__
@@ -0,0 +1,193 @@
+/*
+ * BMI088 C++ wrapper, configuration fixed at compile time
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_BMI088_HPP__
+#define __RPI_BMI088_HPP__
+
+#include "rpi_imu.hpp"
+
+extern "C" {
+#include "rpi_bmi088.h"
+}
+
+namespace rpi {
+
+namespace bmi088_reg {
+	constexpr uint8_t ACCEL_X_LSB = 0x12;
+	constexpr uint8_t GYRO_X_LSB  = 0x02;
+	constexpr uint16_t AXIS_LEN   = 6;
+}
+
+constexpr double bmi088_acc_fs(uint8_t range) {
+	return 3000.0 * (1 << range);		// mg
+}
+
+constexpr double bmi088_gyro_fs(uint8_t range) {
+	return 2000.0 / (1 << range);		// dps
+}
+
+// BMI08X_ACCEL_ODR_12_5_HZ(0x05) .. BMI08X_ACCEL_ODR_1600_HZ(0x0C)
+constexpr double bmi088_acc_hz(uint8_t odr) {
+	return 12.5 * (1 << (odr - BMI08X_ACCEL_ODR_12_5_HZ));
+}
+
+// BMI08X_GYRO_BW_532_ODR_2000_HZ(0x00) .. BMI08X_GYRO_BW_32_ODR_100_HZ(0x07)
+constexpr double bmi088_gyro_hz(uint8_t bw) {
+	return (bw <= BMI08X_GYRO_BW_230_ODR_2000_HZ)? 2000.0:
+	       (bw == BMI08X_GYRO_BW_116_ODR_1000_HZ)? 1000.0:
+	       (bw == BMI08X_GYRO_BW_47_ODR_400_HZ)?   400.0:
+	       (bw == BMI08X_GYRO_BW_23_ODR_200_HZ ||
+	        bw == BMI08X_GYRO_BW_64_ODR_200_HZ)?   200.0: 100.0;
+}
+
+/*
+ * Usage:
+ *   rpi::bmi088<BMI088_ACCEL_RANGE_6G,      BMI08X_ACCEL_ODR_100_HZ,
+ *               BMI08X_GYRO_RANGE_1000_DPS, BMI08X_GYRO_BW_23_ODR_200_HZ> imu;
+ *   if (!imu) ...
+ *   rpi::vec3<float> a;
+ *   imu.read_accel(a);
+ */
+template <
+	uint8_t AccRange,
+	uint8_t AccOdr,
+	uint8_t GyroRange,
+	uint8_t GyroBw,
+	uint8_t AccBw = BMI08X_ACCEL_BW_NORMAL
+>
+class bmi088: noncopyable {
+	static_assert(AccRange <= BMI088_ACCEL_RANGE_24G, "invalid accel range");
+	static_assert(GyroRange <= BMI08X_GYRO_RANGE_125_DPS, "invalid gyro range");
+	static_assert(AccOdr >= BMI08X_ACCEL_ODR_12_5_HZ &&
+	              AccOdr <= BMI08X_ACCEL_ODR_1600_HZ, "invalid accel ODR");
+	static_assert(GyroBw <= BMI08X_GYRO_BW_32_ODR_100_HZ, "invalid gyro ODR");
+
+public:
+	static constexpr double acc_lsb  = lsb(bmi088_acc_fs(AccRange));
+	static constexpr double gyro_lsb = lsb(bmi088_gyro_fs(GyroRange));
+	static constexpr double acc_hz   = bmi088_acc_hz(AccOdr);
+	static constexpr double gyro_hz  = bmi088_gyro_hz(GyroBw);
+
+	explicit bmi088(
+		const char* i2c_dev = "/dev/i2c-1",
+		int accel_addr = BMI08X_ACCEL_I2C_ADDR_SECONDARY,
+		int gyro_addr  = BMI08X_GYRO_I2C_ADDR_SECONDARY
+	) {
+		const struct bmi08x_cfg accel = {
+			BMI08X_ACCEL_PM_ACTIVE, AccRange, AccBw, AccOdr
+		};
+		const struct bmi08x_cfg gyro = {
+			BMI08X_GYRO_PM_NORMAL, GyroRange, GyroBw, GyroBw
+		};
+		rt_ = rpi_bmi088_init(&dev_, i2c_dev, accel_addr, gyro_addr,
+		                      &accel, &gyro);
+	}
+
+	bmi088(
+		rpi_transport_t* tr,
+		int accel_addr = BMI08X_ACCEL_I2C_ADDR_SECONDARY,
+		int gyro_addr  = BMI08X_GYRO_I2C_ADDR_SECONDARY
+	) {
+		const struct bmi08x_cfg accel = {
+			BMI08X_ACCEL_PM_ACTIVE, AccRange, AccBw, AccOdr
+		};
+		const struct bmi08x_cfg gyro = {
+			BMI08X_GYRO_PM_NORMAL, GyroRange, GyroBw, GyroBw
+		};
+		rt_ = rpi_bmi088_init_tr(&dev_, tr, accel_addr, gyro_addr,
+		                         &accel, &gyro);
+	}
+
+	~bmi088() {
+		rpi_bmi088_deinit(&dev_);
+	}
+
+	// BMI08X_OK or init error
+	int status() const { return rt_; }
+	explicit operator bool() const { return rt_ == BMI08X_OK; }
+
+	rpi_bmi088_t* handle() { return &dev_; }
+
+	int read_accel_raw(vec3<int16_t>& a) {
+		return read_raw(bmi08a_get_data, a);
+	}
+
+	int read_gyro_raw(vec3<int16_t>& g) {
+		return read_raw(bmi08g_get_data, g);
+	}
+
+	// accel in mg
+	template <typename T>
+	int read_accel(vec3<T>& a) {
+		vec3<int16_t> raw;
+		int rt;
+
+		if ((rt = read_accel_raw(raw)) == BMI08X_OK) {
+			a = scale(raw, (T)acc_lsb);
+		}
+		return rt;
+	}
+
+	// gyro in dps
+	template <typename T>
+	int read_gyro(vec3<T>& g) {
+		vec3<int16_t> raw;
+		int rt;
+
+		if ((rt = read_gyro_raw(raw)) == BMI08X_OK) {
+			g = scale(raw, (T)gyro_lsb);
+		}
+		return rt;
+	}
+
+	uint32_t sensor_time() {
+		return rpi_bmi088_get_sensor_time(&dev_);
+	}
+
+private:
+	template <typename F>
+	int read_raw(F get_data, vec3<int16_t>& v) {
+		struct bmi08x_sensor_data d;
+		int rt;
+
+		if ((rt = get_data(&d, &dev_.bmi)) != BMI08X_OK) {
+			return rt;
+		}
+		v.x = d.x;
+		v.y = d.y;
+		v.z = d.z;
+		return BMI08X_OK;
+	}
+
+	rpi_bmi088_t dev_;
+	int rt_;
+};
+
+} // namespace rpi
+
+#endif//__RPI_BMI088_HPP__
@@ -0,0 +1,757 @@
+/*
+ * Indexed capture files of sample blocks
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rpi_capture.h"
+#include "rpi_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * File layout:
+ *   file_head_t
+ *   chunk_head_t + bytes of rpi_codec blocks, ...
+ *   index_t, ... index_tail_t		written by rpi_capture_close()
+ * Structures without padding, little endian like the codec: swapped
+ * on the way in and out on a big endian host.
+ */
+#define CAP_MAGIC	"RPICAP02"
+#define IDX_MAGIC	"RPIIDX01"
+#define CHUNK_MAGIC	0x4B4E4843	// "CHNK"
+#define CHUNK_MAX	(RPI_CAPTURE_BLOCKS * RPI_CODEC_MAX_BYTES)
+
+typedef struct {
+	char magic[8];
+	uint64_t epoch_ns;
+	uint64_t period_ns;
+	uint64_t reserved;
+} file_head_t;
+
+typedef struct {
+	uint32_t magic;
+	uint32_t bytes;
+	uint16_t sensor;
+	uint16_t blocks;
+	uint32_t count;			// samples
+	uint64_t t0, t1;
+	rpi_capture_sum_t sum[RPI_CAPTURE_CH];
+	rpi_capture_unit_t unit;
+} chunk_head_t;
+
+typedef struct {
+	uint64_t offset;		// of chunk_head_t
+	uint64_t t0, t1;
+	uint16_t sensor;
+	uint16_t blocks;
+	uint32_t bytes;
+} index_t;
+
+typedef struct {
+	uint64_t offset;		// of the first index_t
+	uint32_t count;
+	uint32_t reserved;
+	char magic[8];
+} index_tail_t;
+
+// chunk of one sensor being written
+typedef struct {
+	rpi_block_t* stage;		// samples not encoded yet
+	uint8_t* buf;			// encoded blocks
+	chunk_head_t head;
+	uint64_t period;		// wall time / period_ns of the chunk
+} open_chunk_t;
+
+struct rpi_capture {
+	FILE* fp;
+	int writing;
+	int failed;
+	int indexed;
+	uint64_t epoch_ns;
+	uint64_t period_ns;
+	index_t* index;
+	uint32_t count;
+	uint32_t size;
+	open_chunk_t* open[RPI_CAPTURE_SENSORS];
+	// reading
+	rpi_block_t* block;
+	uint8_t* buf;
+};
+
+/***************************************************************
+ byte order
+ ***************************************************************/
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define CAP_SWAP	1
+#else
+#define CAP_SWAP	0
+#endif
+
+static inline void le16(void* p) {
+	uint16_t v;
+
+	if (CAP_SWAP) {
+		memcpy(&v, p, 2);
+		v = __builtin_bswap16(v);
+		memcpy(p, &v, 2);
+	}
+}
+
+static inline void le32(void* p) {
+	uint32_t v;
+
+	if (CAP_SWAP) {
+		memcpy(&v, p, 4);
+		v = __builtin_bswap32(v);
+		memcpy(p, &v, 4);
+	}
+}
+
+static inline void le64(void* p) {
+	uint64_t v;
+
+	if (CAP_SWAP) {
+		memcpy(&v, p, 8);
+		v = __builtin_bswap64(v);
+		memcpy(p, &v, 8);
+	}
+}
+
+static void file_head_le(file_head_t* h) {
+	le64(&h->epoch_ns);
+	le64(&h->period_ns);
+}
+
+static void chunk_head_le(chunk_head_t* h) {
+	int k;
+
+	le32(&h->magic);
+	le32(&h->bytes);
+	le16(&h->sensor);
+	le16(&h->blocks);
+	le32(&h->count);
+	le64(&h->t0);
+	le64(&h->t1);
+	for (k = 0; k < RPI_CAPTURE_CH; k++) {
+		le32(&h->sum[k].n);
+		le16(&h->sum[k].min);
+		le16(&h->sum[k].max);
+		le64(&h->sum[k].sum);
+		le64(&h->sum[k].sumsq);
+	}
+	for (k = 0; k < 4; k++) {
+		le32(&h->unit.scale[k]);
+		le32(&h->unit.offset[k]);
+	}
+}
+
+static void index_le(index_t* x, uint32_t count) {
+	uint32_t i;
+
+	for (i = 0; CAP_SWAP && i < count; i++) {
+		le64(&x[i].offset);
+		le64(&x[i].t0);
+		le64(&x[i].t1);
+		le16(&x[i].sensor);
+		le16(&x[i].blocks);
+		le32(&x[i].bytes);
+	}
+}
+
+static void index_tail_le(index_tail_t* tail) {
+	le64(&tail->offset);
+	le32(&tail->count);
+}
+
+/***************************************************************
+ summaries
+ ***************************************************************/
+static void sum_init(rpi_capture_sum_t* sum) {
+	int k;
+
+	for (k = 0; k < RPI_CAPTURE_CH; k++) {
+		sum[k].n = 0;
+		sum[k].min = INT16_MAX;
+		sum[k].max = INT16_MIN;
+		sum[k].sum = 0;
+		sum[k].sumsq = 0;
+	}
+}
+
+static inline void sum_add(rpi_capture_sum_t* sum, int16_t v) {
+	sum->n++;
+	sum->min = (v < sum->min)? v: sum->min;
+	sum->max = (v > sum->max)? v: sum->max;
+	sum->sum += v;
+	sum->sumsq += (int32_t)v * v;
+}
+
+static void sum_row(rpi_capture_sum_t* sum, const rpi_block_t* b, int i) {
+	int k;
+
+	for (k = 0; k < 3; k++) {
+		if (b->flags[i] & RPI_SAMPLE_ACC) {
+			sum_add(&sum[k], b->acc[k][i]);
+		}
+		if (b->flags[i] & RPI_SAMPLE_GYR) {
+			sum_add(&sum[3 + k], b->gyr[k][i]);
+		}
+		if (b->flags[i] & RPI_SAMPLE_MAG) {
+			sum_add(&sum[6 + k], b->mag[k][i]);
+		}
+	}
+	if (b->flags[i] & RPI_SAMPLE_TEMP) {
+		sum_add(&sum[9], b->temp[i]);
+	}
+}
+
+static void sum_merge(rpi_capture_sum_t* sum, const rpi_capture_sum_t* more) {
+	int k;
+
+	for (k = 0; k < RPI_CAPTURE_CH; k++) {
+		if (more[k].n == 0) {
+			continue;
+		}
+		sum[k].n += more[k].n;
+		sum[k].min = (more[k].min < sum[k].min)? more[k].min: sum[k].min;
+		sum[k].max = (more[k].max > sum[k].max)? more[k].max: sum[k].max;
+		sum[k].sum += more[k].sum;
+		sum[k].sumsq += more[k].sumsq;
+	}
+}
+
+static rpi_block_t* block_alloc(void) {
+	void* p;
+
+	if (posix_memalign(&p, 64, sizeof(rpi_block_t))) {
+		return NULL;
+	}
+	memset(p, 0, sizeof(rpi_block_t));
+	return p;
+}
+
+static int index_add(rpi_capture_t* cap, const index_t* x) {
+	index_t* p;
+
+	if (cap->count == cap->size) {
+		cap->size = cap->size? cap->size * 2: 1024;
+		if ((p = realloc(cap->index, cap->size * sizeof *p)) == NULL) {
+			return -1;
+		}
+		cap->index = p;
+	}
+	cap->index[cap->count++] = *x;
+	return 0;
+}
+
+/***************************************************************
+ writing
+ ***************************************************************/
+rpi_capture_t* rpi_capture_create(const char* path, uint64_t period_ns) {
+	struct timespec rt, mono;
+	rpi_capture_t* cap;
+	file_head_t h;
+
+	if ((cap = calloc(1, sizeof *cap)) == NULL) {
+		return NULL;
+	}
+	if ((cap->fp = fopen(path, "wb")) == NULL) {
+		free(cap);
+		return NULL;
+	}
+	clock_gettime(CLOCK_REALTIME, &rt);
+	clock_gettime(CLOCK_MONOTONIC, &mono);
+
+	cap->writing = 1;
+	cap->period_ns = period_ns? period_ns: 1000000000ULL;
+	cap->epoch_ns = (rt.tv_sec - mono.tv_sec) * 1000000000ULL +
+	                rt.tv_nsec - mono.tv_nsec;
+
+	memset(&h, 0, sizeof h);
+	memcpy(h.magic, CAP_MAGIC, 8);
+	h.epoch_ns = cap->epoch_ns;
+	h.period_ns = cap->period_ns;
+	file_head_le(&h);
+	cap->failed = fwrite(&h, sizeof h, 1, cap->fp) != 1;
+	return cap;
+}
+
+static open_chunk_t* chunk_of(rpi_capture_t* cap, uint16_t sensor) {
+	open_chunk_t* oc;
+	int i, k;
+
+	for (i = 0; i < RPI_CAPTURE_SENSORS && cap->open[i]; i++) {
+		if (cap->open[i]->head.sensor == sensor) {
+			return cap->open[i];
+		}
+	}
+	if (i == RPI_CAPTURE_SENSORS || (oc = calloc(1, sizeof *oc)) == NULL) {
+		return NULL;
+	}
+	oc->stage = block_alloc();
+	oc->buf = malloc(CHUNK_MAX);
+	if (oc->stage == NULL || oc->buf == NULL) {
+		free(oc->stage);
+		free(oc->buf);
+		free(oc);
+		return NULL;
+	}
+	oc->stage->sensor = sensor;
+	oc->head.sensor = sensor;
+	for (k = 0; k < 4; k++) {
+		oc->head.unit.scale[k] = 1.0f;
+	}
+	return cap->open[i] = oc;
+}
+
+static void stage_encode(open_chunk_t* oc) {
+	if (oc->stage->count == 0) {
+		return;
+	}
+	oc->head.bytes += rpi_codec_encode(oc->stage, oc->buf + oc->head.bytes);
+	oc->head.blocks++;
+	oc->stage->count = 0;
+}
+
+static int chunk_flush(rpi_capture_t* cap, open_chunk_t* oc) {
+	chunk_head_t h;
+	index_t x;
+
+	stage_encode(oc);
+	if (oc->head.count == 0) {
+		return 0;
+	}
+	oc->head.magic = CHUNK_MAGIC;
+
+	x.offset = ftello(cap->fp);
+	x.t0 = oc->head.t0;
+	x.t1 = oc->head.t1;
+	x.sensor = oc->head.sensor;
+	x.blocks = oc->head.blocks;
+	x.bytes = oc->head.bytes;
+	h = oc->head;
+	chunk_head_le(&h);
+	if (fwrite(&h, sizeof h, 1, cap->fp) != 1 ||
+	    fwrite(oc->buf, 1, oc->head.bytes, cap->fp) != oc->head.bytes ||
+	    index_add(cap, &x)) {
+		cap->failed = 1;
+	}
+
+	oc->head.bytes = 0;
+	oc->head.blocks = 0;
+	oc->head.count = 0;
+	return cap->failed? -1: 0;
+}
+
+static int chunk_add(rpi_capture_t* cap, open_chunk_t* oc, const rpi_sample_t* s) {
+	uint64_t period = (s->ts + cap->epoch_ns) / cap->period_ns;
+	int rt = 0;
+
+	if (oc->head.count && period != oc->period) {
+		rt = chunk_flush(cap, oc);
+	}
+	if (oc->head.count == 0) {
+		oc->period = period;
+		oc->head.t0 = s->ts;
+		sum_init(oc->head.sum);
+	}
+	rpi_block_add(oc->stage, s);
+	sum_row(oc->head.sum, oc->stage, oc->stage->count - 1);
+	oc->head.t1 = s->ts;
+	oc->head.count++;
+
+	if (rpi_block_room(oc->stage) == 0) {
+		stage_encode(oc);
+		if (oc->head.blocks == RPI_CAPTURE_BLOCKS) {
+			rt |= chunk_flush(cap, oc);
+		}
+	}
+	return rt;
+}
+
+int rpi_capture_unit(rpi_capture_t* cap, uint16_t sensor,
+                     const rpi_capture_unit_t* unit) {
+	open_chunk_t* oc;
+	int rt = 0;
+
+	if ((oc = chunk_of(cap, sensor)) == NULL) {
+		return -1;
+	}
+	if (memcmp(&oc->head.unit, unit, sizeof *unit)) {
+		rt = chunk_flush(cap, oc);
+		oc->head.unit = *unit;
+	}
+	return rt;
+}
+
+int rpi_capture_sample(rpi_capture_t* cap, const rpi_sample_t* s) {
+	open_chunk_t* oc;
+
+	if ((oc = chunk_of(cap, s->sensor)) == NULL) {
+		return -1;
+	}
+	return chunk_add(cap, oc, s);
+}
+
+int rpi_capture_block(rpi_capture_t* cap, const rpi_block_t* b) {
+	open_chunk_t* oc;
+	rpi_sample_t s;
+	int i, rt = 0;
+
+	if ((oc = chunk_of(cap, b->sensor)) == NULL) {
+		return -1;
+	}
+	for (i = 0; i < b->count; i++) {
+		rpi_block_sample(b, i, &s);
+		rt |= chunk_add(cap, oc, &s);
+	}
+	return rt;
+}
+
+static int index_write(rpi_capture_t* cap) {
+	index_tail_t tail;
+	int i;
+
+	for (i = 0; i < RPI_CAPTURE_SENSORS && cap->open[i]; i++) {
+		chunk_flush(cap, cap->open[i]);
+	}
+	memset(&tail, 0, sizeof tail);
+	tail.offset = ftello(cap->fp);
+	tail.count = cap->count;
+	memcpy(tail.magic, IDX_MAGIC, 8);
+	index_tail_le(&tail);
+	index_le(cap->index, cap->count);	// written last, not used again
+	if (fwrite(cap->index, sizeof cap->index[0], cap->count, cap->fp) != cap->count ||
+	    fwrite(&tail, sizeof tail, 1, cap->fp) != 1) {
+		cap->failed = 1;
+	}
+	return cap->failed? -1: 0;
+}
+
+int rpi_capture_close(rpi_capture_t* cap) {
+	int i, rt = 0;
+
+	if (cap->writing) {
+		rt = index_write(cap);
+	}
+	if (fclose(cap->fp)) {
+		rt = -1;
+	}
+	for (i = 0; i < RPI_CAPTURE_SENSORS && cap->open[i]; i++) {
+		free(cap->open[i]->stage);
+		free(cap->open[i]->buf);
+		free(cap->open[i]);
+	}
+	free(cap->index);
+	free(cap->block);
+	free(cap->buf);
+	free(cap);
+	return rt;
+}
+
+/***************************************************************
+ reading
+ ***************************************************************/
+static int index_cmp(const void* a, const void* b) {
+	const index_t* x = a;
+	const index_t* y = b;
+
+	if (x->sensor != y->sensor) {
+		return x->sensor - y->sensor;
+	}
+	return (x->t0 > y->t0) - (x->t0 < y->t0);
+}
+
+static int index_read(rpi_capture_t* cap, uint64_t size) {
+	index_tail_t tail;
+	uint32_t i;
+
+	if (size < sizeof(file_head_t) + sizeof tail ||
+	    fseeko(cap->fp, size - sizeof tail, SEEK_SET) ||
+	    fread(&tail, sizeof tail, 1, cap->fp) != 1 ||
+	    (index_tail_le(&tail), memcmp(tail.magic, IDX_MAGIC, 8)) ||
+	    tail.offset > size ||
+	    tail.offset + (uint64_t)tail.count * sizeof(index_t) + sizeof tail != size) {
+		return -1;
+	}
+	cap->size = cap->count = tail.count;
+	if (tail.count == 0) {
+		return 0;
+	}
+	if ((cap->index = malloc(tail.count * sizeof(index_t))) == NULL ||
+	    fseeko(cap->fp, tail.offset, SEEK_SET) ||
+	    fread(cap->index, sizeof(index_t), tail.count, cap->fp) != tail.count) {
+		free(cap->index);
+		cap->index = NULL;
+		cap->size = cap->count = 0;
+		return -1;
+	}
+	index_le(cap->index, tail.count);
+
+	// every chunk within the data part and within the buffer
+	for (i = 0; i < tail.count; i++) {
+		const index_t* x = &cap->index[i];
+
+		if (x->bytes > CHUNK_MAX || x->offset < sizeof(file_head_t) ||
+		    x->offset > tail.offset ||
+		    tail.offset - x->offset < sizeof(chunk_head_t) + x->bytes) {
+			free(cap->index);
+			cap->index = NULL;
+			cap->size = cap->count = 0;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+// no index, not closed, up to the last complete chunk
+static int index_scan(rpi_capture_t* cap, uint64_t size) {
+	uint64_t offset = sizeof(file_head_t);
+	chunk_head_t h;
+	index_t x;
+
+	while (fseeko(cap->fp, offset, SEEK_SET) == 0 &&
+	       fread(&h, sizeof h, 1, cap->fp) == 1 &&
+	       (chunk_head_le(&h), h.magic == CHUNK_MAGIC && h.bytes <= CHUNK_MAX &&
+	       offset + sizeof h + h.bytes <= size)) {
+		x.offset = offset;
+		x.t0 = h.t0;
+		x.t1 = h.t1;
+		x.sensor = h.sensor;
+		x.blocks = h.blocks;
+		x.bytes = h.bytes;
+		if (index_add(cap, &x)) {
+			return -1;
+		}
+		offset += sizeof h + h.bytes;
+	}
+	return 0;
+}
+
+rpi_capture_t* rpi_capture_open(const char* path) {
+	rpi_capture_t* cap;
+	file_head_t h;
+	uint64_t size;
+
+	if ((cap = calloc(1, sizeof *cap)) == NULL) {
+		return NULL;
+	}
+	if ((cap->fp = fopen(path, "rb")) == NULL) {
+		free(cap);
+		return NULL;
+	}
+	cap->block = block_alloc();
+	cap->buf = malloc(CHUNK_MAX);
+	if (cap->block == NULL || cap->buf == NULL ||
+	    fread(&h, sizeof h, 1, cap->fp) != 1 || memcmp(h.magic, CAP_MAGIC, 8) ||
+	    (file_head_le(&h), h.period_ns == 0) || fseeko(cap->fp, 0, SEEK_END)) {
+		rpi_capture_close(cap);
+		return NULL;
+	}
+	size = ftello(cap->fp);
+	cap->epoch_ns = h.epoch_ns;
+	cap->period_ns = h.period_ns;
+
+	cap->indexed = index_read(cap, size) == 0;
+	if (!cap->indexed && index_scan(cap, size)) {
+		rpi_capture_close(cap);
+		return NULL;
+	}
+	qsort(cap->index, cap->count, sizeof cap->index[0], index_cmp);
+	return cap;
+}
+
+void rpi_capture_info(rpi_capture_t* cap, rpi_capture_info_t* info) {
+	uint32_t i;
+
+	memset(info, 0, sizeof *info);
+	info->epoch_ns = cap->epoch_ns;
+	info->period_ns = cap->period_ns;
+	info->chunks = cap->count;
+	info->indexed = cap->indexed;
+	info->t0 = cap->count? UINT64_MAX: 0;
+	for (i = 0; i < cap->count; i++) {
+		const index_t* x = &cap->index[i];
+
+		info->t0 = (x->t0 < info->t0)? x->t0: info->t0;
+		info->t1 = (x->t1 > info->t1)? x->t1: info->t1;
+		info->sensors |= (x->sensor < 32)? 1U << x->sensor: 0;
+	}
+}
+
+// first chunk of sensor which may hold samples at from or later
+static uint32_t chunk_find(rpi_capture_t* cap, uint16_t sensor, uint64_t from) {
+	uint32_t lo = 0, hi = cap->count, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (cap->index[mid].sensor < sensor ||
+		    (cap->index[mid].sensor == sensor && cap->index[mid].t1 < from)) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static int chunk_head(rpi_capture_t* cap, const index_t* x, chunk_head_t* h) {
+	if (fseeko(cap->fp, x->offset, SEEK_SET) ||
+	    fread(h, sizeof *h, 1, cap->fp) != 1 ||
+	    (chunk_head_le(h), h->magic != CHUNK_MAGIC) || h->bytes != x->bytes ||
+	    h->bytes > CHUNK_MAX) {
+		return -1;
+	}
+	return 0;
+}
+
+typedef int (*chunk_row_fn)(void* arg, const rpi_block_t* b, int i);
+
+// decode the chunk of head h just read, fn for the rows within [from, to]
+static int chunk_rows(rpi_capture_t* cap, const chunk_head_t* h,
+                      uint64_t from, uint64_t to, chunk_row_fn fn, void* arg) {
+	const uint8_t* p = cap->buf;
+	const uint8_t* end = cap->buf + h->bytes;
+	int i, n, rt;
+
+	if (fread(cap->buf, 1, h->bytes, cap->fp) != h->bytes) {
+		return -1;
+	}
+	while (p < end) {
+		if ((n = rpi_codec_decode(p, end - p, cap->block)) < 0) {
+			return -1;
+		}
+		p += n;
+		for (i = 0; i < cap->block->count; i++) {
+			if (cap->block->ts[i] < from || cap->block->ts[i] > to) {
+				continue;
+			}
+			if ((rt = fn(arg, cap->block, i)) != 0) {
+				return rt;
+			}
+		}
+	}
+	return 0;
+}
+
+typedef struct {
+	rpi_capture_fn fn;
+	void* arg;
+	chunk_head_t h;
+} read_arg_t;
+
+static int read_row(void* arg, const rpi_block_t* b, int i) {
+	read_arg_t* r = arg;
+	rpi_sample_t s;
+
+	rpi_block_sample(b, i, &s);
+	return r->fn(r->arg, &s, &r->h.unit);
+}
+
+int rpi_capture_read(rpi_capture_t* cap, uint16_t sensor,
+                     uint64_t from, uint64_t to,
+                     rpi_capture_fn fn, void* arg) {
+	read_arg_t r;
+	uint32_t i;
+	int rt;
+
+	r.fn = fn;
+	r.arg = arg;
+	for (i = chunk_find(cap, sensor, from); i < cap->count; i++) {
+		const index_t* x = &cap->index[i];
+
+		if (x->sensor != sensor || x->t0 > to) {
+			break;
+		}
+		if (chunk_head(cap, x, &r.h)) {
+			return -1;
+		}
+		if ((rt = chunk_rows(cap, &r.h, from, to, read_row, &r)) != 0) {
+			return rt;
+		}
+	}
+	return 0;
+}
+
+static int stats_row(void* arg, const rpi_block_t* b, int i) {
+	sum_row(arg, b, i);
+	return 0;
+}
+
+int rpi_capture_stats(rpi_capture_t* cap, uint16_t sensor,
+                      uint64_t from, uint64_t to, rpi_capture_sum_t* sum,
+                      rpi_capture_unit_t* unit) {
+	rpi_capture_unit_t first;
+	chunk_head_t h;
+	uint32_t i;
+	int found = 0, decoded = 0;
+
+	sum_init(sum);
+	for (i = chunk_find(cap, sensor, from); i < cap->count; i++) {
+		const index_t* x = &cap->index[i];
+
+		if (x->sensor != sensor || x->t0 > to) {
+			break;
+		}
+		if (chunk_head(cap, x, &h)) {
+			return -1;
+		}
+		// counts of two units do not add up
+		if (found++ && memcmp(&h.unit, &first, sizeof first)) {
+			return RPI_CAPTURE_E_UNIT;
+		}
+		first = h.unit;
+		// whole chunk in range, its summary will do
+		if (x->t0 >= from && x->t1 <= to) {
+			sum_merge(sum, h.sum);
+			continue;
+		}
+		if (chunk_rows(cap, &h, from, to, stats_row, sum)) {
+			return -1;
+		}
+		decoded++;
+	}
+	if (unit != NULL) {
+		if (!found) {
+			memset(&first, 0, sizeof first);
+			first.scale[0] = first.scale[1] = 1.0f;
+			first.scale[2] = first.scale[3] = 1.0f;
+		}
+		*unit = first;
+	}
+	return decoded;
+}
+
+#ifdef __cplusplus
+}
+#endif
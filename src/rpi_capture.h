@@ -0,0 +1,146 @@
+/*
+ * Indexed capture files of sample blocks
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_CAPTURE_H__
+#define __RPI_CAPTURE_H__
+
+#include <stdint.h>
+#include "rpi_block.h"
+
+// summary channels: acc x y z, gyr x y z, mag x y z, temp
+#define RPI_CAPTURE_CH		10
+// sensors written at the same time
+#define RPI_CAPTURE_SENSORS	16
+// blocks of one chunk at most
+#define RPI_CAPTURE_BLOCKS	64
+
+// the unit of a sensor changed within the range of a query
+#define RPI_CAPTURE_E_UNIT	(-2)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Raw values of one channel over a time range, rows which carry
+ * the sensor of the channel only. mean = sum / n,
+ * rms = sqrt(sumsq / n).
+ */
+typedef struct {
+	uint32_t n;
+	int16_t min;
+	int16_t max;
+	int64_t sum;
+	uint64_t sumsq;
+} rpi_capture_sum_t;
+
+/*
+ * Physical value of a raw count: raw * scale + offset, per sensor
+ * of a sample: acc, gyr, mag, temp. Scale 1, offset 0 until set,
+ * that is raw counts.
+ */
+typedef struct {
+	float scale[4];
+	float offset[4];
+} rpi_capture_unit_t;
+
+/*
+ * Samples are written in chunks, each of one sensor and of one
+ * period of wall time at most (1 s by default, aligned to the
+ * period), rpi_codec blocks behind a header with the time span and
+ * rpi_capture_sum_t of every channel. The chunk index is appended
+ * at close, a file never closed is indexed by a scan of the chunk
+ * headers instead. Every chunk carries the unit of its sensor, a
+ * new unit starts a new chunk. All fields are little endian.
+ *
+ * A query finds the chunks of its range by binary search, an
+ * aggregate is merged from the headers of the chunks it covers
+ * and only the chunks cut by an end of the range are decoded, none
+ * at all for ranges aligned to the period.
+ */
+typedef struct rpi_capture rpi_capture_t;
+
+/***************************************************************
+ writing
+ ***************************************************************/
+// period_ns 0: 1 s, NULL: failed
+rpi_capture_t* rpi_capture_create(const char* path, uint64_t period_ns);
+/*
+ * unit of the samples of sensor from now on, eg. after a range
+ * switch, return 0: OK, <0: write failed or too many sensors
+ */
+int rpi_capture_unit(rpi_capture_t* cap, uint16_t sensor,
+                     const rpi_capture_unit_t* unit);
+// return 0: OK, <0: write failed or too many sensors
+int rpi_capture_block(rpi_capture_t* cap, const rpi_block_t* b);
+int rpi_capture_sample(rpi_capture_t* cap, const rpi_sample_t* s);
+// write out all open chunks and the index, return 0: OK
+int rpi_capture_close(rpi_capture_t* cap);
+
+/***************************************************************
+ reading, times in ns of CLOCK_MONOTONIC as the samples carry
+ ***************************************************************/
+// NULL: no capture file
+rpi_capture_t* rpi_capture_open(const char* path);
+
+typedef struct {
+	uint64_t epoch_ns;	// CLOCK_REALTIME - CLOCK_MONOTONIC when written
+	uint64_t period_ns;
+	uint64_t t0, t1;	// first and last sample, any sensor
+	uint32_t chunks;
+	uint32_t sensors;	// bit of every sensor id < 32 found
+	int indexed;		// 0: index rebuilt by a scan
+} rpi_capture_info_t;
+
+void rpi_capture_info(rpi_capture_t* cap, rpi_capture_info_t* info);
+
+/*
+ * every sample of sensor within [from, to] with the unit it was
+ * written in, fn returns !0 to stop
+ */
+typedef int (*rpi_capture_fn)(void* arg, const rpi_sample_t* s,
+                              const rpi_capture_unit_t* unit);
+int rpi_capture_read(rpi_capture_t* cap, uint16_t sensor,
+                     uint64_t from, uint64_t to,
+                     rpi_capture_fn fn, void* arg);
+
+/*
+ * sum[RPI_CAPTURE_CH] of sensor within [from, to] in raw counts of
+ * unit, NULL: not wanted
+ * return chunks decoded, RPI_CAPTURE_E_UNIT: the unit changed
+ * within the range, <0: read error
+ */
+int rpi_capture_stats(rpi_capture_t* cap, uint16_t sensor,
+                      uint64_t from, uint64_t to, rpi_capture_sum_t* sum,
+                      rpi_capture_unit_t* unit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_CAPTURE_H__
@@ -0,0 +1,398 @@
+/*
+ * Lossless codec of sample blocks
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <string.h>
+#include "rpi_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * stream header: predictor << 7 | bit width, then the values the predictor
+ * starts from, one for delta and two for linear, so a ramp packs in 0 bits
+ */
+#define PRED_DELTA	0
+#define PRED_LINEAR	1
+
+// rpi_block_t streams, bit of the mask in the block header
+#define STREAM_ACC	0	// 3 axes
+#define STREAM_GYR	3
+#define STREAM_MAG	6
+#define STREAM_TEMP	9
+#define STREAM_FLAGS	10
+#define STREAMS		11
+
+static inline uint32_t zigzag32(int32_t v) {
+	return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag32(uint32_t u) {
+	return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+static inline uint64_t zigzag64(int64_t v) {
+	return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag64(uint64_t u) {
+	return (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+}
+
+static inline int bit_width(uint64_t m) {
+	return m? 64 - __builtin_clzll(m): 0;
+}
+
+/***************************************************************
+ bit packing, little endian, LSB first
+ ***************************************************************/
+typedef struct {
+	uint8_t* p;
+	uint64_t acc;
+	int n;
+} bit_writer_t;
+
+static inline void bw_put32(bit_writer_t* w, uint32_t v, int bits) {
+	w->acc |= (uint64_t)v << w->n;
+	w->n += bits;
+	if (w->n >= 32) {
+		w->p[0] = w->acc;
+		w->p[1] = w->acc >> 8;
+		w->p[2] = w->acc >> 16;
+		w->p[3] = w->acc >> 24;
+		w->p += 4;
+		w->acc >>= 32;
+		w->n -= 32;
+	}
+}
+
+static inline void bw_put(bit_writer_t* w, uint64_t v, int bits) {
+	if (bits > 32) {
+		bw_put32(w, (uint32_t)v, 32);
+		bw_put32(w, (uint32_t)(v >> 32), bits - 32);
+	} else {
+		bw_put32(w, (uint32_t)v, bits);
+	}
+}
+
+// the rest, padded to a byte
+static inline uint8_t* bw_end(bit_writer_t* w) {
+	for (; w->n > 0; w->n -= 8) {
+		*w->p++ = w->acc;
+		w->acc >>= 8;
+	}
+	return w->p;
+}
+
+typedef struct {
+	const uint8_t* p;
+	const uint8_t* end;
+	uint64_t acc;
+	int n;
+} bit_reader_t;
+
+// return -1 past the end of the input
+static inline int br_get32(bit_reader_t* r, int bits, uint32_t* v) {
+	while (r->n < bits) {
+		if (r->p >= r->end) {
+			return -1;
+		}
+		r->acc |= (uint64_t)*r->p++ << r->n;
+		r->n += 8;
+	}
+	*v = (uint32_t)(r->acc & ((1ULL << bits) - 1));
+	r->acc >>= bits;
+	r->n -= bits;
+	return 0;
+}
+
+static inline int br_get(bit_reader_t* r, int bits, uint64_t* v) {
+	uint32_t lo, hi = 0;
+
+	if (bits > 32) {
+		if (br_get32(r, 32, &lo) || br_get32(r, bits - 32, &hi)) {
+			return -1;
+		}
+	} else if (br_get32(r, bits, &lo)) {
+		return -1;
+	}
+	*v = (uint64_t)hi << 32 | lo;
+	return 0;
+}
+
+/***************************************************************
+ int16 streams
+ ***************************************************************/
+static inline int32_t s16_residual(const int16_t* v, int i, int pred) {
+	if (pred == PRED_LINEAR) {
+		return v[i] - 2 * v[i - 1] + v[i - 2];
+	}
+	return v[i] - v[i - 1];
+}
+
+size_t rpi_codec_encode_s16(const int16_t* v, int n, uint8_t* out) {
+	bit_writer_t w;
+	uint32_t m1 = 0, m2 = 0;
+	int i, pred, width, start;
+
+	if (n <= 0) {
+		return 0;
+	}
+	// both predictors in one pass, keep the narrower
+	for (i = 2; i < n; i++) {
+		m1 |= zigzag32(s16_residual(v, i, PRED_DELTA));
+		m2 |= zigzag32(s16_residual(v, i, PRED_LINEAR));
+	}
+	if (n > 1) {
+		m1 |= zigzag32(s16_residual(v, 1, PRED_DELTA));
+	}
+	pred = (n > 2 && bit_width(m2) < bit_width(m1))? PRED_LINEAR: PRED_DELTA;
+	width = bit_width(pred == PRED_LINEAR? m2: m1);
+	start = 1 + pred;
+
+	out[0] = pred << 7 | width;
+	for (i = 0; i < start; i++) {
+		out[1 + 2 * i] = (uint16_t)v[i];
+		out[2 + 2 * i] = (uint16_t)v[i] >> 8;
+	}
+	if (width == 0) {
+		return 1 + 2 * start;
+	}
+	w.p = out + 1 + 2 * start;
+	w.acc = 0;
+	w.n = 0;
+	for (i = start; i < n; i++) {
+		bw_put32(&w, zigzag32(s16_residual(v, i, pred)), width);
+	}
+	return bw_end(&w) - out;
+}
+
+int rpi_codec_decode_s16(const uint8_t* in, size_t len, int16_t* v, int n) {
+	bit_reader_t r;
+	uint32_t u;
+	int i, pred, width, start;
+
+	if (n <= 0) {
+		return 0;
+	}
+	if (len < 1 || (width = in[0] & 0x7F) > 18) {
+		return -1;
+	}
+	pred = in[0] >> 7;
+	start = 1 + pred;
+	if (len < 1 + 2 * (size_t)start || start > n) {
+		return -1;
+	}
+	for (i = 0; i < start; i++) {
+		v[i] = (int16_t)(in[2 + 2 * i] << 8 | in[1 + 2 * i]);
+	}
+
+	r.p = in + 1 + 2 * start;
+	r.end = in + len;
+	r.acc = 0;
+	r.n = 0;
+	for (i = start; i < n; i++) {
+		u = 0;
+		if (width && br_get32(&r, width, &u)) {
+			return -1;
+		}
+		if (pred == PRED_LINEAR) {
+			v[i] = (int16_t)(2 * v[i - 1] - v[i - 2] + unzigzag32(u));
+		} else {
+			v[i] = (int16_t)(v[i - 1] + unzigzag32(u));
+		}
+	}
+	return r.p - in;
+}
+
+/***************************************************************
+ timestamps, the same on 64 bits
+ ***************************************************************/
+static inline int64_t ts_residual(const uint64_t* t, int i, int pred) {
+	if (pred == PRED_LINEAR) {
+		return (int64_t)(t[i] - 2 * t[i - 1] + t[i - 2]);
+	}
+	return (int64_t)(t[i] - t[i - 1]);
+}
+
+static size_t ts_encode(const uint64_t* t, int n, uint8_t* out) {
+	bit_writer_t w;
+	uint64_t m1 = 0, m2 = 0;
+	int i, j, pred, width, start;
+
+	for (i = 2; i < n; i++) {
+		m1 |= zigzag64(ts_residual(t, i, PRED_DELTA));
+		m2 |= zigzag64(ts_residual(t, i, PRED_LINEAR));
+	}
+	if (n > 1) {
+		m1 |= zigzag64(ts_residual(t, 1, PRED_DELTA));
+	}
+	pred = (n > 2 && bit_width(m2) < bit_width(m1))? PRED_LINEAR: PRED_DELTA;
+	width = bit_width(pred == PRED_LINEAR? m2: m1);
+	start = 1 + pred;
+
+	out[0] = pred << 7 | width;
+	for (i = 0; i < start; i++) {
+		for (j = 0; j < 8; j++) {
+			out[1 + 8 * i + j] = t[i] >> (j * 8);
+		}
+	}
+	if (width == 0) {
+		return 1 + 8 * start;
+	}
+	w.p = out + 1 + 8 * start;
+	w.acc = 0;
+	w.n = 0;
+	for (i = start; i < n; i++) {
+		bw_put(&w, zigzag64(ts_residual(t, i, pred)), width);
+	}
+	return bw_end(&w) - out;
+}
+
+static int ts_decode(const uint8_t* in, size_t len, uint64_t* t, int n) {
+	bit_reader_t r;
+	uint64_t u;
+	int i, j, pred, width, start;
+
+	if (len < 1 || (width = in[0] & 0x7F) > 64) {
+		return -1;
+	}
+	pred = in[0] >> 7;
+	start = 1 + pred;
+	if (len < 1 + 8 * (size_t)start || start > n) {
+		return -1;
+	}
+	for (i = 0; i < start; i++) {
+		for (j = 0, t[i] = 0; j < 8; j++) {
+			t[i] |= (uint64_t)in[1 + 8 * i + j] << (j * 8);
+		}
+	}
+
+	r.p = in + 1 + 8 * start;
+	r.end = in + len;
+	r.acc = 0;
+	r.n = 0;
+	for (i = start; i < n; i++) {
+		u = 0;
+		if (width && br_get(&r, width, &u)) {
+			return -1;
+		}
+		if (pred == PRED_LINEAR) {
+			t[i] = 2 * t[i - 1] - t[i - 2] + unzigzag64(u);
+		} else {
+			t[i] = t[i - 1] + unzigzag64(u);
+		}
+	}
+	return r.p - in;
+}
+
+/***************************************************************
+ blocks: version, count, sensor, stream mask, timestamps, streams
+ ***************************************************************/
+static const int16_t* block_stream(const rpi_block_t* b, int s) {
+	if (s < STREAM_GYR) {
+		return b->acc[s - STREAM_ACC];
+	} else if (s < STREAM_MAG) {
+		return b->gyr[s - STREAM_GYR];
+	} else if (s < STREAM_TEMP) {
+		return b->mag[s - STREAM_MAG];
+	}
+	return s == STREAM_TEMP? b->temp: (const int16_t*)b->flags;
+}
+
+size_t rpi_codec_encode(const rpi_block_t* b, uint8_t* out) {
+	uint8_t* p = out + 6;
+	uint16_t flags = 0, mask;
+	int i, s;
+
+	for (i = 0; i < b->count; i++) {
+		flags |= b->flags[i];
+	}
+	mask = 1 << STREAM_FLAGS;
+	mask |= (flags & RPI_SAMPLE_ACC)? 7 << STREAM_ACC: 0;
+	mask |= (flags & RPI_SAMPLE_GYR)? 7 << STREAM_GYR: 0;
+	mask |= (flags & RPI_SAMPLE_MAG)? 7 << STREAM_MAG: 0;
+	mask |= (flags & RPI_SAMPLE_TEMP)? 1 << STREAM_TEMP: 0;
+
+	out[0] = RPI_CODEC_VERSION;
+	out[1] = b->count;
+	out[2] = b->sensor;
+	out[3] = b->sensor >> 8;
+	out[4] = mask;
+	out[5] = mask >> 8;
+	if (b->count == 0) {
+		return p - out;
+	}
+
+	p += ts_encode(b->ts, b->count, p);
+	for (s = 0; s < STREAMS; s++) {
+		if (mask & (1 << s)) {
+			p += rpi_codec_encode_s16(block_stream(b, s), b->count, p);
+		}
+	}
+	return p - out;
+}
+
+int rpi_codec_decode(const uint8_t* in, size_t len, rpi_block_t* b) {
+	const uint8_t* p = in + 6;
+	const uint8_t* end = in + len;
+	uint16_t mask;
+	int rt, s;
+
+	if (len < 6 || in[0] != RPI_CODEC_VERSION || in[1] > RPI_BLOCK_LEN) {
+		return -1;
+	}
+	b->count = in[1];
+	b->sensor = in[2] | in[3] << 8;
+	mask = in[4] | in[5] << 8;
+	if (b->count == 0) {
+		return p - in;
+	}
+
+	if ((rt = ts_decode(p, end - p, b->ts, b->count)) < 0) {
+		return -1;
+	}
+	p += rt;
+	for (s = 0; s < STREAMS; s++) {
+		int16_t* v = (int16_t*)block_stream(b, s);
+
+		if (!(mask & (1 << s))) {
+			memset(v, 0, b->count * sizeof v[0]);
+			continue;
+		}
+		if ((rt = rpi_codec_decode_s16(p, end - p, v, b->count)) < 0) {
+			return -1;
+		}
+		p += rt;
+	}
+	return p - in;
+}
+
+#ifdef __cplusplus
+}
+#endif
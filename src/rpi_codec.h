@@ -0,0 +1,72 @@
+/*
+ * Lossless codec of sample blocks
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_CODEC_H__
+#define __RPI_CODEC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rpi_block.h"
+
+#define RPI_CODEC_VERSION	1
+
+// encoded size of one block at most, bytes
+#define RPI_CODEC_MAX_BYTES	(6 + \
+	(1 + 8 + (RPI_BLOCK_LEN - 1) * 8) + \
+	11 * (1 + 2 + ((RPI_BLOCK_LEN - 1) * 18 + 7) / 8))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Every axis a stream of its own, per block:
+ *   prediction  previous value (delta) or linear from the two
+ *               before, whichever leaves the smaller residuals
+ *   zigzag      signed residuals to small unsigned ones
+ *   bit-packing all residuals of the stream at the width of the
+ *               largest one, 0 bits for a constant or a ramp
+ * Timestamps the same way on 64 bits. Sensors no row carries are
+ * not stored and come back as 0.
+ */
+
+// return bytes written to out, RPI_CODEC_MAX_BYTES at most
+size_t rpi_codec_encode(const rpi_block_t* b, uint8_t* out);
+
+// return bytes used from in, <0: corrupt or truncated
+int rpi_codec_decode(const uint8_t* in, size_t len, rpi_block_t* b);
+
+// one series of n values, same stream format
+size_t rpi_codec_encode_s16(const int16_t* v, int n, uint8_t* out);
+int rpi_codec_decode_s16(const uint8_t* in, size_t len, int16_t* v, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_CODEC_H__
@@ -0,0 +1,337 @@
+/*
+ * Batch raw-to-physical conversion kernels
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <string.h>
+#include "rpi_convert.h"
+#include "rpi_trace.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HAS_NEON	1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAS_X86		1
+#endif
+
+typedef void (*convert_fn)(const rpi_convert_t*, const int16_t*, size_t,
+                           float*, float*, float*);
+
+void rpi_convert_init(
+	rpi_convert_t* cv,
+	const float scale[3],
+	const float offset[3],
+	const float align[9]
+) {
+	static const float identity[9] = {
+		1.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 1.0f,
+	};
+	int i, j;
+
+	if (align == NULL) {
+		align = identity;
+	}
+
+	for (i = 0; i < 3; i++) {
+		cv->c[i] = 0.0f;
+		for (j = 0; j < 3; j++) {
+			cv->k[i * 3 + j] = align[i * 3 + j] * scale[j];
+			if (offset != NULL) {
+				cv->c[i] += align[i * 3 + j] * offset[j];
+			}
+		}
+	}
+}
+
+void rpi_convert_s16x3_scalar(
+	const rpi_convert_t* cv,
+	const int16_t* raw, size_t n,
+	float* x, float* y, float* z
+) {
+	const float* k = cv->k;
+	size_t i;
+
+	for (i = 0; i < n; i++, raw += 3) {
+		float rx = raw[0], ry = raw[1], rz = raw[2];
+
+		x[i] = k[0] * rx + k[1] * ry + k[2] * rz + cv->c[0];
+		y[i] = k[3] * rx + k[4] * ry + k[5] * rz + cv->c[1];
+		z[i] = k[6] * rx + k[7] * ry + k[8] * rz + cv->c[2];
+	}
+}
+
+// unit stride on every stream, left to the compiler to vectorize
+void rpi_convert_s16soa(
+	const rpi_convert_t* cv,
+	const int16_t* rx, const int16_t* ry, const int16_t* rz, size_t n,
+	float* x, float* y, float* z
+) {
+	const float* k = cv->k;
+	size_t i;
+
+	RPI_TRACE_BEGIN(RPI_TRACE_CONVERT);
+	for (i = 0; i < n; i++) {
+		float fx = rx[i], fy = ry[i], fz = rz[i];
+
+		x[i] = k[0] * fx + k[1] * fy + k[2] * fz + cv->c[0];
+		y[i] = k[3] * fx + k[4] * fy + k[5] * fz + cv->c[1];
+		z[i] = k[6] * fx + k[7] * fy + k[8] * fz + cv->c[2];
+	}
+	RPI_TRACE_END(RPI_TRACE_CONVERT);
+}
+
+#if HAS_NEON
+static void convert_neon(
+	const rpi_convert_t* cv,
+	const int16_t* raw, size_t n,
+	float* x, float* y, float* z
+) {
+	const float* k = cv->k;
+	size_t i;
+
+	for (i = 0; i + 4 <= n; i += 4, raw += 12) {
+		int16x4x3_t v = vld3_s16(raw);
+		float32x4_t rx = vcvtq_f32_s32(vmovl_s16(v.val[0]));
+		float32x4_t ry = vcvtq_f32_s32(vmovl_s16(v.val[1]));
+		float32x4_t rz = vcvtq_f32_s32(vmovl_s16(v.val[2]));
+		float32x4_t o;
+
+		o = vdupq_n_f32(cv->c[0]);
+		o = vmlaq_n_f32(o, rx, k[0]);
+		o = vmlaq_n_f32(o, ry, k[1]);
+		o = vmlaq_n_f32(o, rz, k[2]);
+		vst1q_f32(x + i, o);
+
+		o = vdupq_n_f32(cv->c[1]);
+		o = vmlaq_n_f32(o, rx, k[3]);
+		o = vmlaq_n_f32(o, ry, k[4]);
+		o = vmlaq_n_f32(o, rz, k[5]);
+		vst1q_f32(y + i, o);
+
+		o = vdupq_n_f32(cv->c[2]);
+		o = vmlaq_n_f32(o, rx, k[6]);
+		o = vmlaq_n_f32(o, ry, k[7]);
+		o = vmlaq_n_f32(o, rz, k[8]);
+		vst1q_f32(z + i, o);
+	}
+	rpi_convert_s16x3_scalar(cv, raw, n - i, x + i, y + i, z + i);
+}
+#endif
+
+#if HAS_X86
+/*
+ * 8 triplets = 24 int16 = 3 x 128 bits, gather each axis with
+ * one pshufb per source register, 0x80 mask bytes produce zero.
+ */
+#define Z	(short)0x8080
+#define W(n)	(short)((2 * (n)) | (2 * (n) + 1) << 8)
+#define PICK(v, a, b, c, d, e, f, g, h)	\
+	_mm_shuffle_epi8(v, _mm_setr_epi16(a, b, c, d, e, f, g, h))
+
+__attribute__((target("ssse3")))
+static inline void deinterleave8(
+	const int16_t* raw,
+	__m128i* vx, __m128i* vy, __m128i* vz
+) {
+	const __m128i a = _mm_loadu_si128((const __m128i*)(raw + 0));
+	const __m128i b = _mm_loadu_si128((const __m128i*)(raw + 8));
+	const __m128i c = _mm_loadu_si128((const __m128i*)(raw + 16));
+
+	// x: a0 a3 a6 b1 b4 b7 c2 c5
+	*vx = _mm_or_si128(_mm_or_si128(
+	      PICK(a, W(0), W(3), W(6), Z,    Z,    Z,    Z,    Z   ),
+	      PICK(b, Z,    Z,    Z,    W(1), W(4), W(7), Z,    Z   )),
+	      PICK(c, Z,    Z,    Z,    Z,    Z,    Z,    W(2), W(5)));
+	// y: a1 a4 a7 b2 b5 c0 c3 c6
+	*vy = _mm_or_si128(_mm_or_si128(
+	      PICK(a, W(1), W(4), W(7), Z,    Z,    Z,    Z,    Z   ),
+	      PICK(b, Z,    Z,    Z,    W(2), W(5), Z,    Z,    Z   )),
+	      PICK(c, Z,    Z,    Z,    Z,    Z,    W(0), W(3), W(6)));
+	// z: a2 a5 b0 b3 b6 c1 c4 c7
+	*vz = _mm_or_si128(_mm_or_si128(
+	      PICK(a, W(2), W(5), Z,    Z,    Z,    Z,    Z,    Z   ),
+	      PICK(b, Z,    Z,    W(0), W(3), W(6), Z,    Z,    Z   )),
+	      PICK(c, Z,    Z,    Z,    Z,    Z,    W(1), W(4), W(7)));
+}
+
+#undef PICK
+#undef Z
+#undef W
+
+// sign extend lower / upper 4 int16 lanes to float
+#define LO_PS(v)	_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16))
+#define HI_PS(v)	_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16))
+
+#define MADD3_SSE(row, rx, ry, rz)					\
+	_mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, k##row##0),		\
+	                      _mm_mul_ps(ry, k##row##1)),		\
+	           _mm_add_ps(_mm_mul_ps(rz, k##row##2), c##row))
+
+__attribute__((target("ssse3")))
+static void convert_ssse3(
+	const rpi_convert_t* cv,
+	const int16_t* raw, size_t n,
+	float* x, float* y, float* z
+) {
+	const __m128 k00 = _mm_set1_ps(cv->k[0]), k01 = _mm_set1_ps(cv->k[1]), k02 = _mm_set1_ps(cv->k[2]);
+	const __m128 k10 = _mm_set1_ps(cv->k[3]), k11 = _mm_set1_ps(cv->k[4]), k12 = _mm_set1_ps(cv->k[5]);
+	const __m128 k20 = _mm_set1_ps(cv->k[6]), k21 = _mm_set1_ps(cv->k[7]), k22 = _mm_set1_ps(cv->k[8]);
+	const __m128 c0 = _mm_set1_ps(cv->c[0]), c1 = _mm_set1_ps(cv->c[1]), c2 = _mm_set1_ps(cv->c[2]);
+	size_t i;
+
+	for (i = 0; i + 8 <= n; i += 8, raw += 24) {
+		__m128i vx, vy, vz;
+		__m128 rx, ry, rz;
+
+		deinterleave8(raw, &vx, &vy, &vz);
+
+		rx = LO_PS(vx); ry = LO_PS(vy); rz = LO_PS(vz);
+		_mm_storeu_ps(x + i, MADD3_SSE(0, rx, ry, rz));
+		_mm_storeu_ps(y + i, MADD3_SSE(1, rx, ry, rz));
+		_mm_storeu_ps(z + i, MADD3_SSE(2, rx, ry, rz));
+
+		rx = HI_PS(vx); ry = HI_PS(vy); rz = HI_PS(vz);
+		_mm_storeu_ps(x + i + 4, MADD3_SSE(0, rx, ry, rz));
+		_mm_storeu_ps(y + i + 4, MADD3_SSE(1, rx, ry, rz));
+		_mm_storeu_ps(z + i + 4, MADD3_SSE(2, rx, ry, rz));
+	}
+	rpi_convert_s16x3_scalar(cv, raw, n - i, x + i, y + i, z + i);
+}
+
+#define MADD3_AVX(row, rx, ry, rz)					\
+	_mm256_fmadd_ps(rz, k##row##2,					\
+	_mm256_fmadd_ps(ry, k##row##1,					\
+	_mm256_fmadd_ps(rx, k##row##0, c##row)))
+
+#define S16_PS(v)	_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v))
+
+__attribute__((target("avx2,fma")))
+static void convert_avx2(
+	const rpi_convert_t* cv,
+	const int16_t* raw, size_t n,
+	float* x, float* y, float* z
+) {
+	const __m256 k00 = _mm256_set1_ps(cv->k[0]), k01 = _mm256_set1_ps(cv->k[1]), k02 = _mm256_set1_ps(cv->k[2]);
+	const __m256 k10 = _mm256_set1_ps(cv->k[3]), k11 = _mm256_set1_ps(cv->k[4]), k12 = _mm256_set1_ps(cv->k[5]);
+	const __m256 k20 = _mm256_set1_ps(cv->k[6]), k21 = _mm256_set1_ps(cv->k[7]), k22 = _mm256_set1_ps(cv->k[8]);
+	const __m256 c0 = _mm256_set1_ps(cv->c[0]), c1 = _mm256_set1_ps(cv->c[1]), c2 = _mm256_set1_ps(cv->c[2]);
+	size_t i;
+
+	for (i = 0; i + 8 <= n; i += 8, raw += 24) {
+		__m128i vx, vy, vz;
+		__m256 rx, ry, rz;
+
+		deinterleave8(raw, &vx, &vy, &vz);
+		rx = S16_PS(vx);
+		ry = S16_PS(vy);
+		rz = S16_PS(vz);
+
+		_mm256_storeu_ps(x + i, MADD3_AVX(0, rx, ry, rz));
+		_mm256_storeu_ps(y + i, MADD3_AVX(1, rx, ry, rz));
+		_mm256_storeu_ps(z + i, MADD3_AVX(2, rx, ry, rz));
+	}
+	rpi_convert_s16x3_scalar(cv, raw, n - i, x + i, y + i, z + i);
+}
+#endif
+
+typedef struct {
+	const char* name;
+	convert_fn fn;
+} convert_kernel_t;
+
+static const convert_kernel_t convert_kernels[] = {
+	#if HAS_NEON
+	{ "neon",   convert_neon },
+	#elif HAS_X86
+	{ "avx2",   convert_avx2 },
+	{ "ssse3",  convert_ssse3 },
+	#endif
+	{ "scalar", rpi_convert_s16x3_scalar },
+};
+
+#define KERNEL_COUNT	(int)(sizeof convert_kernels / sizeof convert_kernels[0])
+
+// the kernel picked, name and function swapped together between threads
+static const convert_kernel_t* convert_sel;
+
+static const convert_kernel_t* convert_get(void) {
+	const convert_kernel_t* k = __atomic_load_n(&convert_sel, __ATOMIC_ACQUIRE);
+
+	if (k == NULL) {
+		rpi_convert_use(NULL);
+		k = __atomic_load_n(&convert_sel, __ATOMIC_ACQUIRE);
+	}
+	return k;
+}
+
+static int kernel_usable(const char* name) {
+	#if HAS_X86
+	__builtin_cpu_init();
+	if (strcmp(name, "avx2") == 0) {
+		return __builtin_cpu_supports("avx2") &&
+		       __builtin_cpu_supports("fma");
+	}
+	if (strcmp(name, "ssse3") == 0) {
+		return __builtin_cpu_supports("ssse3");
+	}
+	#endif
+	return name != NULL;
+}
+
+int rpi_convert_use(const char* name) {
+	int i;
+
+	for (i = 0; i < KERNEL_COUNT; i++) {
+		if (name != NULL && strcmp(name, convert_kernels[i].name) != 0) {
+			continue;
+		}
+		if (!kernel_usable(convert_kernels[i].name)) {
+			continue;
+		}
+		__atomic_store_n(&convert_sel, &convert_kernels[i], __ATOMIC_RELEASE);
+		return 0;
+	}
+	return -1;
+}
+
+void rpi_convert_s16x3(
+	const rpi_convert_t* cv,
+	const int16_t* raw, size_t n,
+	float* x, float* y, float* z
+) {
+	convert_fn fn = convert_get()->fn;
+
+	RPI_TRACE_BEGIN(RPI_TRACE_CONVERT);
+	fn(cv, raw, n, x, y, z);
+	RPI_TRACE_END(RPI_TRACE_CONVERT);
+}
+
+const char* rpi_convert_kernel(void) {
+	return convert_get()->name;
+}
@@ -0,0 +1,95 @@
+/*
+ * Batch raw-to-physical conversion kernels
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_CONVERT_H__
+#define __RPI_CONVERT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * For every raw sample r (int16 x/y/z triplet)
+ *     p   = r * scale + offset        (per axis)
+ *     out = align * p                 (3x3, row major)
+ * folded into a single matrix at init time,
+ *     out = k * r + c
+ * so a kernel costs 9 multiply-adds per sample.
+ */
+typedef struct {
+	float k[9];
+	float c[3];
+} rpi_convert_t;
+
+// offset == NULL: no offset
+// align  == NULL: identity
+void rpi_convert_init(
+	rpi_convert_t* cv,
+	const float scale[3],
+	const float offset[3],
+	const float align[9]
+);
+
+// raw: n interleaved triplets x0 y0 z0 x1 y1 z1 ...
+// x/y/z: n floats each, no alignment requirement
+void rpi_convert_s16x3(
+	const rpi_convert_t* cv,
+	const int16_t* raw, size_t n,
+	float* x, float* y, float* z
+);
+
+// rx/ry/rz: n raw values of each axis, eg. rows of an rpi_block_t
+void rpi_convert_s16soa(
+	const rpi_convert_t* cv,
+	const int16_t* rx, const int16_t* ry, const int16_t* rz, size_t n,
+	float* x, float* y, float* z
+);
+
+// portable reference kernel
+void rpi_convert_s16x3_scalar(
+	const rpi_convert_t* cv,
+	const int16_t* raw, size_t n,
+	float* x, float* y, float* z
+);
+
+// name of the kernel selected for this CPU
+const char* rpi_convert_kernel(void);
+
+// force a kernel: "neon", "avx2", "ssse3", "scalar",
+// NULL picks the best one supported by this CPU.
+// return 0: OK, -1: not available here
+int rpi_convert_use(const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_CONVERT_H__
@@ -0,0 +1,168 @@
+/*
+ * Change driven sample emission
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <string.h>
+#include "rpi_deadband.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NS_PER_MS	1000000ULL
+
+// 8 rows of an axis, 128 bit on SSE2 and NEON
+typedef int16_t v8hi __attribute__((vector_size(16), aligned(2), may_alias));
+
+void rpi_deadband_init(
+	rpi_deadband_t* db,
+	int32_t acc_band,
+	int32_t gyr_band,
+	int32_t mag_band,
+	uint32_t heartbeat_ms
+) {
+	int k;
+
+	memset(db, 0, sizeof *db);
+	for (k = 0; k < 3; k++) {
+		db->band[k] = acc_band;
+		db->band[3 + k] = gyr_band;
+		db->band[6 + k] = mag_band;
+	}
+	db->heartbeat = heartbeat_ms * NS_PER_MS;
+}
+
+static inline int16_t clamp16(int32_t v) {
+	return v > INT16_MAX? INT16_MAX: v < INT16_MIN? INT16_MIN: v;
+}
+
+// the window of axis k moves to v
+static inline void db_ref(rpi_deadband_t* db, int k, int16_t v) {
+	db->hi[k] = clamp16(v + db->band[k]);
+	db->lo[k] = clamp16(v - db->band[k]);
+}
+
+static void db_emit(rpi_deadband_t* db, const int16_t* v[3], uint16_t flags, uint64_t ts) {
+	int g;
+
+	for (g = 0; g < 3; g++) {
+		if (flags & (RPI_SAMPLE_ACC << g)) {
+			db_ref(db, g * 3 + 0, v[g][0]);
+			db_ref(db, g * 3 + 1, v[g][1]);
+			db_ref(db, g * 3 + 2, v[g][2]);
+		}
+	}
+	db->due = db->heartbeat? ts + db->heartbeat: UINT64_MAX;
+	db->have_ref = 1;
+}
+
+int rpi_deadband_sample(rpi_deadband_t* db, const rpi_sample_t* s) {
+	const int16_t* v[3] = { s->acc, s->gyr, s->mag };
+	int g, k, hit;
+
+	db->in++;
+	hit = !db->have_ref | (s->ts >= db->due);
+	for (g = 0; g < 3; g++) {
+		int on = !!(s->flags & (RPI_SAMPLE_ACC << g));
+
+		for (k = 0; k < 3; k++) {
+			int i = g * 3 + k;
+
+			hit |= on & ((v[g][k] > db->hi[i]) | (v[g][k] < db->lo[i]));
+		}
+	}
+	if (!hit) {
+		return 0;
+	}
+	db_emit(db, v, s->flags, s->ts);
+	db->out++;
+	return 1;
+}
+
+// bit l: row g + l leaves the band or is due
+static uint32_t db_group(const rpi_deadband_t* db, const rpi_block_t* b, int g) {
+	const int16_t* rows[9] = {
+		b->acc[0], b->acc[1], b->acc[2],
+		b->gyr[0], b->gyr[1], b->gyr[2],
+		b->mag[0], b->mag[1], b->mag[2],
+	};
+	v8hi fl = *(const v8hi*)(b->flags + g);
+	v8hi hit = { 0 };
+	v8hi x, on, hi, lo;
+	uint32_t bits = 0;
+	int k, l;
+
+	for (k = 0; k < 9; k++) {
+		x = *(const v8hi*)(rows[k] + g);
+		on = (fl & (int16_t)(RPI_SAMPLE_ACC << (k / 3))) != 0;
+		hi = (v8hi){ 0 } + db->hi[k];
+		lo = (v8hi){ 0 } + db->lo[k];
+		hit |= ((x > hi) | (x < lo)) & on;
+	}
+	for (l = 0; l < 8; l++) {
+		bits |= ((hit[l] & 1) | (b->ts[g + l] >= db->due)) << l;
+	}
+	return bits;
+}
+
+int rpi_deadband_block(rpi_deadband_t* db, const rpi_block_t* b, uint8_t* idx) {
+	int n = b->count, m = 0, i = 0, g;
+	uint32_t bits, valid;
+
+	db->in += n;
+	while (i < n) {
+		int16_t acc[3], gyr[3], mag[3];
+		const int16_t* v[3] = { acc, gyr, mag };
+
+		if (db->have_ref) {
+			// rows i .. end of the group of 8, one vector pass
+			g = i & ~7;
+			valid = (n - g >= 8)? 0xFF: (1u << (n - g)) - 1;
+			bits = db_group(db, b, g) & valid & (0xFFu << (i - g));
+			if (bits == 0) {
+				i = g + 8;
+				continue;
+			}
+			i = g + __builtin_ctz(bits);
+		}
+
+		// the window moves with every row sent
+		for (g = 0; g < 3; g++) {
+			acc[g] = b->acc[g][i];
+			gyr[g] = b->gyr[g][i];
+			mag[g] = b->mag[g][i];
+		}
+		db_emit(db, v, b->flags[i], b->ts[i]);
+		idx[m++] = i++;
+	}
+	db->out += m;
+	return m;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,85 @@
+/*
+ * Change driven sample emission
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_DEADBAND_H__
+#define __RPI_DEADBAND_H__
+
+#include <stdint.h>
+#include "rpi_sample.h"
+#include "rpi_block.h"
+
+// band of an axis that never triggers
+#define RPI_DEADBAND_OFF	0x10000
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Output stage of one stream: a sample goes on only when an axis
+ * moved more than its band away from the last sample sent, or the
+ * heartbeat interval since that one ran out.
+ * Axes: acc x y z, gyr x y z, mag x y z; an axis is compared only
+ * in samples whose flags carry its sensor.
+ */
+typedef struct {
+	int32_t band[9];	// raw counts
+	uint64_t heartbeat;	// ns, 0: none
+	// last sample sent
+	int have_ref;
+	int16_t hi[9];		// ref + band, clamped
+	int16_t lo[9];		// ref - band, clamped
+	uint64_t due;		// heartbeat of the next one
+	// statistics
+	uint64_t in;
+	uint64_t out;
+} rpi_deadband_t;
+
+void rpi_deadband_init(
+	rpi_deadband_t* db,
+	int32_t acc_band,
+	int32_t gyr_band,
+	int32_t mag_band,
+	uint32_t heartbeat_ms
+);
+
+// return 1: send s, 0: drop it
+int rpi_deadband_sample(rpi_deadband_t* db, const rpi_sample_t* s);
+
+/*
+ * Rows of b to send, in order, into idx (RPI_BLOCK_LEN entries);
+ * b is left as it is, for other holders.
+ * return the number of rows
+ */
+int rpi_deadband_block(rpi_deadband_t* db, const rpi_block_t* b, uint8_t* idx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_DEADBAND_H__
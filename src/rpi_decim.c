@@ -0,0 +1,245 @@
+/*
+ * Streaming decimation of 3-axis samples
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "rpi_decim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+// 4 floats, no alignment requirement: NEON / SSE registers
+typedef float v4sf __attribute__((vector_size(16), aligned(4), may_alias));
+
+// n: multiple of 8
+static inline float dot(const float* a, const float* b, int n) {
+	v4sf s0 = { 0, 0, 0, 0 };
+	v4sf s1 = { 0, 0, 0, 0 };
+	int i;
+
+	for (i = 0; i < n; i += 8) {
+		s0 += *(const v4sf*)(a + i) * *(const v4sf*)(b + i);
+		s1 += *(const v4sf*)(a + i + 4) * *(const v4sf*)(b + i + 4);
+	}
+	s0 += s1;
+	return (s0[0] + s0[1]) + (s0[2] + s0[3]);
+}
+#else
+static inline float dot(const float* a, const float* b, int n) {
+	float s = 0.0f;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		s += a[i] * b[i];
+	}
+	return s;
+}
+#endif
+
+int rpi_decim_fir_init(rpi_decim_t* d, int factor, int taps, double cutoff) {
+	double fc, sum, w, t;
+	int i, len;
+
+	memset(d, 0, sizeof *d);
+	if (factor < 1) {
+		return -1;
+	}
+	if (taps <= 0) {
+		taps = 8 * factor;
+	}
+	if (cutoff <= 0.0 || cutoff > 1.0) {
+		cutoff = 0.8;
+	}
+	// padded with leading zero taps
+	len = (taps + 7) & ~7;
+	if (len > RPI_DECIM_MAX_TAPS) {
+		return -1;
+	}
+
+	d->type = RPI_DECIM_FIR;
+	d->factor = factor;
+	d->taps = len;
+	d->coef = calloc(len + 3 * (len - 1 + RPI_DECIM_BLOCK), sizeof(float));
+	if (d->coef == NULL) {
+		return -1;
+	}
+	// per axis histories right after the taps, one allocation
+	for (i = 0; i < 3; i++) {
+		d->hist[i] = d->coef + len + i * (len - 1 + RPI_DECIM_BLOCK);
+	}
+
+	// cycles per input sample
+	fc = 0.5 * cutoff / factor;
+	sum = 0.0;
+	for (i = 0; i < taps; i++) {
+		t = i - (taps - 1) / 2.0;
+		// Blackman window
+		w = 0.42 - 0.5 * cos(2 * M_PI * i / (taps - 1 + (taps == 1)))
+		         + 0.08 * cos(4 * M_PI * i / (taps - 1 + (taps == 1)));
+		w *= (t == 0.0)? 2 * fc: sin(2 * M_PI * fc * t) / (M_PI * t);
+		// reversed: oldest sample first in the history
+		d->coef[len - 1 - i] = (float)w;
+		sum += w;
+	}
+	for (i = 0; i < len; i++) {
+		d->coef[i] = (float)(d->coef[i] / sum);
+	}
+	return 0;
+}
+
+int rpi_decim_cic_init(rpi_decim_t* d, int factor, int order, double fullscale) {
+	double growth;
+
+	memset(d, 0, sizeof *d);
+	if (factor < 1 || order < 1 || order > RPI_CIC_MAX_ORDER ||
+	    fullscale <= 0.0) {
+		return -1;
+	}
+	// input at 31 bits, plus order * log2(factor) bits of gain
+	growth = order * log2(factor);
+	if (31 + growth > 63) {
+		return -1;
+	}
+
+	d->type = RPI_DECIM_CIC;
+	d->factor = factor;
+	d->order = order;
+	d->scale = 1073741824.0 / fullscale;
+	d->gain = 1.0 / (d->scale * pow(factor, order));
+	return 0;
+}
+
+void rpi_decim_reset(rpi_decim_t* d) {
+	d->phase = 0;
+	if (d->type == RPI_DECIM_FIR) {
+		memset(d->hist[0], 0,
+		       3 * (d->taps - 1 + RPI_DECIM_BLOCK) * sizeof(float));
+	} else {
+		memset(d->integ, 0, sizeof d->integ);
+		memset(d->comb, 0, sizeof d->comb);
+	}
+}
+
+void rpi_decim_free(rpi_decim_t* d) {
+	free(d->coef);
+	d->coef = NULL;
+}
+
+static int fir_run(
+	rpi_decim_t* d,
+	const float* in[3], size_t n,
+	float* out[3]
+) {
+	int keep = d->taps - 1;
+	int a, k, m, o, start, count = 0;
+
+	while (n > 0) {
+		m = (n < RPI_DECIM_BLOCK)? (int)n: RPI_DECIM_BLOCK;
+		// first kept sample of this block
+		start = d->factor - 1 - d->phase;
+
+		// one axis at a time, its history stays in L1
+		for (a = 0; a < 3; a++) {
+			float* h = d->hist[a];
+
+			memcpy(h + keep, in[a], m * sizeof(float));
+			o = count;
+			for (k = start; k < m; k += d->factor) {
+				out[a][o++] = dot(h + k, d->coef, d->taps);
+			}
+			memmove(h, h + m, keep * sizeof(float));
+			in[a] += m;
+		}
+
+		count += (start < m)? (m - 1 - start) / d->factor + 1: 0;
+		d->phase = (d->phase + m) % d->factor;
+		n -= m;
+	}
+	return count;
+}
+
+static int cic_run(
+	rpi_decim_t* d,
+	const float* in[3], size_t n,
+	float* out[3]
+) {
+	uint64_t v[RPI_CIC_MAX_ORDER], c, t;
+	int a, s, o = 0, phase = d->phase;
+	size_t i;
+
+	for (a = 0; a < 3; a++) {
+		const float* x = in[a];
+
+		memcpy(v, d->integ[a], sizeof v);
+		phase = d->phase;
+		o = 0;
+		for (i = 0; i < n; i++) {
+			// wrapping adds, exact as long as the output fits
+			v[0] += (uint64_t)llrint(x[i] * d->scale);
+			for (s = 1; s < d->order; s++) {
+				v[s] += v[s - 1];
+			}
+			if (++phase < d->factor) {
+				continue;
+			}
+			phase = 0;
+
+			c = v[d->order - 1];
+			for (s = 0; s < d->order; s++) {
+				t = c;
+				c -= d->comb[a][s];
+				d->comb[a][s] = t;
+			}
+			out[a][o++] = (float)((int64_t)c * d->gain);
+		}
+		memcpy(d->integ[a], v, sizeof v);
+	}
+	d->phase = phase;
+	return o;
+}
+
+int rpi_decim_run(
+	rpi_decim_t* d,
+	const float* x, const float* y, const float* z, size_t n,
+	float* ox, float* oy, float* oz
+) {
+	const float* in[3] = { x, y, z };
+	float* out[3] = { ox, oy, oz };
+
+	if (d->type == RPI_DECIM_FIR) {
+		return fir_run(d, in, n, out);
+	}
+	return cic_run(d, in, n, out);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,115 @@
+/*
+ * Streaming decimation of 3-axis samples
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_DECIM_H__
+#define __RPI_DECIM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// rpi_decim_t.type
+#define RPI_DECIM_FIR		0
+#define RPI_DECIM_CIC		1
+
+// input samples filtered per pass, sizes the FIR history
+#define RPI_DECIM_BLOCK		256
+// longest FIR, padded to a multiple of 8
+#define RPI_DECIM_MAX_TAPS	512
+#define RPI_CIC_MAX_ORDER	6
+
+// output samples of rpi_decim_run() for n inputs, at most
+#define RPI_DECIM_OUT(d, n)	((n) / (d)->factor + 1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Decimator of one consumer, on the x/y/z arrays rpi_convert_s16x3()
+ * produces, so every consumer picks its own output rate from the
+ * same high rate stream.
+ *
+ * FIR: low-pass taps evaluated only at the kept samples (polyphase),
+ *      history kept per axis.
+ * CIC: order N integrators/combs in wrapping fixed point, no
+ *      multiplies per sample; passband droops as sinc^N.
+ */
+typedef struct {
+	int type;
+	int factor;
+	int phase;		// inputs since the last output
+
+	// FIR
+	int taps;
+	float* coef;		// reversed, zero padded in front
+	float* hist[3];		// taps - 1 old samples + RPI_DECIM_BLOCK
+
+	// CIC
+	int order;
+	double scale;		// input to fixed point
+	double gain;		// fixed point output to input units
+	uint64_t integ[3][RPI_CIC_MAX_ORDER];
+	uint64_t comb[3][RPI_CIC_MAX_ORDER];
+} rpi_decim_t;
+
+/*
+ * Windowed sinc low-pass, DC gain 1.
+ *   taps:   0 picks 8 * factor
+ *   cutoff: fraction of the output Nyquist frequency, 0 picks 0.8
+ * return 0: OK, -1: bad parameters or out of memory
+ */
+int rpi_decim_fir_init(rpi_decim_t* d, int factor, int taps, double cutoff);
+
+/*
+ * fullscale: largest magnitude of the input, in its units
+ *            (eg. 16000 mg, 2000 dps), sets the fixed point scale
+ * return 0: OK, -1: register growth would not fit in 64 bits
+ */
+int rpi_decim_cic_init(rpi_decim_t* d, int factor, int order, double fullscale);
+
+// back to the state right after init
+void rpi_decim_reset(rpi_decim_t* d);
+
+void rpi_decim_free(rpi_decim_t* d);
+
+/*
+ * Feed n samples per axis, any n, history carries across calls.
+ * ox/oy/oz: room for RPI_DECIM_OUT(d, n) samples each
+ * return the number of output samples written
+ */
+int rpi_decim_run(
+	rpi_decim_t* d,
+	const float* x, const float* y, const float* z, size_t n,
+	float* ox, float* oy, float* oz
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_DECIM_H__
@@ -0,0 +1,170 @@
+/*
+ * Emulated bus transport, in-memory register files
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "rpi_transport.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EMU_DEV_MAX	128
+#define EMU_REG_MAX	256
+
+typedef struct {
+	uint8_t regs[EMU_DEV_MAX][EMU_REG_MAX];
+	uint64_t clock_ns;
+	int fail;
+	void (*on_access)(rpi_transport_t* tr, uint8_t dev,
+	                  uint8_t reg, uint16_t len, int is_read, void* arg);
+	void* arg;
+} emu_priv_t;
+
+static int emu_fault(emu_priv_t* p) {
+	if (p->fail > 0) {
+		p->fail--;
+		return 1;
+	}
+	return 0;
+}
+
+// register address auto increments and wraps like real chips
+static int8_t emu_read(rpi_transport_t* tr, uint8_t dev,
+                       uint8_t reg, uint8_t* data, uint16_t len) {
+	emu_priv_t* p = tr->priv;
+	uint8_t* r = p->regs[dev % EMU_DEV_MAX];
+	uint16_t i;
+
+	if (emu_fault(p)) {
+		return RPI_TR_FAIL;
+	}
+	for (i = 0; i < len; i++) {
+		data[i] = r[(uint8_t)(reg + i)];
+	}
+	if (p->on_access != NULL) {
+		p->on_access(tr, dev, reg, len, 1, p->arg);
+	}
+	return RPI_TR_OK;
+}
+
+static int8_t emu_write(rpi_transport_t* tr, uint8_t dev,
+                        uint8_t reg, const uint8_t* data, uint16_t len) {
+	emu_priv_t* p = tr->priv;
+	uint8_t* r = p->regs[dev % EMU_DEV_MAX];
+	uint16_t i;
+
+	if (emu_fault(p)) {
+		return RPI_TR_FAIL;
+	}
+	for (i = 0; i < len; i++) {
+		r[(uint8_t)(reg + i)] = data[i];
+	}
+	if (p->on_access != NULL) {
+		p->on_access(tr, dev, reg, len, 0, p->arg);
+	}
+	return RPI_TR_OK;
+}
+
+// no real wait, the virtual clock moves on
+static void emu_delay_ms(rpi_transport_t* tr, uint32_t millis) {
+	emu_priv_t* p = tr->priv;
+
+	p->clock_ns += millis * 1000000ULL;
+}
+
+static uint64_t emu_timestamp(rpi_transport_t* tr) {
+	emu_priv_t* p = tr->priv;
+
+	return p->clock_ns;
+}
+
+static void emu_close(rpi_transport_t* tr) {
+	free(tr->priv);
+	free(tr);
+}
+
+rpi_transport_t* rpi_transport_emu(void) {
+	rpi_transport_t* tr;
+	emu_priv_t* p;
+
+	tr = calloc(1, sizeof *tr);
+	p = calloc(1, sizeof *p);
+	if (tr == NULL || p == NULL) {
+		free(tr);
+		free(p);
+		return NULL;
+	}
+
+	tr->kind      = RPI_TR_EMU;
+	tr->priv      = p;
+	tr->read      = emu_read;
+	tr->write     = emu_write;
+	tr->batch     = NULL;
+	tr->delay_ms  = emu_delay_ms;
+	tr->timestamp = emu_timestamp;
+	tr->close     = emu_close;
+	return tr;
+}
+
+uint8_t* rpi_transport_emu_regs(rpi_transport_t* tr, uint8_t dev) {
+	emu_priv_t* p = tr->priv;
+
+	if (tr->kind != RPI_TR_EMU) {
+		return NULL;
+	}
+	return p->regs[dev % EMU_DEV_MAX];
+}
+
+void rpi_transport_emu_hook(
+	rpi_transport_t* tr,
+	void (*on_access)(rpi_transport_t* tr, uint8_t dev,
+	                  uint8_t reg, uint16_t len, int is_read, void* arg),
+	void* arg
+) {
+	emu_priv_t* p = tr->priv;
+
+	if (tr->kind != RPI_TR_EMU) {
+		return;
+	}
+	p->on_access = on_access;
+	p->arg = arg;
+}
+
+void rpi_transport_emu_fail(rpi_transport_t* tr, int count) {
+	emu_priv_t* p = tr->priv;
+
+	if (tr->kind != RPI_TR_EMU) {
+		return;
+	}
+	p->fail = count;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,109 @@
+/*
+ * GPIO edge events through the character device
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#define _DEBUG	0
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/gpio.h>
+#include "rpi_gpio.h"
+#include "rpi_transport.h"
+#include "rpi_trace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int rpi_gpio_event_open(const char* chip, unsigned line, int edge) {
+	struct gpioevent_request req;
+	int fd, rt;
+
+	if ((fd = open(chip, O_RDONLY | O_CLOEXEC)) < 0) {
+		#if _DEBUG
+		printf("open %s error %d\n", chip, errno);
+		#endif
+		return RPI_GPIO_FAIL;
+	}
+
+	memset(&req, 0, sizeof req);
+	req.lineoffset = line;
+	req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+	req.eventflags = ((edge & RPI_GPIO_RISING)? GPIOEVENT_REQUEST_RISING_EDGE: 0)
+	               | ((edge & RPI_GPIO_FALLING)? GPIOEVENT_REQUEST_FALLING_EDGE: 0);
+	strncpy(req.consumer_label, "rpi_imu", sizeof req.consumer_label - 1);
+
+	rt = ioctl(fd, GPIO_GET_LINEEVENT_IOCTL, &req);
+	// the line stays requested through the event fd
+	close(fd);
+	if (rt < 0) {
+		#if _DEBUG
+		printf("line %u event request error %d\n", line, errno);
+		#endif
+		return RPI_GPIO_FAIL;
+	}
+	return req.fd;
+}
+
+int rpi_gpio_event_close(int fd) {
+	return close(fd) < 0? RPI_GPIO_FAIL: RPI_GPIO_OK;
+}
+
+int rpi_gpio_event_wait(int fd, int timeout_ms, uint64_t* ts) {
+	struct gpioevent_data ev;
+	struct pollfd pfd;
+	int rt;
+
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	do {
+		rt = poll(&pfd, 1, timeout_ms);
+	} while (rt < 0 && errno == EINTR);
+	if (rt <= 0) {
+		return rt < 0? RPI_GPIO_FAIL: 0;
+	}
+
+	if (read(fd, &ev, sizeof ev) != sizeof ev) {
+		return RPI_GPIO_FAIL;
+	}
+	// edge to this thread running
+	RPI_TRACE_SPAN(RPI_TRACE_WAKE, ev.timestamp, rpi_time_ns());
+	if (ts != NULL) {
+		// CLOCK_MONOTONIC since Linux 5.7, CLOCK_REALTIME before
+		*ts = ev.timestamp;
+	}
+	return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,67 @@
+/*
+ * GPIO edge events through the character device
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __gpio_rpi_h__
+#define __gpio_rpi_h__
+
+#include <stdint.h>
+
+#define RPI_GPIO_OK		0
+#define RPI_GPIO_FAIL		-1
+
+// edge of rpi_gpio_event_open()
+#define RPI_GPIO_RISING		0x01
+#define RPI_GPIO_FALLING	0x02
+#define RPI_GPIO_BOTH		0x03
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// return >=0: event fd, pollable, for rpi_gpio_event_wait()
+//         <0: error
+int rpi_gpio_event_open(
+	/* eg. /dev/gpiochip0 */
+	const char* chip,
+	/* BCM number on the Raspberry Pi header */
+	unsigned line,
+	/* RPI_GPIO_RISING/FALLING/BOTH */
+	int edge
+);
+int rpi_gpio_event_close(int fd);
+
+// Sleep until an edge or timeout_ms (-1: forever),
+// ts: kernel timestamp of the edge in ns, may be NULL.
+// return 1: edge, 0: timeout, <0: error
+int rpi_gpio_event_wait(int fd, int timeout_ms, uint64_t* ts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__gpio_rpi_h__
@@ -0,0 +1,167 @@
+/*
+ * Sensor health monitor
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <string.h>
+#include "rpi_health.h"
+#include "rpi_shadow.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NS_PER_MS	1000000ULL
+
+void rpi_health_init(rpi_health_t* h) {
+	memset(h, 0, sizeof *h);
+	h->frozen = 64;
+	h->sat = 32767;
+	h->window = 1000;
+	h->ovf_max = 0;
+	h->stall = 8;
+}
+
+// bit 0: frozen, bit 1: saturated
+static inline uint32_t health_axis(rpi_health_t* h, int k, int16_t v) {
+	uint16_t eq = (v == h->last[k]);
+
+	h->same[k] += eq & (h->same[k] < 0xFFFF);
+	h->same[k] *= eq;
+	h->last[k] = v;
+	return (h->same[k] >= h->frozen) | ((v >= h->sat) | (v <= -h->sat)) << 1;
+}
+
+static inline void health_set(rpi_health_t* h, uint32_t flag, int on) {
+	h->flags = (h->flags & ~flag) | (on? flag: 0);
+}
+
+void rpi_health_sample(rpi_health_t* h, const rpi_sample_t* s) {
+	const int16_t* v[3] = { s->acc, s->gyr, s->mag };
+	uint32_t r = 0;
+	int g, k;
+
+	for (g = 0; g < 3; g++) {
+		if (!(s->flags & (RPI_SAMPLE_ACC << g))) {
+			continue;
+		}
+		r |= health_axis(h, g * 3 + 0, v[g][0]);
+		r |= health_axis(h, g * 3 + 1, v[g][1]);
+		r |= health_axis(h, g * 3 + 2, v[g][2]);
+	}
+	h->sat_n += r >> 1;
+
+	// any axis, also of a sensor not in this sample
+	for (k = 0, r = 0; k < 9; k++) {
+		r |= (h->same[k] >= h->frozen);
+	}
+	health_set(h, RPI_HEALTH_FROZEN, r);
+
+	if (++h->n < h->window) {
+		return;
+	}
+	health_set(h, RPI_HEALTH_SATURATED, h->sat_n > 0);
+	health_set(h, RPI_HEALTH_OVERFLOW, h->ovf_n > h->ovf_max);
+	health_set(h, RPI_HEALTH_COM, h->com_n > 0);
+	h->n = h->sat_n = h->ovf_n = h->com_n = 0;
+}
+
+void rpi_health_block(rpi_health_t* h, const rpi_block_t* b) {
+	rpi_sample_t s;
+	int i;
+
+	for (i = 0; i < b->count; i++) {
+		rpi_block_sample(b, i, &s);
+		rpi_health_sample(h, &s);
+	}
+}
+
+void rpi_health_time(rpi_health_t* h, uint32_t sensor_time) {
+	if (sensor_time == h->time_last) {
+		h->time_same += (h->time_same < 0xFFFF);
+	} else {
+		h->time_same = 0;
+	}
+	h->time_last = sensor_time;
+	health_set(h, RPI_HEALTH_STALLED, h->time_same >= h->stall);
+}
+
+void rpi_health_status(rpi_health_t* h, int status) {
+	h->ovf_n += !!(status & RPI_STATUS_OVERFLOW);
+	h->com_n += !!(status & (RPI_STATUS_COM_FAIL | RPI_STATUS_RESET |
+	                         RPI_STATUS_LOST));
+}
+
+void rpi_health_selftest(
+	rpi_health_t* h,
+	rpi_startup_t* job,
+	uint32_t period_ms,
+	uint32_t run_ms
+) {
+	h->test = job;
+	h->test_period = period_ms * NS_PER_MS;
+	h->test_ms = run_ms;
+	h->test_due = rpi_tr_timestamp(job->tr) + h->test_period;
+}
+
+int rpi_health_gap(rpi_health_t* h, uint32_t gap_ms) {
+	rpi_startup_t* job = h->test;
+
+	if (job == NULL || (h->flags & RPI_HEALTH_TESTING) ||
+	    gap_ms < h->test_ms || rpi_tr_timestamp(job->tr) < h->test_due) {
+		return 0;
+	}
+	// from the first step again
+	job->state = 0;
+	job->rt = 0;
+	job->due = 0;
+	h->flags |= RPI_HEALTH_TESTING;
+	rpi_health_poll(h);
+	return 1;
+}
+
+int rpi_health_poll(rpi_health_t* h) {
+	rpi_startup_t* job = h->test;
+
+	if (!(h->flags & RPI_HEALTH_TESTING)) {
+		return 0;
+	}
+	if (rpi_startup_poll(job)) {
+		return 1;
+	}
+	h->flags &= ~RPI_HEALTH_TESTING;
+	health_set(h, RPI_HEALTH_SELFTEST, job->rt != 0);
+	h->test_due = rpi_tr_timestamp(job->tr) + h->test_period;
+	return 0;
+}
+
+uint32_t rpi_health_get(const rpi_health_t* h) {
+	return h->flags;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,120 @@
+/*
+ * Sensor health monitor
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_HEALTH_H__
+#define __RPI_HEALTH_H__
+
+#include <stdint.h>
+#include "rpi_sample.h"
+#include "rpi_block.h"
+#include "rpi_startup.h"
+
+// rpi_health_get(), what is wrong now
+#define RPI_HEALTH_FROZEN	0x01	// an axis repeats the same raw value
+#define RPI_HEALTH_STALLED	0x02	// sensor time does not advance
+#define RPI_HEALTH_SATURATED	0x04	// full scale reached in the window
+#define RPI_HEALTH_OVERFLOW	0x08	// data overruns above the limit
+#define RPI_HEALTH_COM		0x10	// bus errors, resets in the window
+#define RPI_HEALTH_SELFTEST	0x20	// the last self-test failed
+#define RPI_HEALTH_TESTING	0x40	// a self-test is running
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Cheap checks on the sample stream of one device, no bus access
+ * of its own; self-tests only start in a gap the caller announces
+ * and run as rpi_startup_t jobs, polled without waiting.
+ */
+typedef struct {
+	// limits
+	uint16_t frozen;	// same value this many samples in a row
+	int16_t sat;		// |raw| at or above is saturated
+	uint32_t window;	// samples per rate window
+	uint16_t ovf_max;	// overflows per window allowed
+	uint16_t stall;		// sensor time reads without progress
+	// state
+	int16_t last[9];	// acc, gyr, mag
+	uint16_t same[9];
+	uint32_t n;
+	uint32_t sat_n;
+	uint32_t ovf_n;
+	uint32_t com_n;
+	uint32_t time_last;
+	uint16_t time_same;
+	uint32_t flags;
+	// self-test
+	rpi_startup_t* test;
+	uint64_t test_period;	// ns
+	uint32_t test_ms;	// longest run, ms
+	uint64_t test_due;
+} rpi_health_t;
+
+// defaults: frozen 64, sat 32767, window 1000, ovf_max 0, stall 8
+void rpi_health_init(rpi_health_t* h);
+
+// one sample, or a block of them
+void rpi_health_sample(rpi_health_t* h, const rpi_sample_t* s);
+void rpi_health_block(rpi_health_t* h, const rpi_block_t* b);
+
+// a reading of a free running sensor time counter
+void rpi_health_time(rpi_health_t* h, uint32_t sensor_time);
+
+// RPI_STATUS_* of the driver, from rpi_*_status()
+void rpi_health_status(rpi_health_t* h, int status);
+
+/*
+ * Self-test every period_ms, job filled by rpi_*_selftest() and
+ * restarted from its first step each time, run_ms: its duration.
+ */
+void rpi_health_selftest(
+	rpi_health_t* h,
+	rpi_startup_t* job,
+	uint32_t period_ms,
+	uint32_t run_ms
+);
+
+/*
+ * The caller will not need the device for gap_ms, a due self-test
+ * starts when it fits; then rpi_health_poll() from the loop.
+ * return 1: started
+ */
+int rpi_health_gap(rpi_health_t* h, uint32_t gap_ms);
+
+// advance a running self-test, return 1: still running
+int rpi_health_poll(rpi_health_t* h);
+
+// RPI_HEALTH_*
+uint32_t rpi_health_get(const rpi_health_t* h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_HEALTH_H__
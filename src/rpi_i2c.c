@@ -35,6 +35,7 @@
 #include <unistd.h>
 #include <linux/i2c-dev.h>
 #include "rpi_i2c.h"
+#include "rpi_trace.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -62,10 +63,10 @@ int rpi_i2c_init(const char* dev_path) {
 // return none-zero = FAIL
 //        zero      = OK
 int8_t rpi_i2c_write(uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, uint16_t len) {
-	uint8_t* buf = (uint8_t*)malloc(len + 1);
+	uint8_t buf[1 + RPI_I2C_WRITE_MAX];
 	int rt;
 
-	if (buf == NULL || rpi_i2c_fd < 0) {
+	if (len > RPI_I2C_WRITE_MAX || rpi_i2c_fd < 0) {
 		return RPI_I2C_FAIL;
 	}
 
@@ -84,8 +85,6 @@ int8_t rpi_i2c_write(uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, uint16_t
 	} else {
 		rt = RPI_I2C_OK;
 	}
-
-	free(buf);
 	return rt;
 }
 
@@ -109,16 +108,20 @@ int8_t rpi_i2c_read(uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, uint16_t
 	 */
 	#endif
 
+	RPI_TRACE_BEGIN(RPI_TRACE_XFER);
 	if ((rt = write(rpi_i2c_fd, &reg_addr, 1)) != 1) {
+		RPI_TRACE_END(RPI_TRACE_XFER);
 		printf("Failed to write (then read) i2c reg = 0x%02X, error = %d.\n",
 		       reg_addr, rt);
 		return RPI_I2C_FAIL;
 	}
 
 	if ((rt = read(rpi_i2c_fd, data, len)) != len) {
+		RPI_TRACE_END(RPI_TRACE_XFER);
 		printf("Failed to read from i2c bus with error = %d.\n", rt);
 		return RPI_I2C_FAIL;
 	}
+	RPI_TRACE_END(RPI_TRACE_XFER);
 	return RPI_I2C_OK;
 }
 
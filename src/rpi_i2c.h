@@ -34,6 +34,9 @@
 #define RPI_I2C_OK	0
 #define RPI_I2C_FAIL	-1
 
+// payload of one rpi_i2c_write()
+#define RPI_I2C_WRITE_MAX	256
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -27,9 +27,14 @@
  * THE SOFTWARE.
  */
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include "rpi_icm20600.h"
 #include "rpi_i2c.h"
+#include "rpi_transport.h"
+#include "rpi_shadow.h"
+#include "rpi_gpio.h"
+#include "rpi_trace.h"
 
 /***************************************************************
  ICM20600 I2C Register
@@ -105,17 +110,111 @@
 #define ICM20600_RESET_BIT              (1 << 0)
 #define ICM20600_DEVICE_RESET_BIT       (1 << 7)
 
+#define ICM20600_CHIP_ID                0x11
+
+// INT_ENABLE, INT_STATUS
+#define ICM20600_INT_WOM                0xE0
+#define ICM20600_INT_DATA_RDY           0x01
+// ACCEL_INTEL_CTRL: enabled, compare with the previous sample
+#define ICM20600_INTEL_EN               0xC0
+// ACCEL_WOM_*_THR
+#define ICM20600_WOM_MG_PER_LSB         4
+
 #define RAW_MAX                         0x8000
 
-int icm20600_set_power_mode(rpi_icm20600_t* dev, icm20600_power_type_t mode) {
-	uint8_t pwr1, pwr2 = 0x00;
-	uint8_t gyro_lp;
+// configuration registers in address order, so the shadow
+// flushes them as a few bursts
+static const uint8_t icm_defaults[][2] = {
+	{ ICM20600_SMPLRT_DIV,       0x00 },
+	{ ICM20600_CONFIG,           0x00 },
+	{ ICM20600_GYRO_CONFIG,      0x00 },
+	{ ICM20600_ACCEL_CONFIG,     0x00 },
+	{ ICM20600_ACCEL_CONFIG2,    0x00 },
+	{ ICM20600_GYRO_LP_MODE_CFG, 0x00 },
+	{ ICM20600_ACCEL_WOM_X_THR,  0x00 },
+	{ ICM20600_ACCEL_WOM_Y_THR,  0x00 },
+	{ ICM20600_ACCEL_WOM_Z_THR,  0x00 },
+	{ ICM20600_FIFO_EN,          0x00 },
+	{ ICM20600_INT_PIN_CFG,      0x00 },
+	{ ICM20600_INT_ENABLE,       0x00 },
+	{ ICM20600_ACCEL_INTEL_CTRL, 0x00 },
+	{ ICM20600_USER_CTRL,        0x00 },
+	{ ICM20600_PWR_MGMT_1,       0x41 },
+	{ ICM20600_PWR_MGMT_2,       0x00 },
+};
+
+static inline int icm_read_byte(rpi_icm20600_t* dev, uint8_t reg) {
+	return rpi_tr_read_byte(dev->tr, dev->addr, reg);
+}
+
+static inline int icm_read_word(rpi_icm20600_t* dev, uint8_t reg) {
+	return rpi_tr_read_word(dev->tr, dev->addr, reg);
+}
+
+static inline int icm_write_byte(rpi_icm20600_t* dev, uint8_t reg, uint8_t data) {
+	return rpi_tr_write_byte(dev->tr, dev->addr, reg, data);
+}
+
+// configuration bits go to the shadow first, no read-modify-write
+static inline void icm_stage(rpi_icm20600_t* dev, uint8_t reg, uint8_t mask, uint8_t bits) {
+	rpi_shadow_bits(&dev->shadow, reg, mask, bits);
+}
+
+// staged configuration to the chip, in one burst
+static inline int icm_flush(rpi_icm20600_t* dev) {
+	return rpi_shadow_flush(&dev->shadow, dev->tr, dev->addr);
+}
+
+static void icm_recover(rpi_icm20600_t* dev) {
+	// PWR_MGMT_1 resets to 0x41(sleep), differs from any working mode
+	dev->status |= rpi_shadow_recover(&dev->shadow, dev->tr, dev->addr,
+		ICM20600_WHO_AM_I, ICM20600_CHIP_ID, ICM20600_PWR_MGMT_1);
+}
+
+// before a data read, every RPI_CHECK_PERIOD samples
+static void icm_check(rpi_icm20600_t* dev) {
+	if (++dev->reads < RPI_CHECK_PERIOD) {
+		return;
+	}
+	dev->reads = 0;
+	if (rpi_shadow_check(&dev->shadow, dev->tr, dev->addr,
+	                     ICM20600_PWR_MGMT_1)) {
+		icm_recover(dev);
+	}
+}
 
-	pwr1 = i2c_read_byte(dev->addr, ICM20600_PWR_MGMT_1) & 0x8F;
+static int icm_read_regs(rpi_icm20600_t* dev, uint8_t reg, uint8_t* buf, int len) {
+	icm_check(dev);
+	if (rpi_tr_read(dev->tr, dev->addr, reg, buf, len)) {
+		dev->status |= RPI_STATUS_COM_FAIL;
+		icm_recover(dev);
+		return RPI_TR_FAIL;
+	}
+	return RPI_TR_OK;
+}
+
+/* Datasheet coefficients */
+static inline double icm_temp_c(int16_t raw) {
+	return raw / 326.8 + 25.0;
+}
+
+static inline void icm_temp_cache(rpi_icm20600_t* dev, const uint8_t* buf) {
+	dev->temp_raw = (int16_t)(buf[0] << 8 | buf[1]);
+	dev->temp_ts = rpi_tr_timestamp(dev->tr);
+}
+
+// 3 big endian words
+static inline void icm_xyz(const uint8_t* buf, int16_t v[3]) {
+	v[0] = (int16_t)(buf[0] << 8 | buf[1]);
+	v[1] = (int16_t)(buf[2] << 8 | buf[3]);
+	v[2] = (int16_t)(buf[4] << 8 | buf[5]);
+}
 
+static void icm_stage_power_mode(rpi_icm20600_t* dev, icm20600_power_type_t mode) {
+	uint8_t pwr1 = 0x00, pwr2 = 0x00;
 	// When set to ‘1’ low-power gyroscope mode is enabled.
 	// Default setting is 0
-	gyro_lp = i2c_read_byte(dev->addr, ICM20600_GYRO_LP_MODE_CFG) & 0x7F;
+	uint8_t gyro_lp = 0x00;
 
 	switch(mode) {
 	case ICM_SLEEP_MODE:
@@ -158,17 +257,14 @@ int icm20600_set_power_mode(rpi_icm20600_t* dev, icm20600_power_type_t mode) {
 		pwr1 |= 0x00;  
 		break;
 	}
-	i2c_write_byte(dev->addr, ICM20600_PWR_MGMT_1, pwr1);
-	i2c_write_byte(dev->addr, ICM20600_PWR_MGMT_2, pwr2);
-	i2c_write_byte(dev->addr, ICM20600_GYRO_LP_MODE_CFG, gyro_lp);
-	return 0;
+	icm_stage(dev, ICM20600_PWR_MGMT_1, 0x70, pwr1);
+	icm_stage(dev, ICM20600_PWR_MGMT_2, 0xFF, pwr2);
+	icm_stage(dev, ICM20600_GYRO_LP_MODE_CFG, 0x80, gyro_lp);
 }
 
-int icm20600_set_gyro_range(rpi_icm20600_t* dev, gyro_scale_type_t range) {
+static void icm_stage_gyro_range(rpi_icm20600_t* dev, gyro_scale_type_t range) {
 	uint8_t data = 0;
 
-	data = i2c_read_byte(dev->addr, ICM20600_GYRO_CONFIG) & 0xE7;
-
 	switch(range){
 	case RANGE_250_DPS:
 		data |= 0x00;   // 0bxxx00xxx
@@ -191,16 +287,13 @@ int icm20600_set_gyro_range(rpi_icm20600_t* dev, gyro_scale_type_t range) {
 		dev->gyro_scale = 2000.0;
 		break;
 	}
-	i2c_write_byte(dev->addr, ICM20600_GYRO_CONFIG, data);
-	return 0;
+	icm_stage(dev, ICM20600_GYRO_CONFIG, 0x18, data);
 }
 
-int icm20600_set_gyro_rate(rpi_icm20600_t* dev, gyro_lownoise_odr_type_t odr) {
-	uint8_t data;
-
-	// DLPF_CFG[2:0] 0b11111000
-	data = i2c_read_byte(dev->addr, ICM20600_CONFIG) & 0xF8;
+static void icm_stage_gyro_rate(rpi_icm20600_t* dev, gyro_lownoise_odr_type_t odr) {
+	uint8_t data = 0;
 
+	// DLPF_CFG[2:0] 0b00000111
 	switch(odr) {
 	case GYRO_RATE_8K_BW_3281: data |= 0x07; break;
 	case GYRO_RATE_8K_BW_250:  data |= 0x00; break;
@@ -212,15 +305,12 @@ int icm20600_set_gyro_rate(rpi_icm20600_t* dev, gyro_lownoise_odr_type_t odr) {
 	default:
 	case GYRO_RATE_1K_BW_5:    data |= 0x06; break;
 	}
-	i2c_write_byte(dev->addr, ICM20600_CONFIG, data);
-	return 0;
+	icm_stage(dev, ICM20600_CONFIG, 0x07, data);
 }
 
-int icm20600_set_gyro_aver(rpi_icm20600_t* dev, gyro_averaging_sample_type_t sample) {
+static void icm_stage_gyro_aver(rpi_icm20600_t* dev, gyro_averaging_sample_type_t sample) {
 	uint8_t data = 0;
 
-	data = i2c_read_byte(dev->addr, ICM20600_GYRO_LP_MODE_CFG) & 0x8F;
-
 	switch(sample){
 	case GYRO_AVERAGE_1:  data |= 0x00; break;
 	case GYRO_AVERAGE_2:  data |= 0x10; break;
@@ -232,14 +322,11 @@ int icm20600_set_gyro_aver(rpi_icm20600_t* dev, gyro_averaging_sample_type_t sam
 	default:
 	case GYRO_AVERAGE_128:data |= 0x70; break;
 	}
-	i2c_write_byte(dev->addr, ICM20600_GYRO_LP_MODE_CFG, data);
-	return 0;
+	icm_stage(dev, ICM20600_GYRO_LP_MODE_CFG, 0x70, data);
 }
 
-int icm20600_set_acc_range(rpi_icm20600_t* dev, acc_scale_type_t range) {
-	uint8_t data;
-
-	data = i2c_read_byte(dev->addr, ICM20600_ACCEL_CONFIG) & 0xE7;
+static void icm_stage_acc_range(rpi_icm20600_t* dev, acc_scale_type_t range) {
+	uint8_t data = 0;
 
 	switch(range) {
 	case RANGE_2G:
@@ -263,14 +350,11 @@ int icm20600_set_acc_range(rpi_icm20600_t* dev, acc_scale_type_t range) {
 		dev->acc_scale = 16000.0;
 		break;
 	}
-	i2c_write_byte(dev->addr, ICM20600_ACCEL_CONFIG, data);
-	return 0;
+	icm_stage(dev, ICM20600_ACCEL_CONFIG, 0x18, data);
 }
 
-int icm20600_set_acc_rate(rpi_icm20600_t* dev, acc_lownoise_odr_type_t odr) {
-	uint8_t data;
-
-	data = i2c_read_byte(dev->addr, ICM20600_ACCEL_CONFIG2) & 0xF0;
+static void icm_stage_acc_rate(rpi_icm20600_t* dev, acc_lownoise_odr_type_t odr) {
+	uint8_t data = 0;
 
 	switch (odr) {
 	case ACC_RATE_4K_BW_1046: data |= 0x08; break;
@@ -283,14 +367,12 @@ int icm20600_set_acc_rate(rpi_icm20600_t* dev, acc_lownoise_odr_type_t odr) {
 	default:
 	case ACC_RATE_1K_BW_5:    data |= 0x06; break;
 	}
-	i2c_write_byte(dev->addr, ICM20600_ACCEL_CONFIG2, data);
+	icm_stage(dev, ICM20600_ACCEL_CONFIG2, 0x0F, data);
 }
 
-int icm20600_set_acc_aver(rpi_icm20600_t* dev, acc_averaging_sample_type_t sample) {
+static void icm_stage_acc_aver(rpi_icm20600_t* dev, acc_averaging_sample_type_t sample) {
 	uint8_t data = 0;
 
-	data = i2c_read_byte(dev->addr, ICM20600_ACCEL_CONFIG2) & 0xCF;
-
 	switch(sample) {
 	case ACC_AVERAGE_4:  data |= 0x00; break;
 	case ACC_AVERAGE_8:  data |= 0x10; break;
@@ -298,10 +380,452 @@ int icm20600_set_acc_aver(rpi_icm20600_t* dev, acc_averaging_sample_type_t sampl
 	default:
 	case ACC_AVERAGE_32: data |= 0x30; break;		
 	}
-	i2c_write_byte(dev->addr, ICM20600_ACCEL_CONFIG2, data);
+	icm_stage(dev, ICM20600_ACCEL_CONFIG2, 0x30, data);
+}
+
+int icm20600_set_power_mode(rpi_icm20600_t* dev, icm20600_power_type_t mode) {
+	int rt;
+
+	icm_stage_power_mode(dev, mode);
+	if ((rt = icm_flush(dev)) == 0) {
+		dev->conf.power = dev->want.power = mode;
+	}
+	return rt;
+}
+
+int icm20600_set_gyro_range(rpi_icm20600_t* dev, gyro_scale_type_t range) {
+	int rt;
+
+	icm_stage_gyro_range(dev, range);
+	if ((rt = icm_flush(dev)) == 0) {
+		dev->conf.gyro_range = dev->want.gyro_range = range;
+	}
+	return rt;
+}
+
+int icm20600_set_gyro_rate(rpi_icm20600_t* dev, gyro_lownoise_odr_type_t odr) {
+	int rt;
+
+	icm_stage_gyro_rate(dev, odr);
+	if ((rt = icm_flush(dev)) == 0) {
+		dev->conf.gyro_rate = dev->want.gyro_rate = odr;
+	}
+	return rt;
+}
+
+int icm20600_set_gyro_aver(rpi_icm20600_t* dev, gyro_averaging_sample_type_t sample) {
+	int rt;
+
+	icm_stage_gyro_aver(dev, sample);
+	if ((rt = icm_flush(dev)) == 0) {
+		dev->conf.gyro_aver = dev->want.gyro_aver = sample;
+	}
+	return rt;
+}
+
+int icm20600_set_acc_range(rpi_icm20600_t* dev, acc_scale_type_t range) {
+	int rt;
+
+	icm_stage_acc_range(dev, range);
+	if ((rt = icm_flush(dev)) == 0) {
+		dev->conf.acc_range = dev->want.acc_range = range;
+	}
+	return rt;
+}
+
+int icm20600_set_acc_rate(rpi_icm20600_t* dev, acc_lownoise_odr_type_t odr) {
+	int rt;
+
+	icm_stage_acc_rate(dev, odr);
+	if ((rt = icm_flush(dev)) == 0) {
+		dev->conf.acc_rate = dev->want.acc_rate = odr;
+	}
+	return rt;
+}
+
+int icm20600_set_acc_aver(rpi_icm20600_t* dev, acc_averaging_sample_type_t sample) {
+	int rt;
+
+	icm_stage_acc_aver(dev, sample);
+	if ((rt = icm_flush(dev)) == 0) {
+		dev->conf.acc_aver = dev->want.acc_aver = sample;
+	}
+	return rt;
+}
+
+static int icm_apply(rpi_icm20600_t* dev, const icm20600_cfg_t* conf) {
+	int rt;
+
+	// set default power mode
+	icm_stage_power_mode(dev, conf->power);
+
+	// gyro config
+	icm_stage_gyro_range(dev, conf->gyro_range);
+	icm_stage_gyro_rate(dev,  conf->gyro_rate);
+	// for low power mode only
+	icm_stage_gyro_aver(dev,  conf->gyro_aver);
+
+	// accel config
+	icm_stage_acc_range(dev,  conf->acc_range);
+	icm_stage_acc_rate(dev,   conf->acc_rate);
+	// for low power mode only
+	icm_stage_acc_aver(dev,   conf->acc_aver);
+
+	// SAMPLE_RATE = 1KHz / (1 + divider)
+	// work for low-power gyroscope
+	//          low-power accelerometer
+	//          low-noise accelerometer
+	icm_stage(dev, ICM20600_SMPLRT_DIV, 0xFF, conf->divider);
+
+	if ((rt = icm_flush(dev)) == 0) {
+		dev->conf = *conf;
+	}
+	return rt;
+}
+
+int rpi_icm20600_configure(
+	rpi_icm20600_t* dev,
+	const icm20600_cfg_t* conf
+) {
+	int rt;
+
+	if ((rt = icm_apply(dev, conf)) == 0) {
+		dev->want = *conf;
+		dev->conf_seq = dev->want_seq;
+	}
+	return rt;
+}
+
+/*
+ * Output periods of conf as the chip runs them: 8kHz gyro and 4kHz
+ * accel without their DLPF, everything else 1kHz / (1 + divider).
+ * 0: sensor off; return <0: power mode without output
+ */
+static int icm_periods(const icm20600_cfg_t* conf, uint64_t* acc_ns, uint64_t* gyro_ns) {
+	uint64_t base = 1000000ULL * (1 + conf->divider);
+
+	*acc_ns = *gyro_ns = 0;
+	switch (conf->power) {
+	case ICM_ACC_LOW_POWER:
+	case ICM_ACC_LOW_NOISE:
+		*acc_ns = base;
+		break;
+	case ICM_GYRO_LOW_POWER:
+	case ICM_GYRO_LOW_NOISE:
+		*gyro_ns = base;
+		break;
+	case ICM_6AXIS_LOW_POWER:
+	case ICM_6AXIS_LOW_NOISE:
+		*acc_ns = *gyro_ns = base;
+		break;
+	default:
+		return -1;
+	}
+	if (conf->power == ICM_ACC_LOW_NOISE || conf->power == ICM_6AXIS_LOW_NOISE) {
+		*acc_ns = (conf->acc_rate == ACC_RATE_4K_BW_1046)? 250000: *acc_ns;
+	}
+	if (conf->power == ICM_GYRO_LOW_NOISE || conf->power == ICM_6AXIS_LOW_NOISE) {
+		*gyro_ns = (conf->gyro_rate <= GYRO_RATE_8K_BW_250)? 125000: *gyro_ns;
+	}
 	return 0;
 }
 
+// in 6 axis modes the faster sensor sets the pace, 0: no such mode
+static uint64_t icm_sample_ns(const icm20600_cfg_t* conf) {
+	uint64_t acc_ns, gyro_ns;
+
+	if (icm_periods(conf, &acc_ns, &gyro_ns) < 0) {
+		return 0;
+	}
+	return (acc_ns && (!gyro_ns || acc_ns < gyro_ns))? acc_ns: gyro_ns;
+}
+
+void rpi_icm20600_reconfigure(rpi_icm20600_t* dev, const icm20600_cfg_t* conf) {
+	uint32_t seq = dev->want_seq;
+
+	// seqlock of one writer, the sampling thread takes want at even only
+	__atomic_store_n(&dev->want_seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	dev->want = *conf;
+	__atomic_store_n(&dev->want_seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void rpi_icm20600_get_config(rpi_icm20600_t* dev, icm20600_cfg_t* conf) {
+	*conf = dev->want;
+}
+
+/*
+ * A queued configuration to the chip, on the sampling thread before
+ * its next read. A bus error leaves it queued, for the next read.
+ */
+static void icm_reconf(rpi_icm20600_t* dev) {
+	uint32_t seq = __atomic_load_n(&dev->want_seq, __ATOMIC_ACQUIRE);
+	icm20600_cfg_t want, was;
+	uint64_t ns[4], slow = 0;
+	uint8_t changed = 0;
+	int i;
+
+	if (seq == dev->conf_seq || (seq & 1)) {
+		return;
+	}
+	want = dev->want;
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if (__atomic_load_n(&dev->want_seq, __ATOMIC_RELAXED) != seq) {
+		return;
+	}
+	was = dev->conf;
+	if (icm_apply(dev, &want) < 0) {
+		return;
+	}
+	dev->conf_seq = seq;
+
+	if (want.power != was.power || want.divider != was.divider) {
+		changed = RPI_SAMPLE_ACC | RPI_SAMPLE_GYR;
+	}
+	if (want.acc_range != was.acc_range || want.acc_rate != was.acc_rate ||
+	    want.acc_aver != was.acc_aver) {
+		changed |= RPI_SAMPLE_ACC;
+	}
+	if (want.gyro_range != was.gyro_range || want.gyro_rate != was.gyro_rate ||
+	    want.gyro_aver != was.gyro_aver) {
+		changed |= RPI_SAMPLE_GYR;
+	}
+	// the sample after says it is taken, the ranges may be the same
+	dev->mark = 1;
+	if (changed == 0) {
+		return;
+	}
+
+	// filters settle within two periods of the slower rate
+	icm_periods(&was, &ns[0], &ns[1]);
+	icm_periods(&want, &ns[2], &ns[3]);
+	for (i = 0; i < 4; i++) {
+		slow = ns[i] > slow? ns[i]: slow;
+	}
+	dev->settle = changed;
+	dev->settle_ts = rpi_tr_timestamp(dev->tr) + 2 * slow;
+
+	if (dev->fifo) {
+		// entries queued so far are of the old ranges
+		icm_write_byte(dev, ICM20600_USER_CTRL,
+			ICM20600_FIFO_EN_BIT | ICM20600_FIFO_RST_BIT);
+	}
+}
+
+int rpi_icm20600_autorange(rpi_icm20600_t* dev, rpi_autorange_t ar[2], const rpi_sample_t* s) {
+	icm20600_cfg_t conf;
+	int acc, gyro;
+
+	rpi_icm20600_get_config(dev, &conf);
+	if (s->flags & RPI_SAMPLE_RANGE) {
+		rpi_autorange_landed(&ar[0], conf.acc_range);
+		rpi_autorange_landed(&ar[1], conf.gyro_range);
+	}
+	acc = (s->flags & RPI_SAMPLE_ACC)? rpi_autorange_update(&ar[0], s->acc): ar[0].level;
+	gyro = (s->flags & RPI_SAMPLE_GYR)? rpi_autorange_update(&ar[1], s->gyr): ar[1].level;
+
+	if (acc == conf.acc_range && gyro == conf.gyro_range) {
+		return 0;
+	}
+	conf.acc_range = acc;
+	conf.gyro_range = gyro;
+	rpi_icm20600_reconfigure(dev, &conf);
+	return 1;
+}
+
+// sensor of flag still settling at ts after a reconfigure
+static inline int icm_settling(rpi_icm20600_t* dev, uint64_t ts, uint16_t flag) {
+	return (dev->settle & flag) && ts < dev->settle_ts;
+}
+
+// flags of a sample taken at ts, while a reconfigure settles
+static inline uint16_t icm_settle(rpi_icm20600_t* dev, uint64_t ts, uint16_t flags) {
+	if (dev->settle) {
+		if (ts < dev->settle_ts) {
+			return flags & ~dev->settle;
+		}
+		dev->settle = 0;
+	}
+	if (dev->mark) {
+		dev->mark = 0;
+		flags |= RPI_SAMPLE_RANGE;
+	}
+	return flags;
+}
+
+int rpi_icm20600_fifo_start(rpi_icm20600_t* dev, int fifo) {
+	int rt;
+
+	fifo &= ICM20600_FIFO_ACCEL | ICM20600_FIFO_GYRO;
+	icm_stage(dev, ICM20600_FIFO_EN, 0xFF, fifo);
+	icm_stage(dev, ICM20600_USER_CTRL, ICM20600_FIFO_EN_BIT,
+		fifo? ICM20600_FIFO_EN_BIT: 0);
+	if ((rt = icm_flush(dev)) < 0) {
+		return rt;
+	}
+	dev->fifo = fifo;
+
+	// start from an empty FIFO, FIFO_RST clears itself
+	rt = icm_write_byte(dev, ICM20600_USER_CTRL,
+		(fifo? ICM20600_FIFO_EN_BIT: 0) | ICM20600_FIFO_RST_BIT);
+	return rt;
+}
+
+/*
+ * Up to max whole packets of the FIFO into buf, one burst,
+ * return packets, <0: bus error; *size: bytes per packet
+ */
+// queued: packets left in the FIFO after the n returned, NULL: not wanted
+static int icm_fifo_fetch(rpi_icm20600_t* dev, uint8_t* buf, int max,
+                          int* size, int* queued) {
+	int count, n;
+
+	// both come with the temperature, in register order
+	*size = 2;
+	*size += (dev->fifo & ICM20600_FIFO_ACCEL)? 6: 0;
+	*size += (dev->fifo & ICM20600_FIFO_GYRO)? 6: 0;
+	if (*size == 2) {
+		return 0;
+	}
+
+	if ((count = icm_read_word(dev, ICM20600_FIFO_COUNTH)) < 0) {
+		dev->status |= RPI_STATUS_COM_FAIL;
+		icm_recover(dev);
+		return RPI_TR_FAIL;
+	}
+	count &= 0x3FF;
+
+	// full: the oldest samples are lost and packets may be torn
+	if (count >= ICM20600_FIFO_SIZE) {
+		dev->status |= RPI_STATUS_OVERFLOW;
+		icm_write_byte(dev, ICM20600_USER_CTRL,
+			ICM20600_FIFO_EN_BIT | ICM20600_FIFO_RST_BIT);
+		return 0;
+	}
+
+	if ((n = count / *size) > max) {
+		n = max;
+	}
+	if (queued != NULL) {
+		*queued = count / *size - n;
+	}
+	if (n == 0) {
+		return 0;
+	}
+	if (rpi_tr_read(dev->tr, dev->addr, ICM20600_FIFO_R_W, buf, n * *size)) {
+		dev->status |= RPI_STATUS_COM_FAIL;
+		icm_recover(dev);
+		return RPI_TR_FAIL;
+	}
+	return n;
+}
+
+int rpi_icm20600_fifo_read(
+	rpi_icm20600_t* dev,
+	int16_t* accel, int16_t* gyro, int max
+) {
+	uint8_t buf[ICM20600_FIFO_SIZE];
+	const uint8_t* p;
+	int size, n, i;
+
+	icm_reconf(dev);
+	if ((n = icm_fifo_fetch(dev, buf, max, &size, NULL)) <= 0) {
+		return n;
+	}
+
+	for (i = 0, p = buf; i < n; i++) {
+		if (dev->fifo & ICM20600_FIFO_ACCEL) {
+			if (accel != NULL) {
+				icm_xyz(p, accel);
+				accel += 3;
+			}
+			p += 6;
+		}
+		// temperature
+		p += 2;
+		if (dev->fifo & ICM20600_FIFO_GYRO) {
+			if (gyro != NULL) {
+				icm_xyz(p, gyro);
+				gyro += 3;
+			}
+			p += 6;
+		}
+	}
+	return n;
+}
+
+int rpi_icm20600_fifo_block(
+	rpi_icm20600_t* dev,
+	rpi_block_t* b,
+	uint64_t period_ns
+) {
+	uint8_t buf[ICM20600_FIFO_SIZE];
+	const uint8_t* p;
+	uint16_t flags;
+	uint64_t now;
+	int size, queued, n, i, k;
+
+	icm_reconf(dev);
+	n = icm_fifo_fetch(dev, buf, rpi_block_room(b), &size, &queued);
+	if (n <= 0) {
+		return n;
+	}
+	now = rpi_tr_timestamp(dev->tr);
+	// after icm_reconf(), of the rate the rows were taken at
+	period_ns = period_ns? period_ns: icm_sample_ns(&dev->conf);
+
+	flags = RPI_SAMPLE_TEMP;
+	flags |= (dev->fifo & ICM20600_FIFO_ACCEL)? RPI_SAMPLE_ACC: 0;
+	flags |= (dev->fifo & ICM20600_FIFO_GYRO)? RPI_SAMPLE_GYR: 0;
+
+	// decoded straight into the rows; the newest sample in the FIFO
+	// is now, those still queued behind the rows are newer
+	for (i = 0, k = b->count, p = buf; i < n; i++, k++) {
+		b->ts[k] = now - (uint64_t)(queued + n - 1 - i) * period_ns;
+		b->flags[k] = (dev->settle | dev->mark)? icm_settle(dev, b->ts[k], flags): flags;
+		if (dev->fifo & ICM20600_FIFO_ACCEL) {
+			b->acc[0][k] = (int16_t)(p[0] << 8 | p[1]);
+			b->acc[1][k] = (int16_t)(p[2] << 8 | p[3]);
+			b->acc[2][k] = (int16_t)(p[4] << 8 | p[5]);
+			p += 6;
+		}
+		b->temp[k] = (int16_t)(p[0] << 8 | p[1]);
+		p += 2;
+		if (dev->fifo & ICM20600_FIFO_GYRO) {
+			b->gyr[0][k] = (int16_t)(p[0] << 8 | p[1]);
+			b->gyr[1][k] = (int16_t)(p[2] << 8 | p[3]);
+			b->gyr[2][k] = (int16_t)(p[4] << 8 | p[5]);
+			p += 6;
+		}
+	}
+	b->count = k;
+	icm_temp_cache(dev, p - size + ((dev->fifo & ICM20600_FIFO_ACCEL)? 6: 0));
+	return n;
+}
+
+int rpi_icm20600_plan(rpi_plan_t* plan, const icm20600_cfg_t* conf, int fifo) {
+	uint64_t acc_ns, gyro_ns, ns;
+	int frame;
+
+	if ((ns = icm_sample_ns(conf)) == 0) {
+		return -1;
+	}
+	icm_periods(conf, &acc_ns, &gyro_ns);
+
+	if (fifo == 0) {
+		return rpi_plan_add(plan, "icm20600", ns, ICM20600_DATA_LEN, 0, 0) < 0? -1: 0;
+	}
+	// as icm_fifo_fetch(): temperature, accel, gyro; FIFO_COUNT first
+	frame = 2;
+	frame += (acc_ns && (fifo & ICM20600_FIFO_ACCEL))? 6: 0;
+	frame += (gyro_ns && (fifo & ICM20600_FIFO_GYRO))? 6: 0;
+	if (frame == 2) {
+		return -1;
+	}
+	return rpi_plan_add(plan, "icm20600 fifo", ns, frame,
+	                    ICM20600_FIFO_SIZE / frame, 2) < 0? -1: 0;
+}
+
 void* rpi_icm20600_alloc(void) {
 	return malloc(sizeof(rpi_icm20600_t));
 }
@@ -317,66 +841,103 @@ int rpi_icm20600_init(
 	int i2c_addr,
 	const icm20600_cfg_t* conf
 ) {
-	uint8_t dummy;
-	int rt;
-
-	dev->addr = i2c_addr;
+	rpi_transport_t* tr;
 
-	if ((rt = rpi_i2c_init(i2c_dev)) < 0) {
-		return rt;
+	if ((tr = rpi_transport_i2c_bus(i2c_dev)) == NULL) {
+		return RPI_I2C_FAIL;
 	}
+	return rpi_icm20600_init_tr(dev, tr, i2c_addr, conf);
+}
 
-	// reset device
-	dummy = i2c_read_byte(dev->addr, ICM20600_USER_CTRL);
-	// ICM20600_USER_CTRL[0] 0b11111110
-	dummy |= ICM20600_RESET_BIT;
-	i2c_write_byte(dev->addr, ICM20600_USER_CTRL, dummy);
+int rpi_icm20600_init_tr(
+	rpi_icm20600_t* dev,
+	rpi_transport_t* tr,
+	int i2c_addr,
+	const icm20600_cfg_t* conf
+) {
+	rpi_startup_t job;
 
-	usleep(100);
+	rpi_icm20600_startup(&job, dev, tr, i2c_addr, conf);
+	rpi_startup_run(&job, 1);
+	return job.rt;
+}
 
-	// configuration
-	i2c_write_byte(dev->addr, ICM20600_CONFIG, 0x00);
-	// disable fifo
-	i2c_write_byte(dev->addr, ICM20600_FIFO_EN, 0x00);
+static int icm_startup_step(rpi_startup_t* job) {
+	rpi_icm20600_t* dev = job->dev;
+	unsigned i;
 
-	// set default power mode
-	icm20600_set_power_mode(dev, conf->power);
+	switch (job->state++) {
+	case 0:
+		// reset signal paths, FIFO and I2C master stay off
+		icm_write_byte(dev, ICM20600_USER_CTRL, ICM20600_RESET_BIT);
+		return 1;
 
-	// gyro config
-	icm20600_set_gyro_range(dev, conf->gyro_range);
-	icm20600_set_gyro_rate(dev,  conf->gyro_rate);
-	// for low power mode only
-	icm20600_set_gyro_aver(dev,  conf->gyro_aver);
+	default:
+		// power on values, every one of them is written once
+		for (i = 0; i < sizeof icm_defaults / sizeof icm_defaults[0]; i++) {
+			rpi_shadow_stage(&dev->shadow, icm_defaults[i][0], icm_defaults[i][1]);
+		}
+		rpi_icm20600_configure(dev, job->cfg[0]);
 
-	// accel config
-	icm20600_set_acc_range(dev,  conf->acc_range);
-	icm20600_set_acc_rate(dev,   conf->acc_rate);
-	// for low power mode only
-	icm20600_set_acc_aver(dev,   conf->acc_aver);
+		job->rt = icm_read_byte(dev, ICM20600_WHO_AM_I);
+		return RPI_STARTUP_DONE;
+	}
+}
 
-	// SAMPLE_RATE = 1KHz / (1 + divider)
-	// work for low-power gyroscope
-	//          low-power accelerometer
-	//          low-noise accelerometer
-	i2c_write_byte(dev->addr, ICM20600_SMPLRT_DIV, conf->divider);
+void rpi_icm20600_startup(
+	rpi_startup_t* job,
+	rpi_icm20600_t* dev,
+	rpi_transport_t* tr,
+	int i2c_addr,
+	const icm20600_cfg_t* conf
+) {
+	dev->addr = i2c_addr;
+	dev->tr = tr;
+	dev->status = 0;
+	dev->reads = 0;
+	dev->fifo = 0;
+	dev->temp_ts = 0;
+	dev->tcomp[0] = dev->tcomp[1] = NULL;
+	dev->want_seq = dev->conf_seq = 0;
+	dev->settle = dev->mark = 0;
+	rpi_shadow_clear(&dev->shadow);
 
-	dummy = i2c_read_byte(dev->addr, ICM20600_WHO_AM_I);
-	return dummy;
+	job->step = icm_startup_step;
+	job->dev = dev;
+	job->tr = tr;
+	job->cfg[0] = conf;
+	job->state = 0;
+	job->rt = 0;
 }
 
 int rpi_icm20600_get_accel(
 	rpi_icm20600_t* dev,
 	double* x, double* y, double* z
 ) {
-	int16_t rx, ry, rz;
+	uint8_t buf[8];
+	int16_t r[3];
+	double v[3];
 
-	rx = i2c_read_word(dev->addr, ICM20600_ACCEL_XOUT_H);
-	ry = i2c_read_word(dev->addr, ICM20600_ACCEL_YOUT_H);
-	rz = i2c_read_word(dev->addr, ICM20600_ACCEL_ZOUT_H);
+	// accel and temperature, same transaction
+	icm_reconf(dev);
+	if (icm_settling(dev, rpi_tr_timestamp(dev->tr), RPI_SAMPLE_ACC)) {
+		return RPI_ICM20600_E_BUSY;
+	}
+	if (icm_read_regs(dev, ICM20600_ACCEL_XOUT_H, buf, sizeof buf)) {
+		return RPI_TR_FAIL;
+	}
+	icm_xyz(buf, r);
+	icm_temp_cache(dev, buf + 6);
 
-	*x = dev->acc_scale * rx / RAW_MAX;
-	*y = dev->acc_scale * ry / RAW_MAX;
-	*z = dev->acc_scale * rz / RAW_MAX;
+	v[0] = dev->acc_scale * r[0] / RAW_MAX;
+	v[1] = dev->acc_scale * r[1] / RAW_MAX;
+	v[2] = dev->acc_scale * r[2] / RAW_MAX;
+	if (dev->tcomp[0] != NULL) {
+		rpi_tcomp_apply(dev->tcomp[0], icm_temp_c(dev->temp_raw), v);
+	}
+	*x = v[0];
+	*y = v[1];
+	*z = v[2];
 	return 0;
 }
 
@@ -384,28 +945,256 @@ int rpi_icm20600_get_gyro(
 	rpi_icm20600_t* dev,
 	double* x, double* y, double* z
 ) {
-	int16_t rx, ry, rz;
+	uint8_t buf[8];
+	int16_t r[3];
+	double v[3];
 
-	rx = i2c_read_word(dev->addr, ICM20600_GYRO_XOUT_H);
-	ry = i2c_read_word(dev->addr, ICM20600_GYRO_YOUT_H);
-	rz = i2c_read_word(dev->addr, ICM20600_GYRO_ZOUT_H);
+	// temperature and gyro, same transaction
+	icm_reconf(dev);
+	if (icm_settling(dev, rpi_tr_timestamp(dev->tr), RPI_SAMPLE_GYR)) {
+		return RPI_ICM20600_E_BUSY;
+	}
+	if (icm_read_regs(dev, ICM20600_TEMP_OUT_H, buf, sizeof buf)) {
+		return RPI_TR_FAIL;
+	}
+	icm_temp_cache(dev, buf);
+	icm_xyz(buf + 2, r);
 
-	*x = dev->gyro_scale * rx / RAW_MAX;
-	*y = dev->gyro_scale * ry / RAW_MAX;
-	*z = dev->gyro_scale * rz / RAW_MAX;
+	v[0] = dev->gyro_scale * r[0] / RAW_MAX;
+	v[1] = dev->gyro_scale * r[1] / RAW_MAX;
+	v[2] = dev->gyro_scale * r[2] / RAW_MAX;
+	if (dev->tcomp[1] != NULL) {
+		rpi_tcomp_apply(dev->tcomp[1], icm_temp_c(dev->temp_raw), v);
+	}
+	*x = v[0];
+	*y = v[1];
+	*z = v[2];
 	return 0;
 }
 
+void rpi_icm20600_set_tcomp(
+	rpi_icm20600_t* dev,
+	const rpi_tcomp_t* accel,
+	const rpi_tcomp_t* gyro
+) {
+	dev->tcomp[0] = accel;
+	dev->tcomp[1] = gyro;
+}
+
+// accel low power, wake on motion, in one flush
+static int icm_wom_enter(rpi_icm20600_t* dev, uint16_t thr_mg, uint8_t divider) {
+	int thr = thr_mg / ICM20600_WOM_MG_PER_LSB;
+
+	if (thr > 0xFF) {
+		thr = 0xFF;
+	}
+	icm_stage_power_mode(dev, ICM_ACC_LOW_POWER);
+	icm_stage(dev, ICM20600_SMPLRT_DIV, 0xFF, divider);
+	icm_stage(dev, ICM20600_ACCEL_WOM_X_THR, 0xFF, thr);
+	icm_stage(dev, ICM20600_ACCEL_WOM_Y_THR, 0xFF, thr);
+	icm_stage(dev, ICM20600_ACCEL_WOM_Z_THR, 0xFF, thr);
+	// INT pin active high, push-pull, 50us pulse
+	icm_stage(dev, ICM20600_INT_PIN_CFG, 0xFF, 0x00);
+	icm_stage(dev, ICM20600_ACCEL_INTEL_CTRL, 0xFF, ICM20600_INTEL_EN);
+	icm_stage(dev, ICM20600_INT_ENABLE, 0xFF, ICM20600_INT_WOM);
+	return icm_flush(dev);
+}
+
+// back to conf, interrupt on data ready
+static int icm_wom_leave(rpi_icm20600_t* dev, const icm20600_cfg_t* conf, uint8_t irq) {
+	icm_stage(dev, ICM20600_ACCEL_INTEL_CTRL, 0xFF, 0x00);
+	icm_stage(dev, ICM20600_INT_ENABLE, 0xFF, irq);
+	return rpi_icm20600_configure(dev, conf);
+}
+
+int rpi_icm20600_wom_enable(rpi_icm20600_t* dev, uint16_t thr_mg, uint8_t divider) {
+	int rt;
+
+	if ((rt = icm_wom_enter(dev, thr_mg, divider)) < 0) {
+		return rt;
+	}
+	// drop a stale status
+	return icm_read_byte(dev, ICM20600_INT_STATUS) < 0? RPI_TR_FAIL: RPI_TR_OK;
+}
+
+int rpi_icm20600_wom_disable(rpi_icm20600_t* dev, const icm20600_cfg_t* conf) {
+	return icm_wom_leave(dev, conf, 0x00);
+}
+
+int rpi_icm20600_motion_init(
+	rpi_icm20600_motion_t* m,
+	rpi_icm20600_t* dev,
+	const icm20600_cfg_t* conf,
+	int gpio,
+	uint16_t thr_mg,
+	uint8_t divider,
+	uint32_t quiet_ms
+) {
+	m->dev = dev;
+	m->conf = conf;
+	m->gpio = gpio;
+	m->thr_mg = thr_mg;
+	m->divider = divider;
+	m->quiet_ns = quiet_ms * 1000000ULL;
+	m->active = 0;
+	m->motion_ts = 0;
+	return rpi_icm20600_wom_enable(dev, thr_mg, divider);
+}
+
+// host asleep until the INT pin fires, or INT_STATUS polled without a pin
+static int motion_irq(rpi_icm20600_motion_t* m, int timeout_ms) {
+	int ms;
+
+	if (m->gpio >= 0) {
+		return rpi_gpio_event_wait(m->gpio, timeout_ms, NULL);
+	}
+	ms = m->active? 1: 10;
+	if (timeout_ms >= 0 && timeout_ms < ms) {
+		ms = timeout_ms;
+	}
+	rpi_tr_delay_ms(m->dev->tr, ms);
+	return 1;
+}
+
+int rpi_icm20600_motion_wait(
+	rpi_icm20600_motion_t* m,
+	rpi_sample_t* s,
+	int timeout_ms
+) {
+	rpi_icm20600_t* dev = m->dev;
+	int status, thr, moved, left, waited = 0, i, rt;
+	uint64_t now, deadline;
+
+	// one deadline for the whole call, however often the INT fires
+	deadline = rpi_tr_timestamp(dev->tr) + timeout_ms * 1000000ULL;
+	for (;;) {
+		left = -1;
+		if (timeout_ms >= 0) {
+			now = rpi_tr_timestamp(dev->tr);
+			if (waited && now >= deadline) {
+				return 0;
+			}
+			left = (now < deadline)? (int)((deadline - now + 999999) / 1000000): 0;
+		}
+		if ((rt = motion_irq(m, left)) <= 0) {
+			return rt;
+		}
+		waited = 1;
+		// reading it clears the interrupt
+		if ((status = icm_read_byte(dev, ICM20600_INT_STATUS)) < 0) {
+			return RPI_TR_FAIL;
+		}
+
+		if (!m->active) {
+			if (!(status & ICM20600_INT_WOM)) {
+				continue;
+			}
+			if (icm_wom_leave(dev, m->conf, ICM20600_INT_DATA_RDY) < 0) {
+				return RPI_TR_FAIL;
+			}
+			m->active = 1;
+			m->motion_ts = rpi_tr_timestamp(dev->tr);
+			m->have_ref = 0;
+			continue;
+		}
+
+		if (!(status & ICM20600_INT_DATA_RDY)) {
+			continue;
+		}
+		if (rpi_icm20600_sample(dev, s) < 0) {
+			return RPI_TR_FAIL;
+		}
+		s->ts = now = rpi_tr_timestamp(dev->tr);
+
+		// still while within thr of the sample motion was last seen at,
+		// a slow drift adds up instead of hiding in small steps
+		thr = (int)(m->thr_mg * RAW_MAX / dev->acc_scale);
+		for (i = 0, moved = !m->have_ref; i < 3; i++) {
+			moved |= abs(s->acc[i] - m->ref[i]) > thr;
+		}
+		if (moved) {
+			memcpy(m->ref, s->acc, sizeof m->ref);
+			m->have_ref = 1;
+			m->motion_ts = now;
+		} else if (now - m->motion_ts > m->quiet_ns) {
+			// quiet long enough, both go back to sleep
+			if (icm_wom_enter(dev, m->thr_mg, m->divider) < 0) {
+				return RPI_TR_FAIL;
+			}
+			m->active = 0;
+		}
+		return 1;
+	}
+}
+
+void rpi_icm20600_data_xfer(rpi_icm20600_t* dev, rpi_xfer_t* x, uint8_t* buf) {
+	icm_reconf(dev);
+	icm_check(dev);
+	x->dev = dev->addr;
+	x->reg = ICM20600_ACCEL_XOUT_H;
+	x->flags = RPI_XFER_READ;
+	x->len = ICM20600_DATA_LEN;
+	x->data = buf;
+}
+
+void rpi_icm20600_data_decode(rpi_icm20600_t* dev, const uint8_t* buf, rpi_sample_t* s) {
+	RPI_TRACE_BEGIN(RPI_TRACE_DECODE);
+	// accel, temperature, gyro
+	icm_xyz(buf, s->acc);
+	icm_temp_cache(dev, buf + 6);
+	s->temp = dev->temp_raw;
+	icm_xyz(buf + 8, s->gyr);
+	s->flags |= RPI_SAMPLE_ACC | RPI_SAMPLE_GYR | RPI_SAMPLE_TEMP;
+	if (dev->settle | dev->mark) {
+		s->flags = icm_settle(dev, rpi_tr_timestamp(dev->tr), s->flags);
+	}
+	RPI_TRACE_END(RPI_TRACE_DECODE);
+}
+
+int rpi_icm20600_sample(void* dev, rpi_sample_t* s) {
+	rpi_icm20600_t* icm = dev;
+	uint8_t buf[ICM20600_DATA_LEN];
+
+	icm_reconf(icm);
+	if (icm_read_regs(icm, ICM20600_ACCEL_XOUT_H, buf, sizeof buf)) {
+		return RPI_TR_FAIL;
+	}
+	s->flags = 0;
+	rpi_icm20600_data_decode(icm, buf, s);
+	return RPI_TR_OK;
+}
+
 // Yes there is a digital-output temperature sensor in ICM20600
 // return in centigrade degree
 int rpi_icm20600_get_temperature(
 	rpi_icm20600_t* dev,
 	double* temperature
 ) {
-	int16_t raw;
+	uint8_t buf[2];
+
+	// came with a data burst not long ago
+	if (dev->temp_ts != 0 &&
+	    rpi_tr_timestamp(dev->tr) - dev->temp_ts < RPI_TEMP_PERIOD) {
+		*temperature = icm_temp_c(dev->temp_raw);
+		return 0;
+	}
 
-	raw = i2c_read_word(dev->addr, ICM20600_TEMP_OUT_H);
-	/* Datasheet coefficients */
-	*temperature = raw / 326.8 + 25.0;
+	if (icm_read_regs(dev, ICM20600_TEMP_OUT_H, buf, sizeof buf)) {
+		return RPI_TR_FAIL;
+	}
+	icm_temp_cache(dev, buf);
+	*temperature = icm_temp_c(dev->temp_raw);
 	return 0;
 }
+
+int rpi_icm20600_status(rpi_icm20600_t* dev) {
+	int status = dev->status;
+
+	dev->status = 0;
+	return status;
+}
+
+int rpi_icm20600_recover(rpi_icm20600_t* dev) {
+	icm_recover(dev);
+	return (dev->status & RPI_STATUS_LOST)? RPI_TR_FAIL: RPI_TR_OK;
+}
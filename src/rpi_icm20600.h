@@ -30,6 +30,14 @@
 #define __RPI_ICM20600_H__
 
 #include <stdint.h>
+#include "rpi_transport.h"
+#include "rpi_shadow.h"
+#include "rpi_startup.h"
+#include "rpi_sample.h"
+#include "rpi_tcomp.h"
+#include "rpi_block.h"
+#include "rpi_plan.h"
+#include "rpi_autorange.h"
 
 #define ICM20600_I2C_ADDR0              0x68
 #define ICM20600_I2C_ADDR1              0x69
@@ -106,11 +114,16 @@ typedef enum {
 	ICM_6AXIS_LOW_NOISE,
 } icm20600_power_type_t;
 
-typedef struct {
-	uint8_t addr;
-	double acc_scale;
-	double gyro_scale;
-} rpi_icm20600_t;
+// FIFO contents, rpi_icm20600_fifo_start()
+#define ICM20600_FIFO_ACCEL	0x08
+#define ICM20600_FIFO_GYRO	0x10
+#define ICM20600_FIFO_SIZE	1008
+
+// ACCEL_XOUT_H .. GYRO_ZOUT_L
+#define ICM20600_DATA_LEN	14
+
+// no data now, a new configuration settles; the bus is fine
+#define RPI_ICM20600_E_BUSY	(-2)
 
 typedef struct icm20600_cfg {
 	uint16_t gyro_range;
@@ -136,6 +149,29 @@ typedef struct icm20600_cfg {
 	uint16_t divider;
 } icm20600_cfg_t;
 
+typedef struct {
+	uint8_t addr;
+	rpi_transport_t* tr;
+	double acc_scale;
+	double gyro_scale;
+	rpi_shadow_t shadow;
+	uint8_t status;
+	uint16_t reads;
+	uint8_t fifo;		// ICM20600_FIFO_* enabled
+	int16_t temp_raw;	// from the last data burst
+	uint64_t temp_ts;
+	const rpi_tcomp_t* tcomp[2];	// accel, gyro
+	icm20600_cfg_t conf;	// as written to the chip
+	// rpi_icm20600_reconfigure(), one control thread to the sampling one
+	icm20600_cfg_t want;
+	uint32_t want_seq;	// odd while want is written
+	uint32_t conf_seq;	// want_seq applied
+	uint8_t settle;		// RPI_SAMPLE_* left out until settle_ts
+	uint8_t mark;		// RPI_SAMPLE_RANGE on the next sample
+	uint64_t settle_ts;
+} rpi_icm20600_t;
+
+
 void* rpi_icm20600_alloc(void);
 int rpi_icm20600_free(rpi_icm20600_t* dev);
 
@@ -148,6 +184,62 @@ int rpi_icm20600_init(
 	const icm20600_cfg_t* conf
 );
 
+// same as rpi_icm20600_init(), on any bus transport
+int rpi_icm20600_init_tr(
+	rpi_icm20600_t* dev,
+	rpi_transport_t* tr,
+	int i2c_addr,
+	const icm20600_cfg_t* conf
+);
+
+// init as a job of rpi_startup_run(), with other devices
+void rpi_icm20600_startup(
+	rpi_startup_t* job,
+	rpi_icm20600_t* dev,
+	rpi_transport_t* tr,
+	int i2c_addr,
+	const icm20600_cfg_t* conf
+);
+
+// apply a whole configuration, changed registers in one burst
+int rpi_icm20600_configure(
+	rpi_icm20600_t* dev,
+	const icm20600_cfg_t* conf
+);
+
+/*
+ * Change range, rate or power mode while streaming, from one control
+ * thread. The next read of the sampling thread writes the registers
+ * which differ and the scales before its burst, a batch in flight
+ * keeps the old ones. Samples within two output periods leave out the
+ * sensors changed and get_* of them return RPI_ICM20600_E_BUSY; the
+ * first sample after carries RPI_SAMPLE_RANGE, also when nothing
+ * needed to change. A running FIFO starts over empty.
+ */
+void rpi_icm20600_reconfigure(rpi_icm20600_t* dev, const icm20600_cfg_t* conf);
+
+// the configuration last queued
+void rpi_icm20600_get_config(rpi_icm20600_t* dev, icm20600_cfg_t* conf);
+
+/*
+ * Auto-ranging of accel (ar[0]) and gyro (ar[1]), levels as
+ * acc_scale_type_t and gyro_scale_type_t, from the samples of dev
+ * as they are consumed; a range wanted is queued with
+ * rpi_icm20600_reconfigure(). return 1: queued, 0: none
+ */
+int rpi_icm20600_autorange(rpi_icm20600_t* dev, rpi_autorange_t ar[2], const rpi_sample_t* s);
+
+// single settings written at once: from the sampling thread or
+// while not streaming only, else rpi_icm20600_reconfigure()
+int icm20600_set_power_mode(rpi_icm20600_t* dev, icm20600_power_type_t mode);
+int icm20600_set_gyro_range(rpi_icm20600_t* dev, gyro_scale_type_t range);
+int icm20600_set_gyro_rate(rpi_icm20600_t* dev, gyro_lownoise_odr_type_t odr);
+int icm20600_set_gyro_aver(rpi_icm20600_t* dev, gyro_averaging_sample_type_t sample);
+int icm20600_set_acc_range(rpi_icm20600_t* dev, acc_scale_type_t range);
+int icm20600_set_acc_rate(rpi_icm20600_t* dev, acc_lownoise_odr_type_t odr);
+int icm20600_set_acc_aver(rpi_icm20600_t* dev, acc_averaging_sample_type_t sample);
+
+// return 0: OK, RPI_ICM20600_E_BUSY, <0: bus error, outputs untouched
 int rpi_icm20600_get_accel(
 	rpi_icm20600_t* dev,
 	double* x, double* y, double* z
@@ -158,11 +250,110 @@ int rpi_icm20600_get_gyro(
 	double* x, double* y, double* z
 );
 
+// accel, gyro and temperature in one burst, raw,
+// as rpi_sample_fn for rpi_array_add()
+int rpi_icm20600_sample(void* dev, rpi_sample_t* s);
+
+// The same burst as one transaction of a caller's batch,
+// buf: ICM20600_DATA_LEN bytes, decoded into s after the batch.
+void rpi_icm20600_data_xfer(rpi_icm20600_t* dev, rpi_xfer_t* x, uint8_t* buf);
+void rpi_icm20600_data_decode(rpi_icm20600_t* dev, const uint8_t* buf, rpi_sample_t* s);
+
 // Yes there is a digital-output temperature sensor in ICM20600,
-// return a integer centigrade degree
+// return a integer centigrade degree.
+// Every accel/gyro read brings it along, the register is only
+// read when none did within RPI_TEMP_PERIOD.
 int rpi_icm20600_get_temperature(
 	rpi_icm20600_t* dev,
 	double* temperature
 );
 
+// samples at the output data rate into the FIFO,
+//   fifo: ICM20600_FIFO_ACCEL and/or ICM20600_FIFO_GYRO, 0 stops
+// return 0: OK, <0: bus error
+int rpi_icm20600_fifo_start(rpi_icm20600_t* dev, int fifo);
+
+// drain up to max samples from the FIFO
+//   accel/gyro: interleaved x y z raw triplets for rpi_convert_s16x3(),
+//               NULL to drop that sensor
+// return samples read, <0: bus error
+// On overflow the FIFO restarts and RPI_STATUS_OVERFLOW is set.
+int rpi_icm20600_fifo_read(
+	rpi_icm20600_t* dev,
+	int16_t* accel, int16_t* gyro, int max
+);
+
+// drain the FIFO into the free rows of block b, no copies,
+//   period_ns: sample period, stamps back from the newest sample,
+//              0: the one of the configuration
+// return samples added, <0: bus error
+int rpi_icm20600_fifo_block(
+	rpi_icm20600_t* dev,
+	rpi_block_t* b,
+	uint64_t period_ns
+);
+
+// the streams of conf for plan,
+//   fifo: ICM20600_FIFO_* read through the FIFO, 0: the data burst
+// return 0: OK, <0: power mode without output or plan full
+int rpi_icm20600_plan(rpi_plan_t* plan, const icm20600_cfg_t* conf, int fifo);
+
+// Wake on motion: accel only, low power, at 1kHz / (1 + divider);
+// INT fires when an axis changes by more than thr_mg (4mg steps,
+// up to 1020mg) from the previous sample.
+int rpi_icm20600_wom_enable(rpi_icm20600_t* dev, uint16_t thr_mg, uint8_t divider);
+
+// leave wake on motion for the configuration conf
+int rpi_icm20600_wom_disable(rpi_icm20600_t* dev, const icm20600_cfg_t* conf);
+
+/*
+ * Motion gated streaming: while still, the sensor sits in wake on
+ * motion and the host sleeps on the INT pin. Motion switches to conf
+ * with a data ready interrupt; quiet_ms without motion goes back.
+ */
+typedef struct {
+	rpi_icm20600_t* dev;
+	const icm20600_cfg_t* conf;
+	int gpio;		// event fd of INT, <0: poll INT_STATUS
+	uint16_t thr_mg;
+	uint8_t divider;
+	uint8_t active;		// streaming
+	uint8_t have_ref;
+	int16_t ref[3];		// accel when motion was last seen
+	uint64_t quiet_ns;
+	uint64_t motion_ts;
+} rpi_icm20600_motion_t;
+
+// gpio: from rpi_gpio_event_open(chip, line, RPI_GPIO_RISING)
+int rpi_icm20600_motion_init(
+	rpi_icm20600_motion_t* m,
+	rpi_icm20600_t* dev,
+	const icm20600_cfg_t* conf,
+	int gpio,
+	uint16_t thr_mg,
+	uint8_t divider,
+	uint32_t quiet_ms
+);
+
+// next sample while in motion, sleeps through still periods
+// return 1: sample, 0: timeout_ms without a sample, <0: error
+int rpi_icm20600_motion_wait(
+	rpi_icm20600_motion_t* m,
+	rpi_sample_t* s,
+	int timeout_ms
+);
+
+// compensate get_accel/get_gyro for temperature, NULL: off
+void rpi_icm20600_set_tcomp(
+	rpi_icm20600_t* dev,
+	const rpi_tcomp_t* accel,
+	const rpi_tcomp_t* gyro
+);
+
+// RPI_STATUS_* since last call
+int rpi_icm20600_status(rpi_icm20600_t* dev);
+
+// check the chip and apply the configuration again if it was reset
+int rpi_icm20600_recover(rpi_icm20600_t* dev);
+
 #endif//__RPI_ICM20600_H__
@@ -0,0 +1,195 @@
+/*
+ * ICM20600 C++ wrapper, configuration fixed at compile time
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_ICM20600_HPP__
+#define __RPI_ICM20600_HPP__
+
+#include "rpi_imu.hpp"
+
+extern "C" {
+#include "rpi_icm20600.h"
+}
+
+namespace rpi {
+
+constexpr double icm20600_acc_fs(acc_scale_type_t r) {
+	return 2000.0 * (1 << r);		// mg
+}
+
+constexpr double icm20600_gyro_fs(gyro_scale_type_t r) {
+	return 250.0 * (1 << r);		// dps
+}
+
+constexpr double icm20600_gyro_hz(gyro_lownoise_odr_type_t odr) {
+	return (odr <= GYRO_RATE_8K_BW_250)? 8000.0: 1000.0;
+}
+
+constexpr double icm20600_acc_hz(acc_lownoise_odr_type_t odr) {
+	return (odr == ACC_RATE_4K_BW_1046)? 4000.0: 1000.0;
+}
+
+/*
+ * Usage:
+ *   rpi::icm20600<RANGE_16G, ACC_RATE_1K_BW_420,
+ *                 RANGE_2K_DPS, GYRO_RATE_1K_BW_176> icm("/dev/i2c-1");
+ *   if (!icm) ...
+ *   rpi::vec3<float> a;
+ *   icm.read_accel(a);
+ *
+ * Every read is one rpi_icm20600_sample(): the data burst with the
+ * health check, recovery and status of the C driver. The scales are
+ * the template's, keep the range as it is (no autorange).
+ */
+template <
+	acc_scale_type_t          AccRange,
+	acc_lownoise_odr_type_t   AccRate,
+	gyro_scale_type_t         GyroRange,
+	gyro_lownoise_odr_type_t  GyroRate,
+	icm20600_power_type_t     Power   = ICM_6AXIS_LOW_NOISE,
+	uint8_t                   Divider = 0
+>
+class icm20600: noncopyable {
+public:
+	static constexpr double acc_lsb  = lsb(icm20600_acc_fs(AccRange));
+	static constexpr double gyro_lsb = lsb(icm20600_gyro_fs(GyroRange));
+	static constexpr double acc_hz   = icm20600_acc_hz(AccRate);
+	static constexpr double gyro_hz  = icm20600_gyro_hz(GyroRate);
+
+	explicit icm20600(
+		const char* i2c_dev = "/dev/i2c-1",
+		int i2c_addr = ICM20600_I2C_ADDR1
+	) {
+		const icm20600_cfg_t conf = {
+			GyroRange, GyroRate, GYRO_AVERAGE_1,
+			AccRange,  AccRate,  ACC_AVERAGE_4,
+			Power, Divider
+		};
+		id_ = rpi_icm20600_init(&dev_, i2c_dev, i2c_addr, &conf);
+	}
+
+	icm20600(
+		rpi_transport_t* tr,
+		int i2c_addr = ICM20600_I2C_ADDR1
+	) {
+		const icm20600_cfg_t conf = {
+			GyroRange, GyroRate, GYRO_AVERAGE_1,
+			AccRange,  AccRate,  ACC_AVERAGE_4,
+			Power, Divider
+		};
+		id_ = rpi_icm20600_init_tr(&dev_, tr, i2c_addr, &conf);
+	}
+
+	// device ID, <0 on failure
+	int id() const { return id_; }
+	explicit operator bool() const { return id_ >= 0; }
+
+	rpi_icm20600_t* handle() { return &dev_; }
+
+	// RPI_STATUS_* since the last call
+	int health() { return rpi_icm20600_status(&dev_); }
+
+	// RPI_TR_OK, RPI_TR_FAIL or RPI_ICM20600_E_BUSY while settling
+	int read_accel_raw(vec3<int16_t>& a) {
+		rpi_sample_t s;
+		int rt;
+
+		if ((rt = sample(s, RPI_SAMPLE_ACC)) == RPI_TR_OK) {
+			a = vec3<int16_t>{ s.acc[0], s.acc[1], s.acc[2] };
+		}
+		return rt;
+	}
+
+	int read_gyro_raw(vec3<int16_t>& g) {
+		rpi_sample_t s;
+		int rt;
+
+		if ((rt = sample(s, RPI_SAMPLE_GYR)) == RPI_TR_OK) {
+			g = vec3<int16_t>{ s.gyr[0], s.gyr[1], s.gyr[2] };
+		}
+		return rt;
+	}
+
+	// accel in mg
+	template <typename T>
+	int read_accel(vec3<T>& a) {
+		vec3<int16_t> raw;
+		int rt;
+
+		if ((rt = read_accel_raw(raw)) == RPI_TR_OK) {
+			a = scale(raw, (T)acc_lsb);
+		}
+		return rt;
+	}
+
+	// gyro in dps
+	template <typename T>
+	int read_gyro(vec3<T>& g) {
+		vec3<int16_t> raw;
+		int rt;
+
+		if ((rt = read_gyro_raw(raw)) == RPI_TR_OK) {
+			g = scale(raw, (T)gyro_lsb);
+		}
+		return rt;
+	}
+
+	// accel + temperature + gyro in one burst
+	template <typename T>
+	int read_motion(vec3<T>& a, vec3<T>& g, T& temperature) {
+		rpi_sample_t s;
+		int rt;
+
+		if ((rt = sample(s, RPI_SAMPLE_ACC | RPI_SAMPLE_GYR)) != RPI_TR_OK) {
+			return rt;
+		}
+		a = vec3<T>{ s.acc[0] * (T)acc_lsb, s.acc[1] * (T)acc_lsb,
+		             s.acc[2] * (T)acc_lsb };
+		g = vec3<T>{ s.gyr[0] * (T)gyro_lsb, s.gyr[1] * (T)gyro_lsb,
+		             s.gyr[2] * (T)gyro_lsb };
+		temperature = s.temp * (T)(1.0 / 326.8) + (T)25.0;
+		return RPI_TR_OK;
+	}
+
+private:
+	// a sample without the wanted flags is still settling
+	int sample(rpi_sample_t& s, uint16_t want) {
+		int rt;
+
+		if ((rt = rpi_icm20600_sample(&dev_, &s)) != RPI_TR_OK) {
+			return rt;
+		}
+		return ((s.flags & want) == want)? RPI_TR_OK: RPI_ICM20600_E_BUSY;
+	}
+
+	rpi_icm20600_t dev_;
+	int id_;
+};
+
+} // namespace rpi
+
+#endif//__RPI_ICM20600_HPP__
@@ -0,0 +1,83 @@
+/*
+ * Compile-time helpers shared by the C++ sensor wrappers
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_IMU_HPP__
+#define __RPI_IMU_HPP__
+
+#include <stdint.h>
+
+/*
+ * Header-only, needs C++14.
+ *
+ * Every sensor wrapper is a template on its range/ODR settings,
+ * so the LSB weights below are folded by the compiler and the
+ * per-sample conversion is a plain multiply.
+ */
+namespace rpi {
+
+// full scale of a signed 16-bit sample
+constexpr double RAW_MAX = 0x8000;
+
+template <typename T>
+struct vec3 {
+	T x, y, z;
+};
+
+// unit per LSB, eg. mg/LSB or dps/LSB
+constexpr double lsb(double full_scale) {
+	return full_scale / RAW_MAX;
+}
+
+// little endian register pair (Bosch, AKM)
+constexpr int16_t le16(const uint8_t* p) {
+	return (int16_t)((uint16_t)p[1] << 8 | p[0]);
+}
+
+// big endian register pair (InvenSense)
+constexpr int16_t be16(const uint8_t* p) {
+	return (int16_t)((uint16_t)p[0] << 8 | p[1]);
+}
+
+template <typename T, typename R>
+inline vec3<T> scale(const R& raw, T k) {
+	return vec3<T>{ raw.x * k, raw.y * k, raw.z * k };
+}
+
+// Devices own a C handle by value,
+// a copy would alias the same hardware state.
+class noncopyable {
+protected:
+	noncopyable() = default;
+	~noncopyable() = default;
+	noncopyable(const noncopyable&) = delete;
+	noncopyable& operator=(const noncopyable&) = delete;
+};
+
+} // namespace rpi
+
+#endif//__RPI_IMU_HPP__
@@ -0,0 +1,254 @@
+/*
+ * Bus bandwidth planner and cyclic schedule
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <string.h>
+#include "rpi_plan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * I2C register read: start, address + W, register, repeated start,
+ * address + R, the data, stop; 9 clocks a byte with the ACK.
+ */
+#define I2C_XFER_BITS	30
+#define I2C_BYTE_BITS	9
+
+void rpi_plan_init(rpi_plan_t* plan, rpi_transport_t* tr, uint32_t hz) {
+	memset(plan, 0, sizeof *plan);
+	plan->kind = (tr && tr->kind == RPI_TR_SPI)? RPI_TR_SPI: RPI_TR_I2C;
+	if (plan->kind == RPI_TR_SPI) {
+		plan->hz = hz? hz: 10000000;
+		plan->overhead_ns = RPI_PLAN_SPI_OVERHEAD;
+	} else {
+		plan->hz = hz? hz: 400000;
+		plan->overhead_ns = RPI_PLAN_I2C_OVERHEAD;
+	}
+}
+
+int rpi_plan_add(rpi_plan_t* plan, const char* name, uint64_t sample_ns,
+                 uint16_t frame, uint16_t fifo, uint16_t extra) {
+	rpi_plan_task_t* t;
+
+	if (plan->tasks >= RPI_PLAN_MAX_TASK || sample_ns == 0 || frame == 0) {
+		return -1;
+	}
+	t = &plan->task[plan->tasks];
+	memset(t, 0, sizeof *t);
+	strncpy(t->name, name, sizeof t->name - 1);
+	t->sample_ns = sample_ns;
+	t->frame = frame;
+	// a FIFO of less than 2 samples is no use, read it as registers
+	t->fifo = (fifo >= 2)? fifo: 0;
+	t->extra = extra;
+	return plan->tasks++;
+}
+
+uint64_t rpi_plan_cost(const rpi_plan_t* plan, int xfers, int bytes) {
+	uint64_t bits;
+
+	if (plan->kind == RPI_TR_SPI) {
+		// the register byte, then the data
+		bits = 8ULL * (xfers + bytes);
+	} else {
+		bits = (uint64_t)I2C_XFER_BITS * xfers + (uint64_t)I2C_BYTE_BITS * bytes;
+	}
+	return bits * 1000000000ULL / plan->hz + (uint64_t)xfers * plan->overhead_ns;
+}
+
+static uint64_t gcd(uint64_t a, uint64_t b) {
+	while (b) {
+		uint64_t r = a % b;
+
+		a = b;
+		b = r;
+	}
+	return a;
+}
+
+static void task_update(const rpi_plan_t* plan, rpi_plan_task_t* t) {
+	t->period_ns = t->burst * t->sample_ns;
+	if (t->fifo) {
+		// the watermark is reached at the release, full fifo - burst later
+		t->deadline_ns = (t->fifo - t->burst) * t->sample_ns;
+		t->cost_ns = rpi_plan_cost(plan, 1, t->burst * t->frame);
+		t->cost_ns += t->extra? rpi_plan_cost(plan, 1, t->extra): 0;
+	} else {
+		t->deadline_ns = t->sample_ns;
+		t->cost_ns = rpi_plan_cost(plan, 1 + (t->extra != 0), t->frame + t->extra);
+	}
+}
+
+// non-preemptive earliest deadline first over one major cycle
+static int plan_layout(rpi_plan_t* plan) {
+	uint32_t done[RPI_PLAN_MAX_TASK];
+	uint64_t now = 0, jobs = 0, release, deadline, best_dl, next;
+	int i, best;
+
+	plan->cycle_ns = 1;
+	for (i = 0; i < plan->tasks; i++) {
+		uint64_t p = plan->task[i].period_ns;
+
+		plan->cycle_ns = plan->cycle_ns / gcd(plan->cycle_ns, p) * p;
+		if (plan->cycle_ns > RPI_PLAN_MAX_CYCLE) {
+			return RPI_PLAN_CYCLE;
+		}
+	}
+	for (i = 0; i < plan->tasks; i++) {
+		jobs += plan->cycle_ns / plan->task[i].period_ns;
+		done[i] = 0;
+	}
+	if (jobs > RPI_PLAN_MAX_SLOT) {
+		return RPI_PLAN_CYCLE;
+	}
+
+	for (plan->slots = 0; plan->slots < (int)jobs; ) {
+		best = -1;
+		best_dl = UINT64_MAX;
+		next = UINT64_MAX;
+		for (i = 0; i < plan->tasks; i++) {
+			rpi_plan_task_t* t = &plan->task[i];
+
+			if (done[i] == plan->cycle_ns / t->period_ns) {
+				continue;
+			}
+			release = done[i] * t->period_ns;
+			if (release > now) {
+				next = (release < next)? release: next;
+				continue;
+			}
+			deadline = release + t->deadline_ns;
+			if (deadline < best_dl) {
+				best_dl = deadline;
+				best = i;
+			}
+		}
+		if (best < 0) {
+			// idle to the next release
+			now = next;
+			continue;
+		}
+
+		plan->slot[plan->slots].offset_ns = now;
+		plan->slot[plan->slots].task = best;
+		plan->slots++;
+		now += plan->task[best].cost_ns;
+		// late, or running into the next cycle
+		if (now > best_dl || now > plan->cycle_ns) {
+			return RPI_PLAN_DEADLINE;
+		}
+		done[best]++;
+	}
+	return 0;
+}
+
+int rpi_plan_schedule(rpi_plan_t* plan) {
+	rpi_plan_task_t* t;
+	uint64_t most;
+	int i, rt, longest;
+
+	// the largest bursts the FIFOs and the latency allow, least overhead
+	for (i = 0; i < plan->tasks; i++) {
+		t = &plan->task[i];
+		t->burst = 1;
+		if (t->fifo) {
+			t->burst = t->fifo / 2;
+			if (plan->latency_ns && plan->latency_ns / t->sample_ns < t->burst) {
+				t->burst = plan->latency_ns / t->sample_ns;
+			}
+			t->burst = t->burst? t->burst: 1;
+		}
+	}
+
+	for (;;) {
+		plan->utilization = 0;
+		for (i = 0; i < plan->tasks; i++) {
+			task_update(plan, &plan->task[i]);
+			plan->utilization += (double)plan->task[i].cost_ns /
+			                     plan->task[i].period_ns;
+		}
+		// smaller bursts only add overhead
+		if (plan->utilization > 1.0) {
+			plan->slots = 0;
+			return RPI_PLAN_OVERLOAD;
+		}
+		if ((rt = plan_layout(plan)) == 0) {
+			return 0;
+		}
+
+		// halve the longest read which can be shorter
+		longest = -1;
+		most = 0;
+		for (i = 0; i < plan->tasks; i++) {
+			t = &plan->task[i];
+			if (t->burst > 1 && t->cost_ns > most) {
+				most = t->cost_ns;
+				longest = i;
+			}
+		}
+		if (longest < 0) {
+			plan->slots = 0;
+			return rt;
+		}
+		plan->task[longest].burst /= 2;
+	}
+}
+
+void rpi_plan_report(const rpi_plan_t* plan, FILE* fp) {
+	const rpi_plan_task_t* t;
+	int i;
+
+	fprintf(fp, "%s %u kHz, %u us a transaction\n",
+		(plan->kind == RPI_TR_SPI)? "SPI": "I2C", plan->hz / 1000,
+		plan->overhead_ns / 1000);
+	fprintf(fp, "%-16s %9s %6s %10s %10s %10s %6s\n", "stream", "rate(Hz)",
+		"burst", "period(us)", "cost(us)", "dline(us)", "load");
+	for (i = 0; i < plan->tasks; i++) {
+		t = &plan->task[i];
+		fprintf(fp, "%-16s %9.1f %6u %10.1f %10.1f %10.1f %5.1f%%\n", t->name,
+			1e9 / t->sample_ns, t->burst, t->period_ns / 1000.0,
+			t->cost_ns / 1000.0, t->deadline_ns / 1000.0,
+			t->period_ns? 100.0 * t->cost_ns / t->period_ns: 0.0);
+	}
+	fprintf(fp, "bus load %.1f%%", 100.0 * plan->utilization);
+	if (plan->slots == 0) {
+		fprintf(fp, ", no schedule\n");
+		return;
+	}
+	fprintf(fp, ", cycle %.1f us, %d reads\n", plan->cycle_ns / 1000.0,
+		plan->slots);
+	for (i = 0; i < plan->slots; i++) {
+		fprintf(fp, "%10.1f us  %s\n", plan->slot[i].offset_ns / 1000.0,
+			plan->task[plan->slot[i].task].name);
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Bus bandwidth planner and cyclic schedule
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_PLAN_H__
+#define __RPI_PLAN_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include "rpi_transport.h"
+
+#define RPI_PLAN_MAX_TASK	16
+#define RPI_PLAN_MAX_SLOT	1024
+// longest major cycle of a schedule, ns
+#define RPI_PLAN_MAX_CYCLE	1000000000ULL
+
+// host time of one transaction, ioctl and driver, ns; rough figures
+// of a Pi, compare with the XFER stage of rpi_trace_report()
+#define RPI_PLAN_I2C_OVERHEAD	30000
+#define RPI_PLAN_SPI_OVERHEAD	15000
+
+// rpi_plan_schedule() errors
+#define RPI_PLAN_OVERLOAD	-1	// more than the bus can carry
+#define RPI_PLAN_DEADLINE	-2	// fits on average, a deadline is missed
+#define RPI_PLAN_CYCLE		-3	// major cycle too long or too many slots
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * One sensor stream, read periodically in bursts. From the data
+ * registers every sample must be read before the next one
+ * overwrites it; from a FIFO a burst is read when burst samples
+ * are waiting, the watermark, before the FIFO fills up.
+ */
+typedef struct {
+	char name[16];
+	uint64_t sample_ns;	// output data period
+	uint16_t frame;		// bytes of one sample as read
+	uint16_t fifo;		// samples the FIFO holds, 0: data registers
+	uint16_t extra;		// bytes of a read ahead of each burst, eg. FIFO count
+	// by rpi_plan_schedule()
+	uint16_t burst;		// samples per read, watermark = burst * frame
+	uint64_t period_ns;	// between reads
+	uint64_t deadline_ns;	// after the release, when data would be lost
+	uint64_t cost_ns;	// bus and host time of a read
+} rpi_plan_task_t;
+
+typedef struct {
+	uint64_t offset_ns;	// start within the major cycle
+	int task;
+} rpi_plan_slot_t;
+
+typedef struct {
+	int kind;		// RPI_TR_I2C or RPI_TR_SPI
+	uint32_t hz;		// bus clock
+	uint32_t overhead_ns;	// host time per transaction
+	uint64_t latency_ns;	// longest a sample may wait in a FIFO, 0: any
+	int tasks;
+	rpi_plan_task_t task[RPI_PLAN_MAX_TASK];
+	// by rpi_plan_schedule()
+	double utilization;
+	uint64_t cycle_ns;
+	int slots;
+	rpi_plan_slot_t slot[RPI_PLAN_MAX_SLOT];
+} rpi_plan_t;
+
+/*
+ * A plan for the bus of tr, modelled as I2C unless it is SPI,
+ *   hz: bus clock, 0: 400 kHz I2C, 10 MHz SPI
+ */
+void rpi_plan_init(rpi_plan_t* plan, rpi_transport_t* tr, uint32_t hz);
+
+// return task index, <0: too many; the drivers' rpi_*_plan() call this
+int rpi_plan_add(rpi_plan_t* plan, const char* name, uint64_t sample_ns,
+                 uint16_t frame, uint16_t fifo, uint16_t extra);
+
+// bus and host time of xfers transactions reading bytes in all, ns
+uint64_t rpi_plan_cost(const rpi_plan_t* plan, int xfers, int bytes);
+
+/*
+ * Pick the bursts and build a static cyclic schedule: every read
+ * a fixed offset in the major cycle, the LCM of the read periods.
+ * Reads are not preemptive, laid out by earliest deadline first;
+ * a burst too long for the deadline of another stream is halved
+ * until the schedule fits.
+ * return 0: OK, RPI_PLAN_*: rejected
+ */
+int rpi_plan_schedule(rpi_plan_t* plan);
+
+// tasks, load and the slots as text
+void rpi_plan_report(const rpi_plan_t* plan, FILE* fp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_PLAN_H__
@@ -0,0 +1,172 @@
+/*
+ * Delta-angle and delta-velocity pre-integration
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <string.h>
+#include "rpi_preint.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DEG_TO_RAD	0.017453292519943295
+#define MG_TO_MS2	0.00980665
+#define RAW_MAX		0x8000
+#define NS_TO_S		1e-9f
+
+static inline void cross_add(float r[3], float k, const float a[3], const float b[3]) {
+	r[0] += k * (a[1] * b[2] - a[2] * b[1]);
+	r[1] += k * (a[2] * b[0] - a[0] * b[2]);
+	r[2] += k * (a[0] * b[1] - a[1] * b[0]);
+}
+
+void rpi_preint_init(rpi_preint_t* p, uint64_t sample_ns, uint64_t period_ns) {
+	memset(p, 0, sizeof *p);
+	p->sample_ns = sample_ns;
+	p->period_ns = period_ns;
+	p->gyr_k = 1.0f;
+	p->acc_k = 1.0f;
+}
+
+void rpi_preint_scale(rpi_preint_t* p, double gyro_dps, double acc_mg) {
+	p->gyr_k = gyro_dps * DEG_TO_RAD / RAW_MAX;
+	p->acc_k = acc_mg * MG_TO_MS2 / RAW_MAX;
+}
+
+void rpi_preint_reset(rpi_preint_t* p) {
+	p->started = 0;
+}
+
+static void preint_clear(rpi_preint_t* p, uint64_t t0) {
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		p->alpha[i] = p->beta[i] = 0.0f;
+		p->vel[i] = p->scul[i] = 0.0f;
+	}
+	p->t0 = t0;
+	p->count = 0;
+	p->flags = 0;
+}
+
+int rpi_preint_sample(
+	rpi_preint_t* p,
+	uint64_t ts,
+	const float gyr[3],
+	const float acc[3],
+	rpi_preint_delta_t* out
+) {
+	uint64_t ns = ts - p->last_ts;
+	float dt, da[3], dv[3], ca[3], cv[3];
+	int i;
+
+	if (!p->started) {
+		preint_clear(p, ts - p->sample_ns);
+		p->flags = RPI_PREINT_SHORT;
+		p->due = (ts / p->period_ns + 1) * p->period_ns;
+		for (i = 0; i < 3; i++) {
+			p->da[i] = p->dv[i] = 0.0f;
+		}
+		p->started = 1;
+		ns = p->sample_ns;
+	} else if (ns > p->sample_ns * 5 / 2) {
+		// a sample or more lost, or time went back
+		p->flags |= RPI_PREINT_GAP;
+		ns = p->sample_ns;
+	}
+	p->last_ts = ts;
+	dt = ns * NS_TO_S;
+
+	for (i = 0; i < 3; i++) {
+		da[i] = gyr[i] * dt;
+		dv[i] = acc[i] * dt;
+		// one sample back, plus 1/6 of its increment
+		ca[i] = p->alpha[i] + p->da[i] * (1.0f / 6);
+		cv[i] = p->vel[i] + p->dv[i] * (1.0f / 6);
+	}
+	cross_add(p->beta, 0.5f, ca, da);
+	cross_add(p->scul, 0.5f, ca, dv);
+	cross_add(p->scul, 0.5f, cv, da);
+	for (i = 0; i < 3; i++) {
+		p->alpha[i] += da[i];
+		p->vel[i] += dv[i];
+		p->da[i] = da[i];
+		p->dv[i] = dv[i];
+	}
+	p->count++;
+
+	if (ts < p->due) {
+		return 0;
+	}
+
+	// slow rate: coning and sculling in, velocity rotated to t0
+	out->t0 = p->t0;
+	out->t1 = ts;
+	out->count = p->count;
+	out->flags = p->flags;
+	for (i = 0; i < 3; i++) {
+		out->dtheta[i] = p->alpha[i] + p->beta[i];
+		out->dvel[i] = p->vel[i] + p->scul[i];
+	}
+	cross_add(out->dvel, 0.5f, p->alpha, p->vel);
+
+	while (p->due <= ts) {
+		p->due += p->period_ns;
+	}
+	preint_clear(p, ts);
+	return 1;
+}
+
+int rpi_preint_block(rpi_preint_t* p, const rpi_block_t* b, int* row,
+                     rpi_preint_delta_t* out) {
+	const uint16_t both = RPI_SAMPLE_ACC | RPI_SAMPLE_GYR;
+	float gyr[3], acc[3];
+	int i, n = 0;
+
+	for (i = *row; i < b->count; i++) {
+		// counts of another range from here, the caller scales first
+		if (i > *row && (b->flags[i] & RPI_SAMPLE_RANGE)) {
+			break;
+		}
+		if ((b->flags[i] & both) != both) {
+			continue;
+		}
+		gyr[0] = b->gyr[0][i] * p->gyr_k;
+		gyr[1] = b->gyr[1][i] * p->gyr_k;
+		gyr[2] = b->gyr[2][i] * p->gyr_k;
+		acc[0] = b->acc[0][i] * p->acc_k;
+		acc[1] = b->acc[1][i] * p->acc_k;
+		acc[2] = b->acc[2][i] * p->acc_k;
+		n += rpi_preint_sample(p, b->ts[i], gyr, acc, &out[n]);
+	}
+	*row = i;
+	return n;
+}
+
+#ifdef __cplusplus
+}
+#endif
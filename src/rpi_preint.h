@@ -0,0 +1,126 @@
+/*
+ * Delta-angle and delta-velocity pre-integration
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_PREINT_H__
+#define __RPI_PREINT_H__
+
+#include <stdint.h>
+#include "rpi_block.h"
+
+// rpi_preint_delta_t.flags
+#define RPI_PREINT_GAP		0x01	// samples missing, dt clamped
+#define RPI_PREINT_SHORT	0x02	// the first one, from the start
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * One increment over [t0, t1], in the body frame at t0:
+ * the rotation vector and the velocity change, coning and sculling
+ * included, as a navigation filter takes them at its own rate.
+ */
+typedef struct {
+	uint64_t t0;		// ns, CLOCK_MONOTONIC
+	uint64_t t1;
+	float dtheta[3];	// rad
+	float dvel[3];		// m/s
+	uint16_t count;		// samples in it
+	uint16_t flags;		// RPI_PREINT_*
+} rpi_preint_delta_t;
+
+/*
+ * Integrator of one synchronised gyro/accel stream, as Savage's
+ * two-speed algorithm: per sample a few cross products with the
+ * previous increment, the rotation and velocity update once per
+ * output at the slow rate.
+ */
+typedef struct {
+	uint64_t sample_ns;	// nominal input period
+	uint64_t period_ns;	// output period
+	float gyr_k;		// raw to rad/s, rpi_preint_block()
+	float acc_k;		// raw to m/s^2
+	// interval so far
+	int started;
+	uint16_t count;
+	uint16_t flags;
+	uint64_t t0;
+	uint64_t last_ts;
+	uint64_t due;		// end of the interval, a multiple of period_ns
+	float alpha[3];		// sum of the angle increments
+	float beta[3];		// coning
+	float vel[3];		// sum of the velocity increments
+	float scul[3];		// sculling
+	float da[3];		// previous increments
+	float dv[3];
+} rpi_preint_t;
+
+/*
+ * sample_ns: input period, eg. 500000 for 2kHz
+ * period_ns: output period, outputs end on its multiples
+ */
+void rpi_preint_init(rpi_preint_t* p, uint64_t sample_ns, uint64_t period_ns);
+
+/*
+ * Raw scales of rpi_preint_block() from the full scale ranges,
+ * eg. rpi_bmi088_t.gyro_range and accel_range; again after a
+ * sample with RPI_SAMPLE_RANGE.
+ */
+void rpi_preint_scale(rpi_preint_t* p, double gyro_dps, double acc_mg);
+
+// drop the interval in progress, the next sample starts anew
+void rpi_preint_reset(rpi_preint_t* p);
+
+/*
+ * One sample, gyro in rad/s, accel in m/s^2, held over the time
+ * since the one before. return 1: *out filled, 0: not yet
+ */
+int rpi_preint_sample(
+	rpi_preint_t* p,
+	uint64_t ts,
+	const float gyr[3],
+	const float acc[3],
+	rpi_preint_delta_t* out
+);
+
+/*
+ * Rows of b from *row on that carry both gyro and accel, in the raw
+ * scales; out: room for b->count increments, one per row at most.
+ * Stops before a later row with RPI_SAMPLE_RANGE and leaves *row
+ * there: rpi_preint_scale() to the new range, then call again.
+ * *row is b->count once all rows are done.
+ * return increments written
+ */
+int rpi_preint_block(rpi_preint_t* p, const rpi_block_t* b, int* row,
+                     rpi_preint_delta_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_PREINT_H__
@@ -0,0 +1,279 @@
+/*
+ * Recording and replaying bus transports
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rpi_transport.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * File layout:
+ *   "RPITR001"
+ *   record_t + len bytes of data, ...
+ * data is what was read, or what was written.
+ */
+#define REC_MAGIC	"RPITR001"
+#define REC_READ	'R'
+#define REC_WRITE	'W'
+#define REC_DATA_MAX	4096
+
+typedef struct {
+	uint8_t op;
+	uint8_t dev;
+	uint8_t reg;
+	int8_t status;
+	uint16_t len;
+	uint16_t reserved;
+	uint64_t ts;
+} record_t;
+
+typedef struct {
+	FILE* fp;
+	rpi_transport_t* inner;		// recording only
+	uint64_t ts;			// replaying, time of last record
+	record_t next;
+	int has_next;
+	int errors;			// replaying, transactions off the log
+	uint8_t data[REC_DATA_MAX];
+} rec_priv_t;
+
+/***************************************************************
+ record
+ ***************************************************************/
+static void rec_log(rec_priv_t* p, uint8_t op, uint8_t dev, uint8_t reg,
+                    int8_t status, const uint8_t* data, uint16_t len) {
+	record_t r;
+
+	memset(&r, 0, sizeof r);
+	r.op = op;
+	r.dev = dev;
+	r.reg = reg;
+	r.status = status;
+	r.len = len;
+	r.ts = rpi_tr_timestamp(p->inner);
+	fwrite(&r, sizeof r, 1, p->fp);
+	fwrite(data, 1, len, p->fp);
+}
+
+static int8_t rec_read(rpi_transport_t* tr, uint8_t dev,
+                       uint8_t reg, uint8_t* data, uint16_t len) {
+	rec_priv_t* p = tr->priv;
+	int8_t rt;
+
+	rt = rpi_tr_read(p->inner, dev, reg, data, len);
+	rec_log(p, REC_READ, dev, reg, rt, data, len);
+	return rt;
+}
+
+static int8_t rec_write(rpi_transport_t* tr, uint8_t dev,
+                        uint8_t reg, const uint8_t* data, uint16_t len) {
+	rec_priv_t* p = tr->priv;
+	int8_t rt;
+
+	rt = rpi_tr_write(p->inner, dev, reg, data, len);
+	rec_log(p, REC_WRITE, dev, reg, rt, data, len);
+	return rt;
+}
+
+static int rec_batch(rpi_transport_t* tr, rpi_xfer_t* xfers, int count) {
+	rec_priv_t* p = tr->priv;
+	int i, rt;
+
+	rt = rpi_tr_batch(p->inner, xfers, count);
+	for (i = 0; i < count; i++) {
+		rpi_xfer_t* x = &xfers[i];
+
+		rec_log(p, (x->flags & RPI_XFER_READ)? REC_READ: REC_WRITE,
+		        x->dev, x->reg, rt, x->data, x->len);
+	}
+	return rt;
+}
+
+static void rec_delay_ms(rpi_transport_t* tr, uint32_t millis) {
+	rec_priv_t* p = tr->priv;
+
+	rpi_tr_delay_ms(p->inner, millis);
+}
+
+static uint64_t rec_timestamp(rpi_transport_t* tr) {
+	rec_priv_t* p = tr->priv;
+
+	return rpi_tr_timestamp(p->inner);
+}
+
+static void rec_close(rpi_transport_t* tr) {
+	rec_priv_t* p = tr->priv;
+
+	fclose(p->fp);
+	free(p);
+	free(tr);
+}
+
+rpi_transport_t* rpi_transport_record(rpi_transport_t* inner, const char* path) {
+	rpi_transport_t* tr;
+	rec_priv_t* p;
+
+	tr = calloc(1, sizeof *tr);
+	p = calloc(1, sizeof *p);
+	if (tr == NULL || p == NULL || (p->fp = fopen(path, "wb")) == NULL) {
+		free(tr);
+		free(p);
+		return NULL;
+	}
+	fwrite(REC_MAGIC, 1, 8, p->fp);
+	p->inner = inner;
+
+	tr->kind      = inner->kind;
+	tr->priv      = p;
+	tr->read      = rec_read;
+	tr->write     = rec_write;
+	tr->batch     = rec_batch;
+	tr->delay_ms  = rec_delay_ms;
+	tr->timestamp = rec_timestamp;
+	tr->close     = rec_close;
+	return tr;
+}
+
+/***************************************************************
+ replay
+ ***************************************************************/
+static int rep_peek(rec_priv_t* p) {
+	if (p->has_next) {
+		return 1;
+	}
+	if (fread(&p->next, sizeof p->next, 1, p->fp) != 1 ||
+	    p->next.len > REC_DATA_MAX ||
+	    fread(p->data, 1, p->next.len, p->fp) != p->next.len) {
+		return 0;
+	}
+	p->has_next = 1;
+	return 1;
+}
+
+/*
+ * Transactions are served in the recorded order, each one takes the
+ * next record; operation, device, register and length must match it,
+ * for writes the data too. A transaction off the log fails and the
+ * record is dropped, so the driver sees a bus error and moves on.
+ */
+static int rep_take(rec_priv_t* p, uint8_t op, uint8_t dev, uint8_t reg,
+                    const uint8_t* data, uint16_t len) {
+	if (!rep_peek(p)) {
+		p->errors++;
+		return 0;
+	}
+	p->has_next = 0;
+	p->ts = p->next.ts;
+	if (p->next.op != op || p->next.dev != dev || p->next.reg != reg ||
+	    p->next.len != len || (data != NULL && memcmp(data, p->data, len))) {
+		p->errors++;
+		return 0;
+	}
+	return 1;
+}
+
+static int8_t rep_read(rpi_transport_t* tr, uint8_t dev,
+                       uint8_t reg, uint8_t* data, uint16_t len) {
+	rec_priv_t* p = tr->priv;
+
+	if (!rep_take(p, REC_READ, dev, reg, NULL, len)) {
+		return RPI_TR_FAIL;
+	}
+	memcpy(data, p->data, len);
+	return p->next.status;
+}
+
+static int8_t rep_write(rpi_transport_t* tr, uint8_t dev,
+                        uint8_t reg, const uint8_t* data, uint16_t len) {
+	rec_priv_t* p = tr->priv;
+
+	if (!rep_take(p, REC_WRITE, dev, reg, data, len)) {
+		return RPI_TR_FAIL;
+	}
+	return p->next.status;
+}
+
+// no waiting, but the clock moves on until the next record sets it
+static void rep_delay_ms(rpi_transport_t* tr, uint32_t millis) {
+	rec_priv_t* p = tr->priv;
+
+	p->ts += millis * 1000000ULL;
+}
+
+static uint64_t rep_timestamp(rpi_transport_t* tr) {
+	rec_priv_t* p = tr->priv;
+
+	return p->ts;
+}
+
+rpi_transport_t* rpi_transport_replay(const char* path) {
+	rpi_transport_t* tr;
+	rec_priv_t* p;
+	char magic[8];
+
+	tr = calloc(1, sizeof *tr);
+	p = calloc(1, sizeof *p);
+	if (tr == NULL || p == NULL || (p->fp = fopen(path, "rb")) == NULL) {
+		free(tr);
+		free(p);
+		return NULL;
+	}
+	if (fread(magic, 1, 8, p->fp) != 8 || memcmp(magic, REC_MAGIC, 8)) {
+		fclose(p->fp);
+		free(tr);
+		free(p);
+		return NULL;
+	}
+
+	tr->kind      = RPI_TR_REPLAY;
+	tr->priv      = p;
+	tr->read      = rep_read;
+	tr->write     = rep_write;
+	tr->batch     = NULL;
+	tr->delay_ms  = rep_delay_ms;
+	tr->timestamp = rep_timestamp;
+	tr->close     = rec_close;
+	return tr;
+}
+
+int rpi_transport_replay_errors(rpi_transport_t* tr) {
+	rec_priv_t* p = tr->priv;
+
+	if (tr->kind != RPI_TR_REPLAY) {
+		return -1;
+	}
+	return p->errors;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Single producer single consumer ring
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_RING_H__
+#define __RPI_RING_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Lock free between exactly one producer and one consumer thread.
+ * head and tail live on their own cache lines so the two sides
+ * do not bounce one line on every element.
+ */
+typedef struct {
+	uint32_t mask;		// elements - 1, power of 2
+	uint32_t esize;		// bytes per element
+	uint8_t* buf;
+	uint32_t head __attribute__((aligned(64)));	// consumer
+	uint32_t tail __attribute__((aligned(64)));	// producer
+} rpi_ring_t;
+
+// size: elements, rounded up to a power of 2
+// return 0: OK, -1: out of memory
+static inline int rpi_ring_init(rpi_ring_t* r, uint32_t size, uint32_t esize) {
+	uint32_t n = 1;
+
+	while (n < size) {
+		n <<= 1;
+	}
+	r->mask = n - 1;
+	r->esize = esize;
+	r->head = r->tail = 0;
+	r->buf = (uint8_t*)malloc((size_t)n * esize);
+	return (r->buf == NULL)? -1: 0;
+}
+
+static inline void rpi_ring_free(rpi_ring_t* r) {
+	free(r->buf);
+	r->buf = NULL;
+}
+
+static inline uint32_t rpi_ring_count(const rpi_ring_t* r) {
+	return __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) -
+	       __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+}
+
+// producer, return 0: OK, -1: full
+static inline int rpi_ring_push(rpi_ring_t* r, const void* e) {
+	uint32_t tail = r->tail;
+
+	if (tail - __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) > r->mask) {
+		return -1;
+	}
+	memcpy(r->buf + (size_t)(tail & r->mask) * r->esize, e, r->esize);
+	__atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+// consumer, oldest element or NULL if empty, stays queued
+static inline void* rpi_ring_peek(rpi_ring_t* r) {
+	uint32_t head = r->head;
+
+	if (head == __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) {
+		return NULL;
+	}
+	return r->buf + (size_t)(head & r->mask) * r->esize;
+}
+
+// consumer, drop the element rpi_ring_peek() returned
+static inline void rpi_ring_drop(rpi_ring_t* r) {
+	__atomic_store_n(&r->head, r->head + 1, __ATOMIC_RELEASE);
+}
+
+// consumer, return 0: OK, -1: empty
+static inline int rpi_ring_pop(rpi_ring_t* r, void* e) {
+	void* p;
+
+	if ((p = rpi_ring_peek(r)) == NULL) {
+		return -1;
+	}
+	memcpy(e, p, r->esize);
+	rpi_ring_drop(r);
+	return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_RING_H__
@@ -0,0 +1,166 @@
+/*
+ * Real-time mode of acquisition threads
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "rpi_rt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NS_PER_SEC	1000000000ULL
+// buckets of a row of rpi_rt_jitter_report()
+#define REPORT_MERGE	5
+
+void rpi_rt_default(rpi_rt_cfg_t* cfg) {
+	cfg->policy = SCHED_FIFO;
+	cfg->priority = 80;
+	cfg->cpu = -1;
+	cfg->lock = 1;
+	cfg->stack = 256 * 1024;
+}
+
+// touch the stack below this frame, no page fault there later
+static void __attribute__((noinline)) stack_prefault(size_t bytes) {
+	char buf[bytes];
+
+	memset(buf, 0, bytes);
+	// keep the stores
+	__asm__ volatile("" : : "r"(buf) : "memory");
+}
+
+int rpi_rt_enter(const rpi_rt_cfg_t* cfg) {
+	struct sched_param sp;
+	int rt = 0;
+
+	if (cfg->lock) {
+		// freed heap stays mapped and locked, no mmap() per malloc()
+		mallopt(M_TRIM_THRESHOLD, -1);
+		mallopt(M_MMAP_MAX, 0);
+		if (mlockall(MCL_CURRENT | MCL_FUTURE)) {
+			rt |= RPI_RT_NO_LOCK;
+		}
+	}
+	if (cfg->stack) {
+		stack_prefault(cfg->stack);
+	}
+	if (cfg->cpu >= 0) {
+		cpu_set_t set;
+
+		CPU_ZERO(&set);
+		CPU_SET(cfg->cpu, &set);
+		if (pthread_setaffinity_np(pthread_self(), sizeof set, &set)) {
+			rt |= RPI_RT_NO_CPU;
+		}
+	}
+	// last, the steps above may fault or take locks
+	if (cfg->policy != SCHED_OTHER) {
+		memset(&sp, 0, sizeof sp);
+		sp.sched_priority = cfg->priority;
+		if (pthread_setschedparam(pthread_self(), cfg->policy, &sp)) {
+			rt |= RPI_RT_NO_SCHED;
+		}
+	}
+	return rt;
+}
+
+void rpi_rt_sleep_until(uint64_t ns) {
+	struct timespec ts;
+
+	ts.tv_sec = ns / NS_PER_SEC;
+	ts.tv_nsec = ns % NS_PER_SEC;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+uint64_t rpi_rt_jitter_quantile(const rpi_rt_jitter_t* j, double q) {
+	uint64_t sum = 0, up;
+	int i;
+
+	for (i = 0; i < RPI_RT_BUCKETS - 1; i++) {
+		sum += j->hist[i];
+		if (sum >= q * j->count) {
+			break;
+		}
+	}
+	up = (i + 1) * (uint64_t)RPI_RT_BUCKET_NS;
+	return (i < RPI_RT_BUCKETS - 1 && up < j->max)? up: j->max;
+}
+
+void rpi_rt_jitter_report(const rpi_rt_jitter_t* j, FILE* fp) {
+	uint32_t row[RPI_RT_BUCKETS / REPORT_MERGE + 1], top = 0;
+	int i, rows, last = 0;
+
+	if (j->count == 0) {
+		fprintf(fp, "no wake-ups\n");
+		return;
+	}
+	fprintf(fp, "wake-ups %llu, mean %.1f us, p50 %.1f us, p99 %.1f us, "
+		"p99.9 %.1f us, max %.1f us\n", (unsigned long long)j->count,
+		j->sum / 1000.0 / j->count,
+		rpi_rt_jitter_quantile(j, 0.50) / 1000.0,
+		rpi_rt_jitter_quantile(j, 0.99) / 1000.0,
+		rpi_rt_jitter_quantile(j, 0.999) / 1000.0,
+		j->max / 1000.0);
+
+	// REPORT_MERGE buckets a row, the open ended one a row of its own
+	rows = (RPI_RT_BUCKETS - 1) / REPORT_MERGE + 1;
+	memset(row, 0, sizeof row);
+	for (i = 0; i < RPI_RT_BUCKETS - 1; i++) {
+		row[i / REPORT_MERGE] += j->hist[i];
+	}
+	row[rows - 1] = j->hist[RPI_RT_BUCKETS - 1];
+	for (i = 0; i < rows; i++) {
+		top = (row[i] > top)? row[i]: top;
+		last = row[i]? i: last;
+	}
+	// bars of 50 columns at most, empty rows at the end left out
+	for (i = 0; i <= last; i++) {
+		int w = (int)((uint64_t)row[i] * 50 / top);
+
+		if (i == rows - 1) {
+			fprintf(fp, "   >= %3d us %10u ",
+				(RPI_RT_BUCKETS - 1) * RPI_RT_BUCKET_NS / 1000, row[i]);
+		} else {
+			fprintf(fp, "%3d - %3d us %10u ",
+				i * REPORT_MERGE * RPI_RT_BUCKET_NS / 1000,
+				(i + 1) * REPORT_MERGE * RPI_RT_BUCKET_NS / 1000, row[i]);
+		}
+		fprintf(fp, "%.*s\n", (row[i] && w == 0)? 1: w,
+			"##################################################");
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,101 @@
+/*
+ * Real-time mode of acquisition threads
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_RT_H__
+#define __RPI_RT_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <sched.h>
+
+// wake-up jitter buckets of RPI_RT_BUCKET_NS up to 200 us and one above
+#define RPI_RT_BUCKETS		101
+#define RPI_RT_BUCKET_NS	2000
+
+// rpi_rt_enter(), steps the system refused
+#define RPI_RT_NO_SCHED		0x01	// CAP_SYS_NICE or RLIMIT_RTPRIO
+#define RPI_RT_NO_CPU		0x02	// no such core
+#define RPI_RT_NO_LOCK		0x04	// CAP_IPC_LOCK or RLIMIT_MEMLOCK
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	int policy;		// SCHED_FIFO, SCHED_RR; SCHED_OTHER: unchanged
+	int priority;		// 1 .. 99 of FIFO and RR
+	int cpu;		// core to run on, -1: not pinned
+	int lock;		// mlockall() the process, no heap trimming
+	size_t stack;		// bytes of the thread stack to prefault
+} rpi_rt_cfg_t;
+
+// SCHED_FIFO 80, not pinned, memory locked, 256 KiB of stack
+void rpi_rt_default(rpi_rt_cfg_t* cfg);
+
+/*
+ * On the thread to run real-time, before its loop.
+ * Every step is tried, a refused one leaves the thread as it was.
+ * return 0: all applied, else RPI_RT_NO_* of the refused steps
+ */
+int rpi_rt_enter(const rpi_rt_cfg_t* cfg);
+
+// sleep to an absolute time of CLOCK_MONOTONIC, ns, through signals
+void rpi_rt_sleep_until(uint64_t ns);
+
+/*
+ * How late a periodic thread wakes up against its schedule,
+ * written by that thread only.
+ */
+typedef struct {
+	uint64_t count;
+	uint64_t sum;
+	uint64_t max;
+	uint32_t hist[RPI_RT_BUCKETS];
+} rpi_rt_jitter_t;
+
+static inline void rpi_rt_jitter_add(rpi_rt_jitter_t* j, uint64_t late) {
+	uint64_t k = late / RPI_RT_BUCKET_NS;
+
+	j->hist[(k < RPI_RT_BUCKETS)? k: RPI_RT_BUCKETS - 1]++;
+	j->count++;
+	j->sum += late;
+	j->max = (late > j->max)? late: j->max;
+}
+
+// upper bound of the bucket holding quantile q, at most max, ns
+uint64_t rpi_rt_jitter_quantile(const rpi_rt_jitter_t* j, double q);
+
+// percentiles and the histogram as text
+void rpi_rt_jitter_report(const rpi_rt_jitter_t* j, FILE* fp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_RT_H__
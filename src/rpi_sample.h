@@ -0,0 +1,59 @@
+/*
+ * One timestamped sample of a motion sensor
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_SAMPLE_H__
+#define __RPI_SAMPLE_H__
+
+#include <stdint.h>
+
+// rpi_sample_t.flags, what the sample carries
+#define RPI_SAMPLE_ACC		0x01
+#define RPI_SAMPLE_GYR		0x02
+#define RPI_SAMPLE_MAG		0x04
+#define RPI_SAMPLE_TEMP		0x08
+// first one after a range or rate change, the scales changed with it
+#define RPI_SAMPLE_RANGE	0x10
+
+/*
+ * Raw register values as the chip reports them, host byte order;
+ * the scale belongs to the driver's range setting.
+ */
+typedef struct {
+	uint64_t ts;		// ns, CLOCK_MONOTONIC
+	uint16_t sensor;	// index in an array, rpi_array_add()
+	uint16_t flags;		// RPI_SAMPLE_*
+	int16_t acc[3];
+	int16_t gyr[3];
+	int16_t mag[3];
+	int16_t temp;
+} rpi_sample_t;
+
+// read one sample of a device, return 0: OK, <0: error
+typedef int (*rpi_sample_fn)(void* dev, rpi_sample_t* s);
+
+#endif//__RPI_SAMPLE_H__
@@ -0,0 +1,231 @@
+/*
+ * Configuration shadow and fault recovery
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <string.h>
+#include "rpi_shadow.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void rpi_shadow_clear(rpi_shadow_t* sh) {
+	sh->count = 0;
+	sh->dirty = 0;
+}
+
+static int shadow_find(const rpi_shadow_t* sh, uint8_t reg) {
+	int i;
+
+	for (i = 0; i < sh->count; i++) {
+		if (sh->ent[i].reg == reg) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static int shadow_add(rpi_shadow_t* sh, uint8_t reg) {
+	if (sh->count >= RPI_SHADOW_MAX) {
+		return -1;
+	}
+	sh->ent[sh->count].reg = reg;
+	sh->ent[sh->count].wait = 0;
+	return sh->count++;
+}
+
+/*
+ * One batch for the registers in mask, entries following each other
+ * with consecutive addresses go out as a single auto-increment write.
+ * A register with a settle time ends the batch, the rest follows
+ * after the wait.
+ */
+static int shadow_write(const rpi_shadow_t* sh, rpi_transport_t* tr,
+                        uint8_t dev, uint32_t mask) {
+	rpi_xfer_t xfers[RPI_SHADOW_MAX];
+	uint8_t vals[RPI_SHADOW_MAX];
+	int i, rt, n = 0;
+
+	for (i = 0; i < sh->count; i++) {
+		vals[i] = sh->ent[i].val;
+		if (!(mask & (1UL << i))) {
+			continue;
+		}
+		if (n && xfers[n - 1].data + xfers[n - 1].len == &vals[i] &&
+		    xfers[n - 1].reg + xfers[n - 1].len == sh->ent[i].reg) {
+			xfers[n - 1].len++;
+		} else {
+			xfers[n].dev   = dev;
+			xfers[n].reg   = sh->ent[i].reg;
+			xfers[n].flags = RPI_XFER_WRITE;
+			xfers[n].len   = 1;
+			xfers[n].data  = &vals[i];
+			n++;
+		}
+		if (sh->ent[i].wait) {
+			if ((rt = rpi_tr_batch(tr, xfers, n)) != RPI_TR_OK) {
+				return rt;
+			}
+			rpi_tr_delay_ms(tr, sh->ent[i].wait);
+			n = 0;
+		}
+	}
+	if (n == 0) {
+		return RPI_TR_OK;
+	}
+	return rpi_tr_batch(tr, xfers, n);
+}
+
+int rpi_shadow_set(rpi_shadow_t* sh, uint8_t reg, uint8_t val) {
+	int i;
+
+	if ((i = shadow_find(sh, reg)) < 0 && (i = shadow_add(sh, reg)) < 0) {
+		return -1;
+	}
+	sh->ent[i].val = val;
+	sh->dirty &= ~(1UL << i);
+	return 0;
+}
+
+int rpi_shadow_stage(rpi_shadow_t* sh, uint8_t reg, uint8_t val) {
+	int i;
+
+	if ((i = shadow_find(sh, reg)) < 0) {
+		if ((i = shadow_add(sh, reg)) < 0) {
+			return -1;
+		}
+	} else if (sh->ent[i].val == val) {
+		return 0;
+	}
+	sh->ent[i].val = val;
+	sh->dirty |= 1UL << i;
+	return 0;
+}
+
+int rpi_shadow_bits(rpi_shadow_t* sh, uint8_t reg, uint8_t mask, uint8_t bits) {
+	uint8_t val = 0;
+
+	rpi_shadow_get(sh, reg, &val);
+	return rpi_shadow_stage(sh, reg, (val & ~mask) | (bits & mask));
+}
+
+int rpi_shadow_get(const rpi_shadow_t* sh, uint8_t reg, uint8_t* val) {
+	int i;
+
+	if ((i = shadow_find(sh, reg)) < 0) {
+		return -1;
+	}
+	*val = sh->ent[i].val;
+	return 0;
+}
+
+int rpi_shadow_wait(rpi_shadow_t* sh, uint8_t reg, uint8_t ms) {
+	int i;
+
+	if ((i = shadow_find(sh, reg)) < 0) {
+		return -1;
+	}
+	sh->ent[i].wait = ms;
+	return 0;
+}
+
+uint8_t rpi_shadow_sentinel(const rpi_shadow_t* sh, const uint8_t* regs,
+                            const uint8_t* resets, int count) {
+	uint8_t val;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (rpi_shadow_get(sh, regs[i], &val) == 0 && val != resets[i]) {
+			return regs[i];
+		}
+	}
+	return regs[0];
+}
+
+int rpi_shadow_flush(rpi_shadow_t* sh, rpi_transport_t* tr, uint8_t dev) {
+	int rt;
+
+	if ((rt = shadow_write(sh, tr, dev, sh->dirty)) == RPI_TR_OK) {
+		sh->dirty = 0;
+	}
+	return rt;
+}
+
+int rpi_shadow_replay(const rpi_shadow_t* sh, rpi_transport_t* tr, uint8_t dev) {
+	return shadow_write(sh, tr, dev, 0xFFFFFFFFUL);
+}
+
+int rpi_shadow_check(const rpi_shadow_t* sh, rpi_transport_t* tr,
+                     uint8_t dev, uint8_t reg) {
+	uint8_t val;
+	int rt;
+
+	if (rpi_shadow_get(sh, reg, &val) < 0) {
+		return 0;
+	}
+	if ((rt = rpi_tr_read_byte(tr, dev, reg)) < 0) {
+		return rt;
+	}
+	return rt != val;
+}
+
+int rpi_shadow_recover(const rpi_shadow_t* sh, rpi_transport_t* tr,
+                       uint8_t dev, uint8_t chip_reg, uint8_t chip_id,
+                       uint8_t sentinel) {
+	int status = 0;
+	int i, rt;
+
+	for (i = 0; i < RPI_RECOVER_TRIES; i++) {
+		if (i) {
+			rpi_tr_delay_ms(tr, 1);
+		}
+
+		/* bus back and the right chip answering? */
+		if (rpi_tr_read_byte(tr, dev, chip_reg) != chip_id) {
+			continue;
+		}
+
+		if ((rt = rpi_shadow_check(sh, tr, dev, sentinel)) < 0) {
+			continue;
+		}
+		if (rt == 0) {
+			/* configuration survived */
+			return status;
+		}
+
+		status |= RPI_STATUS_RESET;
+		if (rpi_shadow_replay(sh, tr, dev) == RPI_TR_OK &&
+		    rpi_shadow_check(sh, tr, dev, sentinel) == 0) {
+			return status | RPI_STATUS_RECOVERED;
+		}
+	}
+	return status | RPI_STATUS_LOST;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,120 @@
+/*
+ * Configuration shadow and fault recovery
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_SHADOW_H__
+#define __RPI_SHADOW_H__
+
+#include <stdint.h>
+#include "rpi_transport.h"
+
+// configuration registers kept per device
+#define RPI_SHADOW_MAX		24
+// attempts of rpi_shadow_recover()
+#define RPI_RECOVER_TRIES	3
+// samples between two health checks of a device
+#define RPI_CHECK_PERIOD	256
+
+// Device status, collected by the getters,
+// read and cleared by rpi_*_status()
+#define RPI_STATUS_COM_FAIL	0x01	// transaction failed, sample dropped
+#define RPI_STATUS_RESET	0x02	// chip lost its configuration
+#define RPI_STATUS_RECOVERED	0x04	// configuration applied again
+#define RPI_STATUS_LOST		0x08	// recovery failed, chip unreachable
+#define RPI_STATUS_OVERFLOW	0x10	// FIFO or data register overrun
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Register values of a device, in write order.
+ * Setters stage new values here without touching the bus,
+ * rpi_shadow_flush() then writes what changed in one batch.
+ */
+typedef struct {
+	uint8_t count;
+	uint32_t dirty;		// entries staged but not written yet
+	struct {
+		uint8_t reg;
+		uint8_t val;
+		uint8_t wait;	// ms to settle after writing reg
+	} ent[RPI_SHADOW_MAX];
+} rpi_shadow_t;
+
+void rpi_shadow_clear(rpi_shadow_t* sh);
+
+// remember a value the chip holds, return -1 if the shadow is full
+int rpi_shadow_set(rpi_shadow_t* sh, uint8_t reg, uint8_t val);
+
+// value to be written, a new register is always written
+int rpi_shadow_stage(rpi_shadow_t* sh, uint8_t reg, uint8_t val);
+
+// stage the bits in mask, the others as in the shadow (0 if unknown)
+int rpi_shadow_bits(rpi_shadow_t* sh, uint8_t reg, uint8_t mask, uint8_t bits);
+
+// return 0: found, -1: reg never written
+int rpi_shadow_get(const rpi_shadow_t* sh, uint8_t reg, uint8_t* val);
+
+// flush and replay wait ms after writing reg, return -1 if not shadowed
+int rpi_shadow_wait(rpi_shadow_t* sh, uint8_t reg, uint8_t ms);
+
+/*
+ * First of regs whose shadow value differs from its reset value,
+ * a sentinel for rpi_shadow_check() and rpi_shadow_recover().
+ * regs[0] if none does, a reset then changes nothing.
+ */
+uint8_t rpi_shadow_sentinel(const rpi_shadow_t* sh, const uint8_t* regs,
+                            const uint8_t* resets, int count);
+
+// write the staged registers in one batch
+int rpi_shadow_flush(rpi_shadow_t* sh, rpi_transport_t* tr, uint8_t dev);
+
+// write all remembered registers back in one batch
+int rpi_shadow_replay(const rpi_shadow_t* sh, rpi_transport_t* tr, uint8_t dev);
+
+// return 0: chip holds the shadow value, 1: differs, <0: bus error
+int rpi_shadow_check(const rpi_shadow_t* sh, rpi_transport_t* tr,
+                     uint8_t dev, uint8_t reg);
+
+/*
+ * After a failed transaction or a suspected chip reset.
+ *   chip_reg/chip_id: identity of the chip
+ *   sentinel: configuration register with a reset value different
+ *             from the shadow, tells if the chip was reset
+ * Bounded to RPI_RECOVER_TRIES attempts 1ms apart.
+ * return RPI_STATUS_* flags, 0 if nothing was wrong
+ */
+int rpi_shadow_recover(const rpi_shadow_t* sh, rpi_transport_t* tr,
+                       uint8_t dev, uint8_t chip_reg, uint8_t chip_id,
+                       uint8_t sentinel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_SHADOW_H__
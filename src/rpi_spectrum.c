@@ -0,0 +1,274 @@
+/*
+ * Streaming spectra of 3-axis vibration data
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "rpi_spectrum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int rpi_spectrum_init(rpi_spectrum_t* sp, int n, int hop, float fs) {
+	int m, i, j, bits;
+	size_t floats;
+	float* f;
+
+	memset(sp, 0, sizeof *sp);
+	if (n < RPI_SPECTRUM_MIN_N || n > RPI_SPECTRUM_MAX_N || (n & (n - 1)) ||
+	    hop < 1 || hop > n || fs <= 0.0f) {
+		return -1;
+	}
+	m = n / 2;
+
+	sp->n = n;
+	sp->hop = hop;
+	sp->fs = fs;
+
+	// window, twiddles, 3 frames, work
+	floats = n + n + 3 * n + n;
+	if ((f = malloc(floats * sizeof(float))) == NULL ||
+	    (sp->bitrev = malloc(m * sizeof(uint16_t))) == NULL ||
+	    (sp->acc[0] = malloc(3 * (m + 1) * sizeof(double))) == NULL) {
+		free(f);
+		free(sp->bitrev);
+		return -1;
+	}
+	sp->window  = f;
+	sp->twiddle = f + n;
+	for (i = 0; i < 3; i++) {
+		sp->frame[i] = f + 2 * n + i * n;
+	}
+	sp->work = f + 5 * n;
+	sp->acc[1] = sp->acc[0] + (m + 1);
+	sp->acc[2] = sp->acc[1] + (m + 1);
+
+	// periodic Hann
+	sp->wsum2 = 0.0f;
+	for (i = 0; i < n; i++) {
+		sp->window[i] = 0.5f - 0.5f * (float)cos(2 * M_PI * i / n);
+		sp->wsum2 += sp->window[i] * sp->window[i];
+	}
+
+	for (i = 0; i < m; i++) {
+		sp->twiddle[2 * i]     = (float)cos(2 * M_PI * i / n);
+		sp->twiddle[2 * i + 1] = (float)-sin(2 * M_PI * i / n);
+	}
+
+	for (bits = 0; (1 << bits) < m; bits++);
+	for (i = 0; i < m; i++) {
+		for (j = 0, sp->bitrev[i] = 0; j < bits; j++) {
+			sp->bitrev[i] |= ((i >> j) & 1) << (bits - 1 - j);
+		}
+	}
+
+	rpi_spectrum_clear(sp);
+	return 0;
+}
+
+void rpi_spectrum_free(rpi_spectrum_t* sp) {
+	free(sp->window);
+	free(sp->bitrev);
+	free(sp->acc[0]);
+	memset(sp, 0, sizeof *sp);
+}
+
+void rpi_spectrum_clear(rpi_spectrum_t* sp) {
+	sp->frames = 0;
+	memset(sp->acc[0], 0, 3 * (sp->n / 2 + 1) * sizeof(double));
+}
+
+/*
+ * In place radix-2 FFT of m complex values, input in bit reversed
+ * order. The twiddles of size n = 2m serve with stride 2.
+ */
+static void fft(const rpi_spectrum_t* sp, float* z, int m) {
+	const float* tw = sp->twiddle;
+	int len, half, step, i, j;
+	float wr, wi, tr, ti;
+
+	for (len = 2, step = sp->n / 2; len <= m; len <<= 1, step >>= 1) {
+		half = len / 2;
+		for (i = 0; i < m; i += len) {
+			for (j = 0; j < half; j++) {
+				float* a = z + 2 * (i + j);
+				float* b = a + 2 * half;
+
+				wr = tw[2 * j * step];
+				wi = tw[2 * j * step + 1];
+				tr = b[0] * wr - b[1] * wi;
+				ti = b[0] * wi + b[1] * wr;
+				b[0] = a[0] - tr;
+				b[1] = a[1] - ti;
+				a[0] += tr;
+				a[1] += ti;
+			}
+		}
+	}
+}
+
+/*
+ * Real frame of n samples as n/2 complex ones (even + i * odd),
+ * one FFT of n/2, then split into the n/2 + 1 bins of the real signal.
+ * The frame mean goes first, else the window smears DC (gravity)
+ * into the lowest bins.
+ */
+static void frame_power(rpi_spectrum_t* sp, const float* x, double* acc) {
+	const float* w = sp->window;
+	const float* tw = sp->twiddle;
+	float* z = sp->work;
+	int m = sp->n / 2;
+	double mean = 0.0;
+	int k, r;
+
+	for (k = 0; k < sp->n; k++) {
+		mean += x[k];
+	}
+	mean /= sp->n;
+	for (k = 0; k < m; k++) {
+		r = sp->bitrev[k];
+		z[2 * r]     = (float)(x[2 * k] - mean) * w[2 * k];
+		z[2 * r + 1] = (float)(x[2 * k + 1] - mean) * w[2 * k + 1];
+	}
+	fft(sp, z, m);
+
+	// DC and Nyquist
+	acc[0] += (double)(z[0] + z[1]) * (z[0] + z[1]);
+	acc[m] += (double)(z[0] - z[1]) * (z[0] - z[1]);
+
+	for (k = 1; k < m; k++) {
+		float ar  = z[2 * k],          ai  = z[2 * k + 1];
+		float br  = z[2 * (m - k)],    bi  = -z[2 * (m - k) + 1];
+		// even part (a + b) / 2, odd part (a - b) / 2i
+		float evr = 0.5f * (ar + br),  evi = 0.5f * (ai + bi);
+		float odr = 0.5f * (ai - bi),  odi = -0.5f * (ar - br);
+		float wr  = tw[2 * k],         wi  = tw[2 * k + 1];
+		float xr = evr + odr * wr - odi * wi;
+		float xi = evi + odr * wi + odi * wr;
+
+		acc[k] += (double)xr * xr + (double)xi * xi;
+	}
+}
+
+int rpi_spectrum_push(
+	rpi_spectrum_t* sp,
+	const float* x, const float* y, const float* z, size_t n
+) {
+	const float* in[3] = { x, y, z };
+	int a, m, added = 0;
+
+	while (n > 0) {
+		m = sp->n - sp->fill;
+		if ((size_t)m > n) {
+			m = (int)n;
+		}
+		for (a = 0; a < 3; a++) {
+			memcpy(sp->frame[a] + sp->fill, in[a], m * sizeof(float));
+			in[a] += m;
+		}
+		sp->fill += m;
+		n -= m;
+
+		if (sp->fill < sp->n) {
+			break;
+		}
+		for (a = 0; a < 3; a++) {
+			frame_power(sp, sp->frame[a], sp->acc[a]);
+			// keep the overlap for the next frame
+			memmove(sp->frame[a], sp->frame[a] + sp->hop,
+			        (sp->n - sp->hop) * sizeof(float));
+		}
+		sp->fill = sp->n - sp->hop;
+		sp->frames++;
+		added++;
+	}
+	return added;
+}
+
+int rpi_spectrum_psd(const rpi_spectrum_t* sp, int axis, float* psd) {
+	int m = sp->n / 2;
+	double norm;
+	int k;
+
+	if (sp->frames == 0 || axis < 0 || axis > 2) {
+		return 0;
+	}
+	norm = 1.0 / ((double)sp->frames * sp->fs * sp->wsum2);
+	for (k = 0; k <= m; k++) {
+		// one-sided: everything but DC and Nyquist counts twice
+		psd[k] = (float)(sp->acc[axis][k] * norm * ((k == 0 || k == m)? 1: 2));
+	}
+	return m + 1;
+}
+
+int rpi_spectrum_summary(
+	const rpi_spectrum_t* sp,
+	const float* edges, int bands,
+	rpi_spectrum_summary_t* sum
+) {
+	int m = sp->n / 2;
+	double norm, p, total;
+	int a, b, k;
+	float f;
+
+	if (sp->frames == 0 || bands < 0 || bands > RPI_SPECTRUM_MAX_BANDS) {
+		return -1;
+	}
+	memset(sum, 0, sizeof *sum);
+	sum->frames = sp->frames;
+	sum->df = sp->fs / sp->n;
+	sum->bands = bands;
+	norm = 1.0 / ((double)sp->frames * sp->fs * sp->wsum2);
+
+	for (a = 0; a < 3; a++) {
+		total = 0.0;
+		for (k = 1, b = 0; k <= m; k++) {
+			p = sp->acc[a][k] * norm * ((k == m)? 1: 2);
+			f = k * sum->df;
+			total += p;
+
+			if (p > sum->peak[a]) {
+				sum->peak[a] = (float)p;
+				sum->peak_hz[a] = f;
+			}
+			while (b < bands && f >= edges[b + 1]) {
+				b++;
+			}
+			if (b < bands && f >= edges[b]) {
+				sum->band[a][b] += (float)(p * sum->df);
+			}
+		}
+		sum->rms[a] = (float)sqrt(total * sum->df);
+	}
+	return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,117 @@
+/*
+ * Streaming spectra of 3-axis vibration data
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_SPECTRUM_H__
+#define __RPI_SPECTRUM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// frame size, power of 2
+#define RPI_SPECTRUM_MIN_N	16
+#define RPI_SPECTRUM_MAX_N	8192
+#define RPI_SPECTRUM_MAX_BANDS	8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Welch estimate over Hann windowed frames of n samples,
+ * a new frame every hop samples (hop = n / 2: 50% overlap).
+ * Each frame has its mean removed, DC does not show in the bins.
+ * Every table and buffer is allocated once by rpi_spectrum_init().
+ */
+typedef struct {
+	int n;
+	int hop;
+	float fs;		// sample rate, Hz
+	int fill;		// samples in frame[]
+	uint32_t frames;	// frames averaged so far
+
+	float* window;
+	float wsum2;		// sum of window^2
+	float* twiddle;		// n/2 complex, exp(-2 pi i k / n)
+	uint16_t* bitrev;	// n/2
+	float* frame[3];	// last n samples per axis
+	float* work;		// n floats, complex n/2
+	double* acc[3];		// n/2 + 1 sums of |X|^2 per axis
+} rpi_spectrum_t;
+
+// what a node ships per averaging period, per axis
+typedef struct {
+	uint32_t frames;
+	float df;				// Hz per bin
+	float rms[3];				// without DC
+	float peak_hz[3];			// strongest bin
+	float peak[3];				// its PSD
+	uint8_t bands;
+	float band[3][RPI_SPECTRUM_MAX_BANDS];	// energy, units^2
+} rpi_spectrum_summary_t;
+
+// return 0: OK, -1: bad parameters or out of memory
+int rpi_spectrum_init(rpi_spectrum_t* sp, int n, int hop, float fs);
+
+void rpi_spectrum_free(rpi_spectrum_t* sp);
+
+// start a new average, samples already buffered are kept
+void rpi_spectrum_clear(rpi_spectrum_t* sp);
+
+/*
+ * Feed n samples per axis, eg. from rpi_convert_s16x3(),
+ * transforms every complete frame.
+ * return frames added
+ */
+int rpi_spectrum_push(
+	rpi_spectrum_t* sp,
+	const float* x, const float* y, const float* z, size_t n
+);
+
+/*
+ * One-sided PSD of an axis, units^2/Hz, n/2 + 1 bins of fs/n Hz
+ * return bins written, 0 before the first frame
+ */
+int rpi_spectrum_psd(const rpi_spectrum_t* sp, int axis, float* psd);
+
+/*
+ * Compact features of the current average.
+ *   edges: bands + 1 ascending frequencies in Hz,
+ *          band i is edges[i] <= f < edges[i + 1]
+ * return 0: OK, -1: no frame yet or too many bands
+ */
+int rpi_spectrum_summary(
+	const rpi_spectrum_t* sp,
+	const float* edges, int bands,
+	rpi_spectrum_summary_t* sum
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_SPECTRUM_H__
@@ -0,0 +1,266 @@
+/*
+ * SPI interface to access spidev
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#define _DEBUG	0
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/spi/spidev.h>
+#include "rpi_spi.h"
+#include "rpi_transport.h"
+#include "rpi_trace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPI_READ_BIT	0x80
+#define SPI_MAX_DUMMY	4
+
+static struct {
+	int fd;
+	uint32_t speed_hz;
+	uint8_t dummy;
+	// rpi_spi_init_emu()
+	rpi_transport_t* emu;
+	uint8_t emu_dev;
+	uint8_t emu_dummy;
+} rpi_spi_devs[RPI_SPI_MAX_DEV] = {
+	[0 ... RPI_SPI_MAX_DEV - 1] = { -1, 0, 0, NULL, 0, 0 },
+};
+
+static int spi_slot(void) {
+	int id;
+
+	for (id = 0; id < RPI_SPI_MAX_DEV; id++) {
+		if (rpi_spi_devs[id].fd < 0) {
+			return id;
+		}
+	}
+	printf("Too many spi devices opened\n");
+	return RPI_SPI_FAIL;
+}
+
+int rpi_spi_init(const char* dev_path, uint32_t speed_hz, uint8_t mode) {
+	uint8_t bits = 8;
+	int fd, id;
+
+	if ((id = spi_slot()) < 0) {
+		return RPI_SPI_FAIL;
+	}
+
+	if ((fd = open(dev_path, O_RDWR)) < 0) {
+		printf("Failed to open spi bus %s, error = %d\n",
+		       dev_path, fd);
+		return RPI_SPI_FAIL;
+	}
+
+	if (ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+	    ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+	    ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed_hz) < 0) {
+		printf("Failed to setup spi bus %s\n", dev_path);
+		close(fd);
+		return RPI_SPI_FAIL;
+	}
+
+	rpi_spi_devs[id].fd = fd;
+	rpi_spi_devs[id].speed_hz = speed_hz;
+	rpi_spi_devs[id].dummy = 0;
+	rpi_spi_devs[id].emu = NULL;
+	return id;
+}
+
+int rpi_spi_init_emu(rpi_transport_t* emu, uint8_t dev, uint8_t chip_dummy) {
+	int id;
+
+	if (emu == NULL || emu->kind != RPI_TR_EMU || chip_dummy > SPI_MAX_DUMMY ||
+	    (id = spi_slot()) < 0) {
+		return RPI_SPI_FAIL;
+	}
+	// marks the slot taken, never used for ioctl
+	if ((rpi_spi_devs[id].fd = open("/dev/null", O_RDWR)) < 0) {
+		return RPI_SPI_FAIL;
+	}
+	rpi_spi_devs[id].speed_hz = 0;
+	rpi_spi_devs[id].dummy = 0;
+	rpi_spi_devs[id].emu = emu;
+	rpi_spi_devs[id].emu_dev = dev;
+	rpi_spi_devs[id].emu_dummy = chip_dummy;
+	return id;
+}
+
+/*
+ * The message as the emulated chip sees it: address, then its
+ * dummy bytes and registers on MISO for a read, MOSI into the
+ * registers for a write.
+ */
+static int spi_emu_xfer(
+	uint8_t id,
+	const uint8_t* head, uint8_t* head_rx, uint16_t head_len,
+	const uint8_t* tx, uint8_t* rx, uint16_t len
+) {
+	uint8_t miso[1 + 2 * SPI_MAX_DUMMY + 256], mosi[SPI_MAX_DUMMY + 256];
+	rpi_transport_t* emu = rpi_spi_devs[id].emu;
+	uint8_t dev = rpi_spi_devs[id].emu_dev, reg = head[0] & ~SPI_READ_BIT;
+	int n = head_len + len, skip = 1 + rpi_spi_devs[id].emu_dummy;
+
+	if (n > (int)sizeof mosi) {
+		return RPI_SPI_FAIL;
+	}
+	if (!(head[0] & SPI_READ_BIT)) {
+		memcpy(mosi, head + 1, head_len - 1);
+		memcpy(mosi + head_len - 1, tx, len);
+		return rpi_tr_write(emu, dev, reg, mosi, n - 1) < 0? RPI_SPI_FAIL: RPI_SPI_OK;
+	}
+	memset(miso, 0xFF, skip);
+	if (n > skip && rpi_tr_read(emu, dev, reg, miso + skip, n - skip) < 0) {
+		return RPI_SPI_FAIL;
+	}
+	if (head_rx != NULL) {
+		memcpy(head_rx, miso, head_len);
+	}
+	if (rx != NULL) {
+		memcpy(rx, miso + head_len, len);
+	}
+	return RPI_SPI_OK;
+}
+
+int rpi_spi_close(uint8_t id) {
+	if (id >= RPI_SPI_MAX_DEV || rpi_spi_devs[id].fd < 0) {
+		return RPI_SPI_FAIL;
+	}
+	close(rpi_spi_devs[id].fd);
+	rpi_spi_devs[id].fd = -1;
+	rpi_spi_devs[id].emu = NULL;
+	return RPI_SPI_OK;
+}
+
+int rpi_spi_set_dummy(uint8_t id, uint8_t dummy) {
+	if (id >= RPI_SPI_MAX_DEV || dummy > SPI_MAX_DUMMY) {
+		return RPI_SPI_FAIL;
+	}
+	rpi_spi_devs[id].dummy = dummy;
+	return RPI_SPI_OK;
+}
+
+/*
+ * Two transfers in one message, chip select held between them:
+ *   [0] address (+ dummy bytes)
+ *   [1] payload, straight from/into the caller buffer
+ */
+static int spi_xfer2(
+	uint8_t id,
+	const uint8_t* head, uint8_t* head_rx, uint16_t head_len,
+	const uint8_t* tx, uint8_t* rx, uint16_t len
+) {
+	struct spi_ioc_transfer xfer[2];
+	int rt;
+
+	if (id >= RPI_SPI_MAX_DEV || rpi_spi_devs[id].fd < 0) {
+		return RPI_SPI_FAIL;
+	}
+	if (rpi_spi_devs[id].emu != NULL) {
+		return spi_emu_xfer(id, head, head_rx, head_len, tx, rx, len);
+	}
+
+	memset(xfer, 0, sizeof xfer);
+	xfer[0].tx_buf = (unsigned long)head;
+	xfer[0].rx_buf = (unsigned long)head_rx;
+	xfer[0].len = head_len;
+	xfer[0].speed_hz = rpi_spi_devs[id].speed_hz;
+	xfer[0].bits_per_word = 8;
+
+	xfer[1].tx_buf = (unsigned long)tx;
+	xfer[1].rx_buf = (unsigned long)rx;
+	xfer[1].len = len;
+	xfer[1].speed_hz = rpi_spi_devs[id].speed_hz;
+	xfer[1].bits_per_word = 8;
+
+	RPI_TRACE_BEGIN(RPI_TRACE_XFER);
+	if ((rt = ioctl(rpi_spi_devs[id].fd, SPI_IOC_MESSAGE(2), xfer)) < 0) {
+		RPI_TRACE_END(RPI_TRACE_XFER);
+		printf("Failed to transfer spi %u bytes with error = %d.\n",
+		       head_len + len, rt);
+		return RPI_SPI_FAIL;
+	}
+	RPI_TRACE_END(RPI_TRACE_XFER);
+	return RPI_SPI_OK;
+}
+
+// return none-zero = FAIL
+//        zero      = OK
+int8_t rpi_spi_read(uint8_t id, uint8_t reg_addr, uint8_t *data, uint16_t len) {
+	uint8_t head[1 + SPI_MAX_DUMMY] = { 0 };
+	uint8_t head_rx[1 + SPI_MAX_DUMMY];
+
+	if (id >= RPI_SPI_MAX_DEV) {
+		return RPI_SPI_FAIL;
+	}
+
+	#if _DEBUG
+	fprintf(stderr, "spi: %u reg: 0x%02X len: %u\n", id, reg_addr, len);
+	#endif
+
+	head[0] = reg_addr | SPI_READ_BIT;
+	return spi_xfer2(id, head, head_rx, 1 + rpi_spi_devs[id].dummy,
+	                 NULL, data, len);
+}
+
+// return none-zero = FAIL
+//        zero      = OK
+int8_t rpi_spi_write(uint8_t id, uint8_t reg_addr, uint8_t *data, uint16_t len) {
+	reg_addr &= ~SPI_READ_BIT;
+	return spi_xfer2(id, &reg_addr, NULL, 1, data, NULL, len);
+}
+
+int rpi_spi_transfer(uint8_t id, const uint8_t* tx, uint8_t* rx, uint16_t len) {
+	struct spi_ioc_transfer xfer;
+
+	if (id >= RPI_SPI_MAX_DEV || rpi_spi_devs[id].fd < 0 ||
+	    rpi_spi_devs[id].emu != NULL) {
+		return RPI_SPI_FAIL;
+	}
+
+	memset(&xfer, 0, sizeof xfer);
+	xfer.tx_buf = (unsigned long)tx;
+	xfer.rx_buf = (unsigned long)rx;
+	xfer.len = len;
+	xfer.speed_hz = rpi_spi_devs[id].speed_hz;
+	xfer.bits_per_word = 8;
+
+	if (ioctl(rpi_spi_devs[id].fd, SPI_IOC_MESSAGE(1), &xfer) < 0) {
+		return RPI_SPI_FAIL;
+	}
+	return RPI_SPI_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
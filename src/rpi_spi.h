@@ -0,0 +1,82 @@
+/*
+ * SPI interface to access spidev
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __spi_rpi_h__
+#define __spi_rpi_h__
+
+#include <stdint.h>
+
+#define RPI_SPI_OK	0
+#define RPI_SPI_FAIL	-1
+
+// at most chip selects opened at the same time
+#define RPI_SPI_MAX_DEV	8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// return >=0: id, the dev_addr of rpi_spi_read/rpi_spi_write
+//         <0: error
+int rpi_spi_init(
+	/* eg. /dev/spidev0.0 */
+	const char* dev_path,
+	/* up to 10000000 for BMI088 */
+	uint32_t speed_hz,
+	/* SPI_MODE_0 or SPI_MODE_3, | SPI_LOOP for loopback testing */
+	uint8_t mode
+);
+int rpi_spi_close(uint8_t id);
+
+struct rpi_transport;
+
+/*
+ * A chip select on device dev of an emulator transport instead of a
+ * spidev, for tests: the chip clocks chip_dummy bytes of 0xFF between
+ * the address and the register data on read, as the BMI088 accel.
+ * return >=0: id, <0: error
+ */
+int rpi_spi_init_emu(struct rpi_transport* emu, uint8_t dev, uint8_t chip_dummy);
+
+// Bytes clocked out between the address and the data on read,
+// BMI088 accel returns one dummy byte in SPI mode.
+int rpi_spi_set_dummy(uint8_t id, uint8_t dummy);
+
+// Register access, bit7 of reg_addr is the read flag.
+// Same prototype as rpi_i2c_read/rpi_i2c_write.
+int8_t rpi_spi_read(uint8_t id, uint8_t reg_addr, uint8_t *data, uint16_t len);
+int8_t rpi_spi_write(uint8_t id, uint8_t reg_addr, uint8_t *data, uint16_t len);
+
+// one raw full-duplex transfer, tx or rx can be NULL
+int rpi_spi_transfer(uint8_t id, const uint8_t* tx, uint8_t* rx, uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__spi_rpi_h__
@@ -0,0 +1,104 @@
+/*
+ * Asynchronous startup of several sensors
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "rpi_startup.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NS_PER_MS	1000000ULL
+
+int rpi_startup_run(rpi_startup_t* jobs, int count) {
+	rpi_startup_t* next;
+	uint64_t now, left, wait;
+	int active = count, failed = 0;
+	int i, ms;
+
+	for (i = 0; i < count; i++) {
+		jobs[i].due = 0;
+	}
+
+	while (active > 0) {
+		next = NULL;
+		wait = UINT64_MAX;
+
+		for (i = 0; i < count; i++) {
+			rpi_startup_t* job = &jobs[i];
+
+			if (job->state == RPI_STARTUP_DONE) {
+				continue;
+			}
+
+			now = rpi_tr_timestamp(job->tr);
+			if (now >= job->due) {
+				if ((ms = job->step(job)) == RPI_STARTUP_DONE) {
+					job->state = RPI_STARTUP_DONE;
+					failed += (job->rt < 0);
+					active--;
+					continue;
+				}
+				now = rpi_tr_timestamp(job->tr);
+				job->due = now + ms * NS_PER_MS;
+			}
+
+			left = (job->due > now)? job->due - now: 0;
+			if (left < wait) {
+				wait = left;
+				next = job;
+			}
+		}
+
+		// nobody ready, sleep until the earliest one is
+		if (next != NULL && wait > 0) {
+			rpi_tr_delay_ms(next->tr, (wait + NS_PER_MS - 1) / NS_PER_MS);
+		}
+	}
+	return failed;
+}
+
+int rpi_startup_poll(rpi_startup_t* job) {
+	int ms;
+
+	if (job->state == RPI_STARTUP_DONE) {
+		return 0;
+	}
+	if (rpi_tr_timestamp(job->tr) < job->due) {
+		return 1;
+	}
+	if ((ms = job->step(job)) == RPI_STARTUP_DONE) {
+		job->state = RPI_STARTUP_DONE;
+		return 0;
+	}
+	job->due = rpi_tr_timestamp(job->tr) + ms * NS_PER_MS;
+	return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,83 @@
+/*
+ * Asynchronous startup of several sensors
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_STARTUP_H__
+#define __RPI_STARTUP_H__
+
+#include <stdint.h>
+#include "rpi_transport.h"
+
+// returned by a step when the device is up, or gave up
+#define RPI_STARTUP_DONE	(-1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Startup of one device, split where the datasheet asks for a wait.
+ * The step function issues the commands of job->state and returns
+ * the milliseconds to wait before the next step, or RPI_STARTUP_DONE
+ * with the result of the blocking init in job->rt.
+ *
+ * Filled in by rpi_*_startup() of the drivers; the configuration
+ * pointed to by cfg[] must stay valid until rpi_startup_run() returns.
+ */
+typedef struct rpi_startup rpi_startup_t;
+struct rpi_startup {
+	int (*step)(rpi_startup_t* job);
+	void* dev;
+	rpi_transport_t* tr;	// clock of the waits
+	const void* cfg[2];
+	int state;
+	int rt;
+	uint64_t due;		// ns, on tr's clock
+};
+
+/*
+ * Run all jobs interleaved: whenever a device has to wait, the
+ * others on any bus go on, so the power-up delays overlap and the
+ * whole set is up after about the longest single startup.
+ * Jobs should share one clock, real transports all do.
+ * return the number of jobs with job->rt < 0
+ */
+int rpi_startup_run(rpi_startup_t* jobs, int count);
+
+/*
+ * The next step of job when due, never waits: for jobs that run
+ * beside streaming, eg. self-tests, from the caller's own loop.
+ * job->due 0 starts at once.
+ * return 1: running, 0: done, result in job->rt
+ */
+int rpi_startup_poll(rpi_startup_t* job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_STARTUP_H__
@@ -0,0 +1,148 @@
+/*
+ * Temperature compensation of bias and scale
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <string.h>
+#include <math.h>
+#include "rpi_tcomp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static float poly(const float* c, int order, float x) {
+	float y = 0.0f;
+	int k;
+
+	// Horner
+	for (k = order; k >= 0; k--) {
+		y = y * x + c[k];
+	}
+	return y;
+}
+
+int rpi_tcomp_lut_init(rpi_tcomp_t* tc, float t0, float dt, int points) {
+	// also rejects NaN
+	if (!(dt > 0.0f) || points < 2 || points > RPI_TCOMP_POINTS) {
+		return -1;
+	}
+	memset(tc, 0, sizeof *tc);
+	tc->type = RPI_TCOMP_LUT;
+	tc->points = points;
+	tc->t0 = t0;
+	tc->dt = dt;
+	return 0;
+}
+
+void rpi_tcomp_eval(const rpi_tcomp_t* tc, float t, float bias[3], float gain[3]) {
+	float pos, frac;
+	int a, i;
+
+	if (tc->type == RPI_TCOMP_POLY) {
+		for (a = 0; a < 3; a++) {
+			bias[a] = poly(tc->bias[a], tc->order, t - tc->t_ref);
+			gain[a] = poly(tc->gain[a], tc->order, t - tc->t_ref);
+		}
+		return;
+	}
+
+	// a table filled by hand without rpi_tcomp_lut_init(): first point
+	pos = (tc->dt > 0.0f)? (t - tc->t0) / tc->dt: 0.0f;
+	if (pos <= 0.0f || tc->points < 2) {
+		i = 0;
+		frac = 0.0f;
+	} else if (pos >= tc->points - 1) {
+		i = tc->points - 2;
+		frac = 1.0f;
+	} else {
+		i = (int)pos;
+		frac = pos - i;
+	}
+	for (a = 0; a < 3; a++) {
+		bias[a] = tc->lut_bias[i][a] + frac * (tc->lut_bias[i + 1][a] - tc->lut_bias[i][a]);
+		gain[a] = tc->lut_gain[i][a] + frac * (tc->lut_gain[i + 1][a] - tc->lut_gain[i][a]);
+	}
+}
+
+void rpi_tcomp_apply(const rpi_tcomp_t* tc, float t, double v[3]) {
+	float bias[3], gain[3];
+	int a;
+
+	rpi_tcomp_eval(tc, t, bias, gain);
+	for (a = 0; a < 3; a++) {
+		v[a] = (v[a] - bias[a]) * (1.0 + gain[a]);
+	}
+}
+
+void rpi_tconvert_init(
+	rpi_tconvert_t* tcv,
+	const rpi_tcomp_t* tc,
+	const float scale[3],
+	const float offset[3],
+	const float align[9]
+) {
+	static const float identity[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+
+	tcv->tc = tc;
+	memcpy(tcv->scale, scale, sizeof tcv->scale);
+	if (offset != NULL) {
+		memcpy(tcv->offset, offset, sizeof tcv->offset);
+	} else {
+		memset(tcv->offset, 0, sizeof tcv->offset);
+	}
+	memcpy(tcv->align, (align != NULL)? align: identity, sizeof tcv->align);
+
+	// build it on the first rpi_tconvert_at()
+	tcv->t = NAN;
+	rpi_convert_init(&tcv->cv, tcv->scale, tcv->offset, tcv->align);
+}
+
+const rpi_convert_t* rpi_tconvert_at(rpi_tconvert_t* tcv, float t) {
+	float bias[3], gain[3], scale[3], offset[3];
+	int a;
+
+	if (tcv->tc == NULL || fabsf(t - tcv->t) < RPI_TCOMP_STEP) {
+		return &tcv->cv;
+	}
+
+	/*
+	 * (r * scale + offset - bias) * (1 + gain)
+	 *   = r * scale * (1 + gain) + (offset - bias) * (1 + gain)
+	 */
+	rpi_tcomp_eval(tcv->tc, t, bias, gain);
+	for (a = 0; a < 3; a++) {
+		scale[a]  = tcv->scale[a] * (1.0f + gain[a]);
+		offset[a] = (tcv->offset[a] - bias[a]) * (1.0f + gain[a]);
+	}
+	rpi_convert_init(&tcv->cv, scale, offset, tcv->align);
+	tcv->t = t;
+	return &tcv->cv;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,115 @@
+/*
+ * Temperature compensation of bias and scale
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_TCOMP_H__
+#define __RPI_TCOMP_H__
+
+#include <stdint.h>
+#include "rpi_convert.h"
+
+// rpi_tcomp_t.type
+#define RPI_TCOMP_POLY		0
+#define RPI_TCOMP_LUT		1
+
+#define RPI_TCOMP_ORDER		3	// highest polynomial degree
+#define RPI_TCOMP_POINTS	16	// lookup table size
+
+// drivers sample the temperature this often, ns
+#define RPI_TEMP_PERIOD		1000000000ULL
+// rpi_tconvert_at() rebuilds the conversion on this change, centigrade
+#define RPI_TCOMP_STEP		0.1f
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Per device and sensor, from a temperature sweep:
+ *     true = (measured - bias(t)) * (1 + gain(t))
+ * bias in output units (mg, dps), gain relative.
+ *   POLY: sum of c[k] * (t - t_ref)^k, k = 0..order
+ *   LUT:  points t0 + i * dt, linear in between, clamped outside
+ */
+typedef struct {
+	int type;
+	// POLY
+	int order;
+	float t_ref;
+	float bias[3][RPI_TCOMP_ORDER + 1];
+	float gain[3][RPI_TCOMP_ORDER + 1];
+	// LUT
+	int points;
+	float t0;
+	float dt;
+	float lut_bias[RPI_TCOMP_POINTS][3];
+	float lut_gain[RPI_TCOMP_POINTS][3];
+} rpi_tcomp_t;
+
+/*
+ * An empty LUT of points entries from t0 every dt, bias and gain 0,
+ * the caller fills lut_bias[] and lut_gain[].
+ * return 0: OK, -1: dt not > 0 or points not in 2..RPI_TCOMP_POINTS
+ */
+int rpi_tcomp_lut_init(rpi_tcomp_t* tc, float t0, float dt, int points);
+
+// bias and gain of every axis at t
+void rpi_tcomp_eval(const rpi_tcomp_t* tc, float t, float bias[3], float gain[3]);
+
+// compensate one converted sample in place
+void rpi_tcomp_apply(const rpi_tcomp_t* tc, float t, double v[3]);
+
+/*
+ * Compensation folded into the batch conversion: bias and gain
+ * become part of rpi_convert_t, so the kernels cost the same.
+ */
+typedef struct {
+	const rpi_tcomp_t* tc;
+	float scale[3];
+	float offset[3];
+	float align[9];
+	float t;		// temperature cv is built for
+	rpi_convert_t cv;
+} rpi_tconvert_t;
+
+// same arguments as rpi_convert_init()
+void rpi_tconvert_init(
+	rpi_tconvert_t* tcv,
+	const rpi_tcomp_t* tc,
+	const float scale[3],
+	const float offset[3],
+	const float align[9]
+);
+
+// conversion for temperature t, rebuilt only when t moved
+const rpi_convert_t* rpi_tconvert_at(rpi_tconvert_t* tcv, float t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_TCOMP_H__
@@ -0,0 +1,266 @@
+/*
+ * Pipeline latency tracing
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rpi_trace.h"
+#include "rpi_transport.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if RPI_TRACE
+
+static const char* stage_names[RPI_TRACE_STAGES] = {
+	"wake", "xfer", "decode", "enqueue", "dequeue", "convert",
+};
+
+typedef struct {
+	uint64_t ts;
+	uint64_t dur;
+	uint32_t stage;
+} trace_event_t;
+
+/*
+ * One per thread, written by that thread only: events are
+ * published by the release store of count, histograms are
+ * plain counters read relaxed. Kept after the thread exits,
+ * for the export.
+ */
+typedef struct trace_buf {
+	struct trace_buf* next;
+	int tid;
+	char name[16];
+	uint32_t count;
+	uint64_t begin[RPI_TRACE_STAGES];
+	uint64_t hist[RPI_TRACE_STAGES][RPI_TRACE_BUCKETS];
+	uint64_t max[RPI_TRACE_STAGES];
+	trace_event_t ev[RPI_TRACE_EVENTS];
+} trace_buf_t;
+
+static trace_buf_t* trace_list;
+static int trace_tids;
+static __thread trace_buf_t* trace_self;
+
+static trace_buf_t* trace_buf(void) {
+	trace_buf_t* b;
+
+	if ((b = trace_self) != NULL) {
+		return b;
+	}
+	// first event of the thread, the only allocation
+	if ((b = calloc(1, sizeof *b)) == NULL) {
+		return NULL;
+	}
+	b->tid = __atomic_add_fetch(&trace_tids, 1, __ATOMIC_RELAXED);
+	snprintf(b->name, sizeof b->name, "thread %d", b->tid);
+	b->next = __atomic_load_n(&trace_list, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&trace_list, &b->next, b, 1,
+	                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+	}
+	return trace_self = b;
+}
+
+static inline int trace_bucket(uint64_t ns) {
+	int b;
+
+	if (ns < 2) {
+		return 0;
+	}
+	b = 63 - __builtin_clzll(ns);
+	return b < RPI_TRACE_BUCKETS? b: RPI_TRACE_BUCKETS - 1;
+}
+
+static void trace_record(trace_buf_t* b, int stage, uint64_t ts, uint64_t dur) {
+	uint64_t* h = &b->hist[stage][trace_bucket(dur)];
+	uint32_t n = b->count;
+
+	__atomic_store_n(h, *h + 1, __ATOMIC_RELAXED);
+	if (dur > b->max[stage]) {
+		__atomic_store_n(&b->max[stage], dur, __ATOMIC_RELAXED);
+	}
+	if (n < RPI_TRACE_EVENTS) {
+		b->ev[n].ts = ts;
+		b->ev[n].dur = dur;
+		b->ev[n].stage = stage;
+		__atomic_store_n(&b->count, n + 1, __ATOMIC_RELEASE);
+	}
+}
+
+void rpi_trace_begin(int stage) {
+	trace_buf_t* b;
+
+	if ((b = trace_buf()) != NULL) {
+		b->begin[stage] = rpi_time_ns();
+	}
+}
+
+void rpi_trace_end(int stage) {
+	trace_buf_t* b;
+	uint64_t now = rpi_time_ns();
+
+	if ((b = trace_buf()) == NULL || b->begin[stage] == 0) {
+		return;
+	}
+	trace_record(b, stage, b->begin[stage], now - b->begin[stage]);
+	b->begin[stage] = 0;
+}
+
+void rpi_trace_span(int stage, uint64_t start_ns, uint64_t end_ns) {
+	trace_buf_t* b;
+
+	// another clock, eg. CLOCK_REALTIME edges of old kernels
+	if (start_ns == 0 || start_ns > end_ns) {
+		return;
+	}
+	if ((b = trace_buf()) != NULL) {
+		trace_record(b, stage, start_ns, end_ns - start_ns);
+	}
+}
+
+void rpi_trace_thread(const char* name) {
+	trace_buf_t* b;
+
+	if ((b = trace_buf()) != NULL) {
+		snprintf(b->name, sizeof b->name, "%s", name);
+	}
+}
+
+int rpi_trace_export(const char* path) {
+	trace_buf_t* b;
+	trace_event_t* e;
+	const char* sep = "";
+	uint32_t i, n;
+	FILE* fp;
+
+	if ((fp = fopen(path, "w")) == NULL) {
+		return -1;
+	}
+	fprintf(fp, "{\"traceEvents\":[\n");
+	for (b = __atomic_load_n(&trace_list, __ATOMIC_ACQUIRE); b; b = b->next) {
+		fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+			"\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+			sep, b->tid, b->name);
+		sep = ",\n";
+
+		n = __atomic_load_n(&b->count, __ATOMIC_ACQUIRE);
+		for (i = 0; i < n; i++) {
+			e = &b->ev[i];
+			// microseconds
+			fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"rpi\",\"ph\":\"X\","
+				"\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+				stage_names[e->stage], e->ts / 1000.0,
+				e->dur / 1000.0, b->tid);
+		}
+	}
+	fprintf(fp, "\n],\"displayTimeUnit\":\"ns\"}\n");
+	return fclose(fp) == 0? 0: -1;
+}
+
+void rpi_trace_hist(int stage, uint64_t hist[RPI_TRACE_BUCKETS]) {
+	trace_buf_t* b;
+	int i;
+
+	memset(hist, 0, RPI_TRACE_BUCKETS * sizeof hist[0]);
+	for (b = __atomic_load_n(&trace_list, __ATOMIC_ACQUIRE); b; b = b->next) {
+		for (i = 0; i < RPI_TRACE_BUCKETS; i++) {
+			hist[i] += __atomic_load_n(&b->hist[stage][i], __ATOMIC_RELAXED);
+		}
+	}
+}
+
+// upper bound of the bucket holding quantile q, ns
+static uint64_t hist_quantile(const uint64_t* hist, uint64_t total,
+                              uint64_t max, double q) {
+	uint64_t sum = 0;
+	int i;
+
+	for (i = 0; i < RPI_TRACE_BUCKETS - 1; i++) {
+		sum += hist[i];
+		if (sum >= q * total) {
+			break;
+		}
+	}
+	return (2ULL << i) < max? (2ULL << i): max;
+}
+
+void rpi_trace_report(FILE* fp) {
+	uint64_t hist[RPI_TRACE_BUCKETS];
+	uint64_t total, max;
+	trace_buf_t* b;
+	int s, i;
+
+	fprintf(fp, "%-8s %10s %10s %10s %10s\n",
+		"stage", "count", "p50(us)", "p99(us)", "max(us)");
+	for (s = 0; s < RPI_TRACE_STAGES; s++) {
+		rpi_trace_hist(s, hist);
+		for (i = 0, total = 0; i < RPI_TRACE_BUCKETS; i++) {
+			total += hist[i];
+		}
+		if (total == 0) {
+			continue;
+		}
+		max = 0;
+		for (b = __atomic_load_n(&trace_list, __ATOMIC_ACQUIRE); b; b = b->next) {
+			uint64_t m = __atomic_load_n(&b->max[s], __ATOMIC_RELAXED);
+
+			max = m > max? m: max;
+		}
+		// percentiles to the power of 2 above, at most max
+		fprintf(fp, "%-8s %10llu %10.1f %10.1f %10.1f\n", stage_names[s],
+			(unsigned long long)total,
+			hist_quantile(hist, total, max, 0.50) / 1000.0,
+			hist_quantile(hist, total, max, 0.99) / 1000.0,
+			max / 1000.0);
+	}
+}
+
+#else
+
+void rpi_trace_thread(const char* name) {
+}
+
+int rpi_trace_export(const char* path) {
+	return -1;
+}
+
+void rpi_trace_hist(int stage, uint64_t hist[RPI_TRACE_BUCKETS]) {
+	memset(hist, 0, RPI_TRACE_BUCKETS * sizeof hist[0]);
+}
+
+void rpi_trace_report(FILE* fp) {
+	fprintf(fp, "tracing not built in, make TRACE=1\n");
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Pipeline latency tracing
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_TRACE_H__
+#define __RPI_TRACE_H__
+
+#include <stdio.h>
+#include <stdint.h>
+
+// build with make TRACE=1, otherwise every hook is empty
+#ifndef RPI_TRACE
+#define RPI_TRACE		0
+#endif
+
+// stages of a sample, data ready to consumer
+#define RPI_TRACE_WAKE		0	// interrupt or poll wake up
+#define RPI_TRACE_XFER		1	// bus transaction
+#define RPI_TRACE_DECODE	2	// registers to rpi_sample_t
+#define RPI_TRACE_ENQUEUE	3	// into a ring
+#define RPI_TRACE_DEQUEUE	4	// sample timestamp to consumer
+#define RPI_TRACE_CONVERT	5	// raw to units
+#define RPI_TRACE_STAGES	6
+
+// events kept per thread, later ones only go to the histograms
+#define RPI_TRACE_EVENTS	32768
+// histogram bucket b: [2^b, 2^(b+1)) ns
+#define RPI_TRACE_BUCKETS	32
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if RPI_TRACE
+void rpi_trace_begin(int stage);
+void rpi_trace_end(int stage);
+// a stage timed by the caller, eg. from a kernel or sample timestamp
+void rpi_trace_span(int stage, uint64_t start_ns, uint64_t end_ns);
+
+#define RPI_TRACE_BEGIN(stage)		rpi_trace_begin(stage)
+#define RPI_TRACE_END(stage)		rpi_trace_end(stage)
+#define RPI_TRACE_SPAN(stage, t0, t1)	rpi_trace_span(stage, t0, t1)
+#else
+#define RPI_TRACE_BEGIN(stage)		((void)0)
+#define RPI_TRACE_END(stage)		((void)0)
+#define RPI_TRACE_SPAN(stage, t0, t1)	((void)0)
+#endif
+
+// name of the calling thread in the trace
+void rpi_trace_thread(const char* name);
+
+/*
+ * Events of all threads as Chrome trace JSON,
+ * for chrome://tracing or ui.perfetto.dev.
+ * return 0: OK, <0: error or tracing not built in
+ */
+int rpi_trace_export(const char* path);
+
+// durations of a stage over all threads
+void rpi_trace_hist(int stage, uint64_t hist[RPI_TRACE_BUCKETS]);
+
+// count and percentiles of every stage
+void rpi_trace_report(FILE* fp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_TRACE_H__
@@ -0,0 +1,312 @@
+/*
+ * Bus transport interface shared by all drivers
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#define _DEBUG	0
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "rpi_transport.h"
+#include "rpi_spi.h"
+#include "rpi_trace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// data bytes of one write transaction
+#define I2C_WRITE_MAX	256
+// messages of one I2C_RDWR ioctl
+#define I2C_MSG_MAX	I2C_RDWR_IOCTL_MAX_MSGS
+// buses of rpi_transport_i2c_bus()
+#define I2C_BUS_MAX	8
+
+uint64_t rpi_time_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void tr_delay_ms(rpi_transport_t* tr, uint32_t millis) {
+	usleep(millis * 1000UL);
+}
+
+static uint64_t tr_timestamp(rpi_transport_t* tr) {
+	return rpi_time_ns();
+}
+
+int rpi_tr_batch(rpi_transport_t* tr, rpi_xfer_t* xfers, int count) {
+	int i, rt;
+
+	if (tr->batch != NULL) {
+		return tr->batch(tr, xfers, count);
+	}
+
+	for (i = 0; i < count; i++) {
+		rpi_xfer_t* x = &xfers[i];
+
+		if (x->flags & RPI_XFER_READ) {
+			rt = tr->read(tr, x->dev, x->reg, x->data, x->len);
+		} else {
+			rt = tr->write(tr, x->dev, x->reg, x->data, x->len);
+		}
+		if (rt) {
+			return RPI_TR_FAIL;
+		}
+	}
+	return RPI_TR_OK;
+}
+
+int rpi_tr_read_byte(rpi_transport_t* tr, uint8_t dev, uint8_t reg) {
+	uint8_t data;
+
+	if (tr->read(tr, dev, reg, &data, 1)) {
+		return RPI_TR_FAIL;
+	}
+	return data;
+}
+
+int rpi_tr_write_byte(rpi_transport_t* tr, uint8_t dev, uint8_t reg, uint8_t data) {
+	return tr->write(tr, dev, reg, &data, 1);
+}
+
+int rpi_tr_read_word(rpi_transport_t* tr, uint8_t dev, uint8_t reg) {
+	uint8_t data[2];
+
+	if (tr->read(tr, dev, reg, data, 2)) {
+		return RPI_TR_FAIL;
+	}
+	return ((unsigned)data[0] << 8) | data[1];
+}
+
+void rpi_transport_close(rpi_transport_t* tr) {
+	if (tr != NULL && tr->close != NULL) {
+		tr->close(tr);
+	}
+}
+
+/***************************************************************
+ i2c-dev
+ ***************************************************************/
+typedef struct {
+	int fd;
+	char path[32];
+	// register address + payload of write messages
+	uint8_t wbuf[I2C_MSG_MAX][1 + I2C_WRITE_MAX];
+	uint8_t regs[I2C_MSG_MAX];
+	struct i2c_msg msgs[I2C_MSG_MAX];
+} i2c_priv_t;
+
+// xfers of one I2C_RDWR call, a read takes 2 messages
+static int i2c_rdwr(i2c_priv_t* p, rpi_xfer_t* xfers, int count) {
+	struct i2c_rdwr_ioctl_data rdwr;
+	int i, n = 0, rt;
+
+	for (i = 0; i < count; i++) {
+		rpi_xfer_t* x = &xfers[i];
+
+		if (x->flags & RPI_XFER_READ) {
+			p->regs[n] = x->reg;
+			p->msgs[n].addr  = x->dev;
+			p->msgs[n].flags = 0;
+			p->msgs[n].len   = 1;
+			p->msgs[n].buf   = &p->regs[n];
+			n++;
+			p->msgs[n].addr  = x->dev;
+			p->msgs[n].flags = I2C_M_RD;
+			p->msgs[n].len   = x->len;
+			p->msgs[n].buf   = x->data;
+			n++;
+		} else {
+			if (x->len > I2C_WRITE_MAX) {
+				return RPI_TR_FAIL;
+			}
+			p->wbuf[n][0] = x->reg;
+			memcpy(&p->wbuf[n][1], x->data, x->len);
+			p->msgs[n].addr  = x->dev;
+			p->msgs[n].flags = 0;
+			p->msgs[n].len   = 1 + x->len;
+			p->msgs[n].buf   = p->wbuf[n];
+			n++;
+		}
+	}
+
+	rdwr.msgs = p->msgs;
+	rdwr.nmsgs = n;
+	RPI_TRACE_BEGIN(RPI_TRACE_XFER);
+	if ((rt = ioctl(p->fd, I2C_RDWR, &rdwr)) != n) {
+		RPI_TRACE_END(RPI_TRACE_XFER);
+		#if _DEBUG
+		printf("Failed I2C_RDWR %d messages, error = %d.\n", n, rt);
+		#endif
+		return RPI_TR_FAIL;
+	}
+	RPI_TRACE_END(RPI_TRACE_XFER);
+	return RPI_TR_OK;
+}
+
+static int8_t i2c_tr_read(rpi_transport_t* tr, uint8_t dev,
+                          uint8_t reg, uint8_t* data, uint16_t len) {
+	rpi_xfer_t x = { dev, reg, RPI_XFER_READ, len, data };
+
+	return i2c_rdwr(tr->priv, &x, 1);
+}
+
+static int8_t i2c_tr_write(rpi_transport_t* tr, uint8_t dev,
+                           uint8_t reg, const uint8_t* data, uint16_t len) {
+	rpi_xfer_t x = { dev, reg, RPI_XFER_WRITE, len, (uint8_t*)data };
+
+	return i2c_rdwr(tr->priv, &x, 1);
+}
+
+static int i2c_tr_batch(rpi_transport_t* tr, rpi_xfer_t* xfers, int count) {
+	int i, n, msgs;
+
+	// split at the message limit of the kernel
+	for (i = 0; i < count; i += n) {
+		for (n = 0, msgs = 0; i + n < count; n++) {
+			int m = (xfers[i + n].flags & RPI_XFER_READ)? 2: 1;
+
+			if (msgs + m > I2C_MSG_MAX) {
+				break;
+			}
+			msgs += m;
+		}
+		if (i2c_rdwr(tr->priv, &xfers[i], n)) {
+			return RPI_TR_FAIL;
+		}
+	}
+	return RPI_TR_OK;
+}
+
+static void i2c_tr_close(rpi_transport_t* tr) {
+	i2c_priv_t* p = tr->priv;
+
+	close(p->fd);
+	free(p);
+	free(tr);
+}
+
+rpi_transport_t* rpi_transport_i2c(const char* dev_path) {
+	rpi_transport_t* tr;
+	i2c_priv_t* p;
+
+	tr = calloc(1, sizeof *tr);
+	p = calloc(1, sizeof *p);
+	if (tr == NULL || p == NULL) {
+		free(tr);
+		free(p);
+		return NULL;
+	}
+
+	if ((p->fd = open(dev_path, O_RDWR)) < 0) {
+		printf("Failed to open i2c bus %s, error = %d\n",
+		       dev_path, p->fd);
+		free(tr);
+		free(p);
+		return NULL;
+	}
+	snprintf(p->path, sizeof p->path, "%s", dev_path);
+
+	tr->kind      = RPI_TR_I2C;
+	tr->priv      = p;
+	tr->read      = i2c_tr_read;
+	tr->write     = i2c_tr_write;
+	tr->batch     = i2c_tr_batch;
+	tr->delay_ms  = tr_delay_ms;
+	tr->timestamp = tr_timestamp;
+	tr->close     = i2c_tr_close;
+	return tr;
+}
+
+rpi_transport_t* rpi_transport_i2c_bus(const char* dev_path) {
+	static rpi_transport_t* buses[I2C_BUS_MAX];
+	static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+	rpi_transport_t* tr = NULL;
+	int i;
+
+	// drivers of several threads may open the same bus at once
+	pthread_mutex_lock(&lock);
+	for (i = 0; i < I2C_BUS_MAX && buses[i] != NULL; i++) {
+		i2c_priv_t* p = buses[i]->priv;
+
+		if (strcmp(p->path, dev_path) == 0) {
+			tr = buses[i];
+			break;
+		}
+	}
+	if (tr == NULL && i < I2C_BUS_MAX) {
+		tr = buses[i] = rpi_transport_i2c(dev_path);
+	}
+	pthread_mutex_unlock(&lock);
+	return tr;
+}
+
+/***************************************************************
+ spidev
+ ***************************************************************/
+static int8_t spi_tr_read(rpi_transport_t* tr, uint8_t dev,
+                          uint8_t reg, uint8_t* data, uint16_t len) {
+	return rpi_spi_read(dev, reg, data, len);
+}
+
+static int8_t spi_tr_write(rpi_transport_t* tr, uint8_t dev,
+                           uint8_t reg, const uint8_t* data, uint16_t len) {
+	return rpi_spi_write(dev, reg, (uint8_t*)data, len);
+}
+
+static void spi_tr_close(rpi_transport_t* tr) {
+	free(tr);
+}
+
+rpi_transport_t* rpi_transport_spi(void) {
+	rpi_transport_t* tr;
+
+	if ((tr = calloc(1, sizeof *tr)) == NULL) {
+		return NULL;
+	}
+	tr->kind      = RPI_TR_SPI;
+	tr->read      = spi_tr_read;
+	tr->write     = spi_tr_write;
+	tr->batch     = NULL;
+	tr->delay_ms  = tr_delay_ms;
+	tr->timestamp = tr_timestamp;
+	tr->close     = spi_tr_close;
+	return tr;
+}
+
+#ifdef __cplusplus
+}
+#endif
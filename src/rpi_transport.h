@@ -0,0 +1,156 @@
+/*
+ * Bus transport interface shared by all drivers
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __RPI_TRANSPORT_H__
+#define __RPI_TRANSPORT_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define RPI_TR_OK	0
+#define RPI_TR_FAIL	-1
+
+// rpi_transport_t.kind
+#define RPI_TR_I2C	0
+#define RPI_TR_SPI	1
+#define RPI_TR_EMU	2
+#define RPI_TR_REPLAY	3
+
+// rpi_xfer_t.flags
+#define RPI_XFER_WRITE	0x00
+#define RPI_XFER_READ	0x01
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// one register transaction of a batch
+typedef struct {
+	uint8_t dev;		// i2c address, spi id
+	uint8_t reg;
+	uint8_t flags;
+	uint16_t len;
+	uint8_t* data;
+} rpi_xfer_t;
+
+typedef struct rpi_transport rpi_transport_t;
+
+/*
+ * A bus the drivers talk through. Devices keep a pointer to it,
+ * every register access, wait and timestamp goes through here.
+ * batch == NULL: transactions are issued one by one.
+ */
+struct rpi_transport {
+	int kind;
+	void* priv;
+
+	int8_t (*read)(rpi_transport_t* tr, uint8_t dev,
+	               uint8_t reg, uint8_t* data, uint16_t len);
+	int8_t (*write)(rpi_transport_t* tr, uint8_t dev,
+	                uint8_t reg, const uint8_t* data, uint16_t len);
+	int (*batch)(rpi_transport_t* tr, rpi_xfer_t* xfers, int count);
+	void (*delay_ms)(rpi_transport_t* tr, uint32_t millis);
+	// nanoseconds, CLOCK_MONOTONIC based
+	uint64_t (*timestamp)(rpi_transport_t* tr);
+	void (*close)(rpi_transport_t* tr);
+};
+
+/*
+ * Implementations, all return NULL on failure
+ */
+
+// i2c-dev, one file handle per transport, batch by I2C_RDWR
+rpi_transport_t* rpi_transport_i2c(const char* dev_path);
+
+// process wide i2c-dev transport of a bus, opened at first use,
+// which is used by rpi_*_init() taking a device path
+rpi_transport_t* rpi_transport_i2c_bus(const char* dev_path);
+
+// spidev, the dev of a transaction is the id from rpi_spi_init()
+rpi_transport_t* rpi_transport_spi(void);
+
+// in-memory register files, one per 7-bit address, virtual clock
+rpi_transport_t* rpi_transport_emu(void);
+// registers of an emulated device, 256 bytes
+uint8_t* rpi_transport_emu_regs(rpi_transport_t* tr, uint8_t dev);
+// callbacks after a register access of the emulated devices
+void rpi_transport_emu_hook(
+	rpi_transport_t* tr,
+	void (*on_access)(rpi_transport_t* tr, uint8_t dev,
+	                  uint8_t reg, uint16_t len, int is_read, void* arg),
+	void* arg
+);
+// fail the next count transactions
+void rpi_transport_emu_fail(rpi_transport_t* tr, int count);
+
+// pass through to inner, log all transactions into file path
+rpi_transport_t* rpi_transport_record(rpi_transport_t* inner, const char* path);
+// play back a file from rpi_transport_record()
+rpi_transport_t* rpi_transport_replay(const char* path);
+// transactions off the log so far, <0: not a replay
+int rpi_transport_replay_errors(rpi_transport_t* tr);
+
+void rpi_transport_close(rpi_transport_t* tr);
+
+/*
+ * Helpers for drivers
+ */
+static inline int8_t rpi_tr_read(rpi_transport_t* tr, uint8_t dev,
+                                 uint8_t reg, uint8_t* data, uint16_t len) {
+	return tr->read(tr, dev, reg, data, len);
+}
+
+static inline int8_t rpi_tr_write(rpi_transport_t* tr, uint8_t dev,
+                                  uint8_t reg, const uint8_t* data, uint16_t len) {
+	return tr->write(tr, dev, reg, data, len);
+}
+
+static inline void rpi_tr_delay_ms(rpi_transport_t* tr, uint32_t millis) {
+	tr->delay_ms(tr, millis);
+}
+
+static inline uint64_t rpi_tr_timestamp(rpi_transport_t* tr) {
+	return tr->timestamp(tr);
+}
+
+int rpi_tr_batch(rpi_transport_t* tr, rpi_xfer_t* xfers, int count);
+
+// return >=0: value, <0: error
+int rpi_tr_read_byte(rpi_transport_t* tr, uint8_t dev, uint8_t reg);
+int rpi_tr_write_byte(rpi_transport_t* tr, uint8_t dev, uint8_t reg, uint8_t data);
+// big endian word, as i2c_read_word()
+int rpi_tr_read_word(rpi_transport_t* tr, uint8_t dev, uint8_t reg);
+
+// CLOCK_MONOTONIC in nanoseconds
+uint64_t rpi_time_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//__RPI_TRANSPORT_H__
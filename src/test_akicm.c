@@ -0,0 +1,214 @@
+/*
+ * Test of the ICM20600 + AK09918 batch read on the emulator
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "rpi_akicm.h"
+#include "rpi_transport.h"
+
+#define NS_PER_MS	1000000ULL
+#define ICM		ICM20600_I2C_ADDR1
+#define AK		AK09918_I2C_ADDR
+#define ST1		0x10
+#define HXL		0x11
+#define ST2		0x18
+#define CNTL2		0x31
+#define DRDY		0x01
+#define CONV_MS		8		// a single measurement
+#define READS		100		// one per ms, below a health check
+
+static const icm20600_cfg_t conf = {
+	RANGE_250_DPS, GYRO_RATE_1K_BW_176, GYRO_AVERAGE_1,
+	RANGE_4G, ACC_RATE_1K_BW_420, ACC_AVERAGE_4,
+	ICM_6AXIS_LOW_NOISE, 0
+};
+
+/*
+ * The AK09918 as far as the test needs it: CNTL2 starts
+ * measurements, a field lands in HXL.. with DRDY when one is
+ * done, a read through ST2 clears DRDY. xfers counts accesses.
+ */
+static uint64_t conv_due, conv_ns;
+static int16_t field;
+static int xfers;
+
+static void ak_field(uint8_t* r, int16_t x, int16_t y, int16_t z) {
+	const int16_t v[3] = { x, y, z };
+	int k;
+
+	for (k = 0; k < 3; k++) {
+		r[HXL + 2 * k] = v[k] & 0xFF;
+		r[HXL + 2 * k + 1] = (uint16_t)v[k] >> 8;
+	}
+	r[ST1] |= DRDY;
+}
+
+static void ak_tick(rpi_transport_t* tr) {
+	uint8_t* r = rpi_transport_emu_regs(tr, AK);
+
+	if (conv_due == 0 || rpi_tr_timestamp(tr) < conv_due) {
+		return;
+	}
+	if (r[CNTL2] == AK09918_SELF_TEST) {
+		ak_field(r, 10, -10, -500);
+	} else {
+		field++;
+		ak_field(r, field, -field, 2 * field);
+	}
+	// continuous runs on, single and self-test power down
+	conv_due = conv_ns? conv_due + conv_ns: 0;
+}
+
+static void on_access(rpi_transport_t* tr, uint8_t dev, uint8_t reg,
+                      uint16_t len, int is_read, void* arg) {
+	uint8_t* r = rpi_transport_emu_regs(tr, AK);
+	uint64_t now = rpi_tr_timestamp(tr);
+
+	xfers++;
+	if (dev != AK) {
+		// the ICM burst goes first in a batch
+		ak_tick(tr);
+		return;
+	}
+	if (is_read && reg <= ST2 && reg + len > ST2) {
+		r[ST1] &= ~DRDY;
+	} else if (!is_read && reg == CNTL2) {
+		switch (r[CNTL2]) {
+		case AK09918_CONTINUOUS_100HZ:
+			conv_ns = 10 * NS_PER_MS;
+			conv_due = now + conv_ns;
+			break;
+		case AK09918_NORMAL:
+		case AK09918_SELF_TEST:
+			conv_ns = 0;
+			conv_due = now + CONV_MS * NS_PER_MS;
+			break;
+		default:
+			conv_ns = conv_due = 0;
+			break;
+		}
+	}
+}
+
+// one read 1ms after the last, return transfers of its batch
+static int read_at_ms(rpi_akicm_t* dev, rpi_sample_t* s) {
+	rpi_tr_delay_ms(dev->icm->tr, 1);
+	xfers = 0;
+	if (rpi_akicm_read(dev, s) != RPI_TR_OK) {
+		return -1;
+	}
+	return xfers;
+}
+
+static int check(const char* name, int ok) {
+	printf("%-9s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+int main(int argc, char* argv[]) {
+	rpi_transport_t* tr;
+	rpi_icm20600_t icm;
+	rpi_ak09918_t ak;
+	rpi_akicm_t dev;
+	rpi_startup_t job;
+	rpi_sample_t s;
+	int16_t last;
+	int i, n, fields, batch[4], bad, fail = 0;
+
+	tr = rpi_transport_emu();
+	rpi_transport_emu_regs(tr, ICM)[0x75] = 0x11;
+	rpi_transport_emu_regs(tr, AK)[0x00] = 0x48;
+	rpi_transport_emu_regs(tr, AK)[0x01] = 0x0C;
+	rpi_transport_emu_hook(tr, on_access, NULL);
+	if (rpi_icm20600_init_tr(&icm, tr, ICM, &conf) != 0x11 ||
+	    rpi_ak09918_init_tr(&ak, tr, AK, AK09918_CONTINUOUS_100HZ) < 0 ||
+	    rpi_akicm_init(&dev, &icm, &ak) != 0) {
+		printf("init     : FAIL\n");
+		return 1;
+	}
+
+	// due at once, no field yet: both chips in one batch, no mag
+	n = read_at_ms(&dev, &s);
+	fail += check("no field", n == 2 && !(s.flags & RPI_SAMPLE_MAG) &&
+		!dev.mag_valid);
+
+	// DRDY clear leaves it due: read again until the field is there
+	for (i = 0, bad = 0; i < 8; i++) {
+		bad += read_at_ms(&dev, &s) != 2 || (s.flags & RPI_SAMPLE_MAG);
+	}
+	n = read_at_ms(&dev, &s);
+	fail += check("drdy", bad == 0 && n == 2 && (s.flags & RPI_SAMPLE_MAG) &&
+		s.mag[0] == field && s.mag[2] == 2 * field && dev.mag_valid);
+
+	// continuous: the ICM alone until the next field is near,
+	// the last one kept in between
+	memset(batch, 0, sizeof batch);
+	for (i = 0, fields = 0, bad = 0, last = field; i < READS; i++) {
+		n = read_at_ms(&dev, &s);
+		batch[(n >= 0 && n < 4)? n: 0]++;
+		if (s.flags & RPI_SAMPLE_MAG) {
+			fields++;
+			bad += s.mag[0] != field;
+			last = field;
+		} else {
+			bad += s.mag[0] != last;
+		}
+	}
+	fail += check("paced", bad == 0 && fields == READS / 10 &&
+		batch[0] == 0 && batch[3] == 0 && batch[2] <= 2 * fields &&
+		batch[1] >= READS - 2 * fields);
+
+	// single: every AK read starts the next measurement, and that
+	// is not read again before it can be done
+	rpi_ak09918_set_mode(&ak, AK09918_NORMAL);
+	rpi_akicm_init(&dev, &icm, &ak);
+	memset(batch, 0, sizeof batch);
+	for (i = 0, fields = 0; i < READS; i++) {
+		n = read_at_ms(&dev, &s);
+		batch[(n >= 0 && n < 4)? n: 0]++;
+		fields += (s.flags & RPI_SAMPLE_MAG) != 0;
+	}
+	fail += check("single", batch[0] == 0 && batch[2] == 0 &&
+		batch[3] >= fields && batch[3] <= fields + 1 &&
+		fields >= READS / (CONV_MS + 2));
+
+	// self-test while streaming: the AK is left out, its DRDY kept
+	rpi_ak09918_set_mode(&ak, AK09918_CONTINUOUS_100HZ);
+	rpi_akicm_init(&dev, &icm, &ak);
+	rpi_ak09918_selftest(&job, &ak);
+	for (i = 0, bad = 0; i < READS && rpi_startup_poll(&job); i++) {
+		n = read_at_ms(&dev, &s);
+		bad += ak.testing && n != 1;
+	}
+	fail += check("selftest", job.rt == AK09918_ERR_OK && bad == 0 &&
+		!ak.testing && ak.mode == AK09918_CONTINUOUS_100HZ);
+
+	rpi_transport_close(tr);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * Test of the merged stream of a sensor array
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "rpi_array.h"
+
+#define BUSES		3
+#define PER_BUS		2
+#define SENSORS		(BUSES * PER_BUS)
+#define PERIOD_US	1000
+#define RUN_US		100000
+#define RING		256
+
+/* a sensor which counts its reads, every few reads one fails */
+typedef struct {
+	int16_t count;
+	int fail_every;
+} fake_t;
+
+static int fake_read(void* dev, rpi_sample_t* s) {
+	fake_t* f = dev;
+
+	if (f->fail_every && ++f->count % f->fail_every == 0) {
+		return -1;
+	}
+	s->flags = RPI_SAMPLE_ACC;
+	s->acc[0] = f->count++;
+	usleep(50);
+	return 0;
+}
+
+static int16_t next[SENSORS];
+static uint64_t last;
+static int total, order, seq;
+
+/* merged stream in time order, each sensor's samples as they were read */
+static void check(const rpi_sample_t* out, int n) {
+	int i;
+
+	for (i = 0; i < n; i++) {
+		const rpi_sample_t* s = &out[i];
+
+		order += s->ts < last;
+		last = s->ts;
+		if (s->sensor >= SENSORS || s->acc[0] < next[s->sensor]) {
+			seq++;
+			continue;
+		}
+		next[s->sensor] = s->acc[0] + 1;
+	}
+	total += n;
+}
+
+int main(int argc, char* argv[]) {
+	static rpi_sample_t out[SENSORS * RING];
+	fake_t fake[SENSORS];
+	rpi_array_t arr;
+	uint32_t errors = 0, dropped = 0;
+	int i, bad, fail = 0;
+
+	memset(fake, 0, sizeof fake);
+	rpi_array_init(&arr, PERIOD_US, RING);
+	for (i = 0; i < BUSES; i++) {
+		rpi_array_bus(&arr, -1);
+	}
+	for (i = 0; i < SENSORS; i++) {
+		fake[i].fail_every = (i == 1)? 7: 0;
+		rpi_array_add(&arr, i % BUSES, fake_read, &fake[i]);
+	}
+
+	if (rpi_array_start(&arr) < 0) {
+		printf("start    : FAIL\n");
+		return 1;
+	}
+	// drain while running, then what is left after the stop
+	for (i = 0; i < RUN_US / 10000; i++) {
+		usleep(10000);
+		check(out, rpi_array_read(&arr, out, SENSORS * RING));
+	}
+	rpi_array_stop(&arr);
+	check(out, rpi_array_read(&arr, out, SENSORS * RING));
+
+	printf("order    : %d samples, %d out of order %s\n",
+		total, order, order? "FAIL": "OK");
+	fail += order != 0;
+	printf("sequence : %s\n", seq? "FAIL": "OK");
+	fail += seq != 0;
+
+	// every good read came out, the failed ones were counted
+	for (i = 0; i < SENSORS; i++) {
+		errors += arr.sensor[i].errors;
+		dropped += arr.sensor[i].dropped;
+	}
+	bad = dropped != 0 || errors == 0 ||
+	      total < SENSORS * (RUN_US / PERIOD_US) / 2;
+	printf("count    : %u errors, %u dropped %s\n", errors, dropped, bad? "FAIL": "OK");
+	fail += bad;
+
+	rpi_array_free(&arr);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
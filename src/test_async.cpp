@@ -0,0 +1,171 @@
+/*
+ * Test of the coroutine sensor reads
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "rpi_async.hpp"
+
+#define NS_PER_MS	1000000ULL
+#define BATCHES		10
+#define PACKETS		3		// in the FIFO at every read
+
+static const icm20600_cfg_t conf = {
+	RANGE_2K_DPS, GYRO_RATE_1K_BW_176, GYRO_AVERAGE_1,
+	RANGE_16G, ACC_RATE_1K_BW_420, ACC_AVERAGE_4,
+	ICM_6AXIS_LOW_NOISE, 1		// 500Hz
+};
+
+struct result {
+	int batches = 0;
+	int rows = 0;
+	int bad = 0;
+};
+
+static rpi::task pipe_reader(rpi::reactor& r, int fd, int* got) {
+	char c;
+
+	if (co_await r.wait(fd) == 0 && read(fd, &c, 1) == 1) {
+		*got = c;
+	}
+}
+
+// BATCHES batches of the timer into b, rows checked as they come
+static rpi::task collect(rpi::async_sensor<rpi_icm20600_t>& imu,
+                         rpi_block_t* b, result* res) {
+	int n, k;
+
+	while (res->batches < BATCHES) {
+		int first = b->count;
+
+		if ((n = co_await imu.next_batch(b)) < 0) {
+			res->bad++;
+			co_return;
+		}
+		if (n == 0) {
+			continue;
+		}
+		res->batches++;
+		res->rows += n;
+		for (k = first; k < b->count; k++) {
+			res->bad += !(b->flags[k] & RPI_SAMPLE_ACC);
+			// FIFO rows one output period apart
+			res->bad += (k > first && b->ts[k] - b->ts[k - 1] != 2 * NS_PER_MS);
+		}
+		b->count = 0;
+	}
+}
+
+static int check(const char* name, int ok) {
+	printf("%-9s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+int main() {
+	rpi_transport_t* tr;
+	rpi_icm20600_t icm;
+	rpi_block_t* b;
+	uint8_t* regs;
+	int fds[2], got = 0, fail = 0;
+	uint64_t t;
+
+	rpi::reactor r;
+
+	// a plain fd: resumed once it is readable
+	if (!r || pipe(fds) < 0) {
+		return 1;
+	}
+	pipe_reader(r, fds[0], &got);
+	fail += check("armed", r.armed() == 1 && got == 0);
+	if (write(fds[1], "x", 1) != 1) {
+		return 1;
+	}
+	r.run();
+	fail += check("readable", got == 'x' && r.armed() == 0);
+
+	// forgotten while waiting: never resumed, run() has nothing left
+	got = 0;
+	pipe_reader(r, fds[0], &got);
+	r.forget(fds[0]);
+	if (write(fds[1], "y", 1) != 1) {
+		return 1;
+	}
+	fail += check("forget", r.armed() == 0 && r.run() == 0 &&
+		r.run_once(0) == 0 && got == 0);
+	close(fds[0]);
+	close(fds[1]);
+
+	// data registers on a 2ms timer, one row a batch
+	tr = rpi_transport_emu();
+	regs = rpi_transport_emu_regs(tr, ICM20600_I2C_ADDR1);
+	regs[0x75] = 0x11;
+	if (rpi_icm20600_init_tr(&icm, tr, ICM20600_I2C_ADDR1, &conf) != 0x11 ||
+	    posix_memalign((void**)&b, 64, sizeof *b)) {
+		return 1;
+	}
+	memset(b, 0, sizeof *b);
+	{
+		rpi::trigger every(rpi::period{ 2 * NS_PER_MS });
+		rpi::async_sensor<rpi_icm20600_t> imu(r, &icm, every);
+		result res;
+
+		t = rpi_time_ns();
+		collect(imu, b, &res);
+		r.run();
+		t = rpi_time_ns() - t;
+		fail += check("timer", every && res.bad == 0 &&
+		              res.batches == BATCHES && res.rows == BATCHES &&
+		              imu.events() >= BATCHES &&
+		              t >= (BATCHES - 1) * 2 * NS_PER_MS);
+		r.forget(every.fd());
+	}
+
+	// the FIFO, rows stamped at the configured rate, none given
+	if (rpi_icm20600_fifo_start(&icm, ICM20600_FIFO_ACCEL | ICM20600_FIFO_GYRO)) {
+		return 1;
+	}
+	regs[0x72] = 0;
+	regs[0x73] = PACKETS * 14;
+	{
+		rpi::trigger every(rpi::period{ 2 * NS_PER_MS });
+		rpi::async_sensor<rpi_icm20600_t> imu(r, &icm, every);
+		result res;
+
+		collect(imu, b, &res);
+		r.run();
+		fail += check("fifo", res.bad == 0 && res.batches == BATCHES &&
+		              res.rows == BATCHES * PACKETS);
+		r.forget(every.fd());
+	}
+
+	free(b);
+	rpi_transport_close(tr);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Test of auto-ranging
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "rpi_autorange.h"
+#include "rpi_icm20600.h"
+#include "rpi_transport.h"
+
+#define HOLD		100
+
+static const icm20600_cfg_t conf = {
+	RANGE_250_DPS, GYRO_RATE_1K_BW_176, GYRO_AVERAGE_1,
+	RANGE_4G, ACC_RATE_1K_BW_420, ACC_AVERAGE_4,
+	ICM_6AXIS_LOW_NOISE, 0
+};
+
+// n samples of x, y, z, return the last level
+static int feed(rpi_autorange_t* ar, int n, int16_t x, int16_t y, int16_t z) {
+	const int16_t v[3] = { x, y, z };
+	int level = ar->level;
+
+	while (n-- > 0) {
+		level = rpi_autorange_update(ar, v);
+	}
+	return level;
+}
+
+// accel x of the next data burst, big endian
+static void acc_x(rpi_transport_t* tr, int16_t x) {
+	uint8_t* r = rpi_transport_emu_regs(tr, ICM20600_I2C_ADDR1);
+
+	r[0x3B] = (uint16_t)x >> 8;
+	r[0x3C] = x & 0xFF;
+}
+
+// samples through the glue every 1ms, return flags seen or'ed
+static int stream(rpi_transport_t* tr, rpi_icm20600_t* icm,
+                  rpi_autorange_t* ar, int n) {
+	rpi_sample_t s;
+	int flags = 0;
+
+	while (n-- > 0) {
+		rpi_tr_delay_ms(tr, 1);
+		if (rpi_icm20600_sample(icm, &s) != RPI_TR_OK) {
+			return -1;
+		}
+		rpi_icm20600_autorange(icm, ar, &s);
+		flags |= s.flags;
+	}
+	return flags;
+}
+
+static int check(const char* name, int ok) {
+	printf("%-9s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+int main(int argc, char* argv[]) {
+	rpi_transport_t* tr;
+	rpi_icm20600_t icm;
+	rpi_autorange_t ar[2];
+	icm20600_cfg_t c;
+	double x, y, z;
+	int i, flags, fail = 0;
+
+	// any axis at hi, either sign: one wider, then nothing until landed
+	rpi_autorange_init(ar, 4, 1, HOLD);
+	i = feed(ar, 1, 0, RPI_AUTORANGE_HI - 1, 0) == 1 && !ar->pending;
+	i = i && feed(ar, 1, 0, 0, -32768) == 2 && ar->pending && ar->changes == 1;
+	i = i && feed(ar, 1, 32767, 0, 0) == 2 && feed(ar, HOLD, 0, 0, 0) == 2;
+	rpi_autorange_landed(ar, 2);
+	i = i && !ar->pending && feed(ar, 1, 32767, 0, 0) == 3;
+	rpi_autorange_landed(ar, 3);
+	i = i && feed(ar, 1, 32767, 0, 0) == 3 && !ar->pending;
+	fail += check("widen", i);
+
+	// hold quiet samples in a row, one above lo starts over
+	rpi_autorange_init(ar, 4, 2, HOLD);
+	i = feed(ar, HOLD - 1, 100, -100, 0) == 2;
+	i = i && feed(ar, 1, 0, 0, RPI_AUTORANGE_LO) == 2;
+	i = i && feed(ar, HOLD - 1, 0, 0, 0) == 2 && feed(ar, 1, 0, 0, 0) == 1;
+	i = i && ar->pending;
+	rpi_autorange_landed(ar, 1);
+	i = i && feed(ar, HOLD, 0, 0, 0) == 0;
+	rpi_autorange_landed(ar, 0);
+	i = i && feed(ar, 10 * HOLD, 0, 0, 0) == 0 && ar->changes == 2;
+	fail += check("narrow", i);
+
+	// another level taken than asked, the policy follows it
+	rpi_autorange_init(ar, 4, 1, HOLD);
+	feed(ar, 1, 32767, 0, 0);
+	rpi_autorange_landed(ar, 1);
+	i = ar->level == 1 && !ar->pending && feed(ar, 1, 32767, 0, 0) == 2;
+	rpi_autorange_landed(ar, 9);
+	fail += check("landed", i && ar->level == 3);
+
+	// through the driver: clipping accel, a wider range settles
+	tr = rpi_transport_emu();
+	rpi_transport_emu_regs(tr, ICM20600_I2C_ADDR1)[0x75] = 0x11;
+	if (rpi_icm20600_init_tr(&icm, tr, ICM20600_I2C_ADDR1, &conf) != 0x11) {
+		printf("init     : FAIL\nFAIL\n");
+		return 1;
+	}
+	rpi_autorange_init(&ar[0], RANGE_16G + 1, conf.acc_range, HOLD);
+	rpi_autorange_init(&ar[1], RANGE_2K_DPS + 1, conf.gyro_range, HOLD);
+	acc_x(tr, 32767);
+	i = stream(tr, &icm, ar, 1) >= 0 && ar[0].pending && ar[0].level == RANGE_8G;
+	// applied before the next burst: get_accel waits for the filters
+	i = i && rpi_icm20600_get_accel(&icm, &x, &y, &z) == RPI_ICM20600_E_BUSY;
+	acc_x(tr, 1000);
+	flags = stream(tr, &icm, ar, 10);
+	i = i && flags > 0 && (flags & RPI_SAMPLE_RANGE) && !ar[0].pending &&
+	    ar[0].level == RANGE_8G && icm.conf.acc_range == RANGE_8G;
+	i = i && rpi_icm20600_get_accel(&icm, &x, &y, &z) == 0 &&
+	    x > 240 && x < 250;
+	fail += check("driver", i);
+
+	// asked wider, reverted before it is applied: not stuck pending
+	acc_x(tr, 32767);
+	rpi_tr_delay_ms(tr, 1);
+	i = rpi_icm20600_autorange(&icm, ar, &(rpi_sample_t){
+		.flags = RPI_SAMPLE_ACC, .acc = { 32767, 0, 0 } }) == 1;
+	rpi_icm20600_get_config(&icm, &c);
+	c.acc_range = RANGE_8G;
+	rpi_icm20600_reconfigure(&icm, &c);
+	acc_x(tr, 1000);
+	flags = stream(tr, &icm, ar, 1);
+	i = i && (flags & RPI_SAMPLE_RANGE) && !ar[0].pending &&
+	    ar[0].level == RANGE_8G && icm.conf.acc_range == RANGE_8G;
+	fail += check("revert", i);
+
+	rpi_transport_close(tr);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
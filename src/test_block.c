@@ -0,0 +1,263 @@
+/*
+ * Test of the block pool and the ring across threads
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "rpi_block.h"
+#include "rpi_ring.h"
+
+#define POOL		6
+#define THREADS		4
+#define ROUNDS		20000
+#define ELEMENTS	100000
+#define BLOCKS		5000
+
+static rpi_block_pool_t pool;
+static int owner[POOL];		// thread holding the block, 0: none
+static int errors;
+
+// get and put as fast as possible, two blocks at a time at most
+static void* churn(void* arg) {
+	int me = (int)(intptr_t)arg, i, k, n;
+	rpi_block_t* b[2];
+
+	for (i = 0; i < ROUNDS; i++) {
+		for (n = 0; n < 1 + (i & 1); n++) {
+			while ((b[n] = rpi_block_get(&pool)) == NULL) {
+				sched_yield();
+			}
+			k = b[n] - pool.blocks;
+			// handed out twice if somebody else holds it
+			if (__atomic_exchange_n(&owner[k], me, __ATOMIC_ACQ_REL) != 0 ||
+			    b[n]->refs != 1 || b[n]->count != 0) {
+				__atomic_add_fetch(&errors, 1, __ATOMIC_RELAXED);
+			}
+			b[n]->count = 1;
+		}
+		while (n-- > 0) {
+			k = b[n] - pool.blocks;
+			__atomic_store_n(&owner[k], 0, __ATOMIC_RELEASE);
+			if (i & 2) {
+				rpi_block_ref(b[n]);
+				rpi_block_put(b[n]);
+			}
+			rpi_block_put(b[n]);
+		}
+	}
+	return NULL;
+}
+
+static rpi_ring_t ring;
+
+static void* produce_seq(void* arg) {
+	uint32_t i;
+
+	for (i = 0; i < ELEMENTS; i++) {
+		while (rpi_ring_push(&ring, &i) < 0) {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+// every element once, in order
+static void* consume_seq(void* arg) {
+	uint32_t i, v, *p;
+
+	for (i = 0; i < ELEMENTS; i++) {
+		if (i & 1) {
+			while (rpi_ring_pop(&ring, &v) < 0) {
+				sched_yield();
+			}
+		} else {
+			while ((p = rpi_ring_peek(&ring)) == NULL) {
+				sched_yield();
+			}
+			v = *p;
+			rpi_ring_drop(&ring);
+		}
+		errors += v != i;
+	}
+	return NULL;
+}
+
+// filled blocks through the ring, both sides holding a reference
+static void* produce_blocks(void* arg) {
+	rpi_sample_t s;
+	rpi_block_t* b;
+	int i;
+
+	memset(&s, 0, sizeof s);
+	for (i = 0; i < BLOCKS; i++) {
+		while ((b = rpi_block_get(&pool)) == NULL) {
+			sched_yield();
+		}
+		b->sensor = i & 0xFFFF;
+		for (s.ts = i; rpi_block_room(b) > 0; s.ts++) {
+			rpi_block_add(b, &s);
+		}
+		rpi_block_ref(b);
+		while (rpi_ring_push(&ring, &b) < 0) {
+			sched_yield();
+		}
+		rpi_block_put(b);
+	}
+	return NULL;
+}
+
+static void* consume_blocks(void* arg) {
+	rpi_block_t* b;
+	int i;
+
+	for (i = 0; i < BLOCKS; i++) {
+		while (rpi_ring_pop(&ring, &b) < 0) {
+			sched_yield();
+		}
+		errors += b->sensor != (i & 0xFFFF) || b->count != RPI_BLOCK_LEN ||
+		          b->ts[0] != (uint64_t)i ||
+		          b->ts[RPI_BLOCK_LEN - 1] != (uint64_t)i + RPI_BLOCK_LEN - 1;
+		rpi_block_put(b);
+	}
+	return NULL;
+}
+
+// every block of the pool free and distinct
+static int pool_whole(void) {
+	rpi_block_t* b[POOL];
+	int i, j, ok = pool.used == 0;
+
+	for (i = 0; i < POOL; i++) {
+		b[i] = rpi_block_get(&pool);
+		ok = ok && b[i] != NULL;
+		for (j = 0; ok && j < i; j++) {
+			ok = b[i] != b[j];
+		}
+	}
+	ok = ok && rpi_block_get(&pool) == NULL && pool.used == POOL;
+	for (i = 0; i < POOL; i++) {
+		if (b[i] != NULL) {
+			rpi_block_put(b[i]);
+		}
+	}
+	return ok && pool.used == 0;
+}
+
+static int check(const char* name, int ok) {
+	printf("%-9s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+int main(int argc, char* argv[]) {
+	pthread_t th[THREADS];
+	rpi_sample_t s, t;
+	rpi_block_t* b;
+	uint32_t v;
+	int i, ok, fail = 0;
+
+	if (rpi_block_pool_init(&pool, POOL) < 0) {
+		return 1;
+	}
+
+	// POOL blocks, then none
+	fail += check("exhaust", pool_whole());
+
+	// the last reference returns it, not before
+	b = rpi_block_get(&pool);
+	rpi_block_ref(b);
+	rpi_block_ref(b);
+	rpi_block_put(b);
+	rpi_block_put(b);
+	ok = b->refs == 1 && pool.used == 1;
+	rpi_block_put(b);
+	fail += check("refs", ok && pool.used == 0 && pool_whole());
+
+	// rows in, the same rows out, no more than a block
+	b = rpi_block_get(&pool);
+	memset(&s, 0, sizeof s);
+	for (i = 0, ok = 1; i < RPI_BLOCK_LEN; i++) {
+		s.ts = 1000 + i;
+		s.acc[2] = -i;
+		s.mag[0] = 3 * i;
+		s.flags = RPI_SAMPLE_ACC | RPI_SAMPLE_MAG;
+		ok = ok && rpi_block_add(b, &s) == RPI_BLOCK_LEN - 1 - i;
+	}
+	ok = ok && rpi_block_add(b, &s) < 0 && rpi_block_room(b) == 0;
+	rpi_block_sample(b, 7, &t);
+	ok = ok && t.ts == 1007 && t.acc[2] == -7 && t.mag[0] == 21 &&
+	     t.flags == (RPI_SAMPLE_ACC | RPI_SAMPLE_MAG);
+	rpi_block_put(b);
+	fail += check("rows", ok);
+
+	// get and put racing on a pool smaller than the demand
+	for (i = 0, ok = 1; i < THREADS; i++) {
+		ok = ok && pthread_create(&th[i], NULL, churn, (void*)(intptr_t)(i + 1)) == 0;
+	}
+	while (i-- > 0) {
+		pthread_join(th[i], NULL);
+	}
+	fail += check("threads", ok && errors == 0 && pool_whole());
+
+	// ring: rounded up, full and empty
+	ok = rpi_ring_init(&ring, 5, sizeof v) == 0;
+	for (v = 0; ok && v < 8; v++) {
+		ok = rpi_ring_push(&ring, &v) == 0;
+	}
+	ok = ok && rpi_ring_push(&ring, &v) < 0 && rpi_ring_count(&ring) == 8;
+	for (i = 0; ok && i < 8; i++) {
+		ok = rpi_ring_pop(&ring, &v) == 0 && v == (uint32_t)i;
+	}
+	ok = ok && rpi_ring_pop(&ring, &v) < 0 && rpi_ring_peek(&ring) == NULL;
+	rpi_ring_free(&ring);
+	fail += check("ring", ok);
+
+	// one producer, one consumer, a small ring wrapping all the time
+	errors = 0;
+	ok = rpi_ring_init(&ring, 64, sizeof v) == 0 &&
+	     pthread_create(&th[0], NULL, produce_seq, NULL) == 0 &&
+	     pthread_create(&th[1], NULL, consume_seq, NULL) == 0;
+	pthread_join(th[0], NULL);
+	pthread_join(th[1], NULL);
+	rpi_ring_free(&ring);
+	fail += check("spsc", ok && errors == 0);
+
+	// blocks handed over, freed by whichever side lets go last
+	errors = 0;
+	ok = rpi_ring_init(&ring, 4, sizeof b) == 0 &&
+	     pthread_create(&th[0], NULL, produce_blocks, NULL) == 0 &&
+	     pthread_create(&th[1], NULL, consume_blocks, NULL) == 0;
+	pthread_join(th[0], NULL);
+	pthread_join(th[1], NULL);
+	rpi_ring_free(&ring);
+	fail += check("handoff", ok && errors == 0 && pool_whole());
+
+	rpi_block_pool_free(&pool);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
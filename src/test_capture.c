@@ -0,0 +1,260 @@
+/*
+ * Test of capture files
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "rpi_capture.h"
+
+#define NS_PER_MS	1000000ULL
+#define PERIOD		(100 * NS_PER_MS)
+#define T0		(1000000 * NS_PER_MS)
+#define COUNT		2500		// sensor 0, 1kHz
+#define MAGS		25		// sensor 3, 10Hz
+#define SWITCH		1550		// sensor 0 changes unit here
+
+static const rpi_capture_unit_t unit_a = {
+	{ 0.001f, 0.01f, 1.0f, 0.125f }, { 0.0f, 0.0f, 0.0f, 23.0f }
+};
+static const rpi_capture_unit_t unit_b = {
+	{ 0.002f, 0.01f, 1.0f, 0.125f }, { 0.0f, 0.0f, 0.0f, 23.0f }
+};
+
+static rpi_sample_t acc[COUNT], mag[MAGS];
+
+typedef struct {
+	const rpi_sample_t* want;
+	int n;
+	int bad;
+} read_t;
+
+static int on_sample(void* arg, const rpi_sample_t* s,
+                     const rpi_capture_unit_t* u) {
+	read_t* r = arg;
+	const rpi_sample_t* w = &r->want[r->n++];
+
+	if (w->sensor == 0) {
+		r->bad += memcmp(u, (r->n - 1 < SWITCH)? &unit_a: &unit_b, sizeof *u) != 0;
+	}
+	r->bad += s->ts != w->ts || s->flags != w->flags || s->temp != w->temp ||
+	          memcmp(s->acc, w->acc, sizeof s->acc) ||
+	          memcmp(s->gyr, w->gyr, sizeof s->gyr) ||
+	          memcmp(s->mag, w->mag, sizeof s->mag);
+	return 0;
+}
+
+// n samples from, read back and compared, return -1: differ
+static int read_back(rpi_capture_t* cap, uint16_t sensor,
+                     const rpi_sample_t* want, int n) {
+	read_t r = { want, 0, 0 };
+
+	if (rpi_capture_read(cap, sensor, 0, UINT64_MAX, on_sample, &r) ||
+	    r.bad || (n >= 0 && r.n != n)) {
+		return -1;
+	}
+	return r.n;
+}
+
+// sums of acc x of rows [a, b] against rpi_capture_stats()
+static int stats_ok(rpi_capture_t* cap, int a, int b) {
+	rpi_capture_sum_t sum[RPI_CAPTURE_CH];
+	rpi_capture_unit_t u;
+	int64_t s = 0;
+	int16_t lo = INT16_MAX, hi = INT16_MIN;
+	int i;
+
+	if (rpi_capture_stats(cap, 0, acc[a].ts, acc[b].ts, sum, &u) < 0) {
+		return 0;
+	}
+	for (i = a; i <= b; i++) {
+		s += acc[i].acc[0];
+		lo = (acc[i].acc[0] < lo)? acc[i].acc[0]: lo;
+		hi = (acc[i].acc[0] > hi)? acc[i].acc[0]: hi;
+	}
+	return sum[0].n == (uint32_t)(b - a + 1) && sum[0].sum == s &&
+	       sum[0].min == lo && sum[0].max == hi &&
+	       sum[9].n == sum[0].n && sum[6].n == 0 &&
+	       memcmp(&u, &unit_a, sizeof u) == 0;
+}
+
+// both sensors interleaved, the unit of sensor 0 switched once
+static int write_file(const char* path) {
+	rpi_capture_t* cap;
+	int i, j, n;
+
+	cap = rpi_capture_create(path, PERIOD);
+	i = (cap != NULL) && rpi_capture_unit(cap, 0, &unit_a) == 0;
+	for (j = 0, n = 0; i && n < COUNT; n++) {
+		if (n == SWITCH) {
+			i = rpi_capture_unit(cap, 0, &unit_b) == 0;
+		}
+		i = i && rpi_capture_sample(cap, &acc[n]) == 0;
+		if (j < MAGS && mag[j].ts <= acc[n].ts) {
+			i = i && rpi_capture_sample(cap, &mag[j++]) == 0;
+		}
+	}
+	return (cap != NULL && rpi_capture_close(cap) == 0) && i;
+}
+
+// little endian u32 at off, or of the file end if off < 0
+static int patch32(const char* path, long off, uint32_t v) {
+	uint8_t b[4] = { v, v >> 8, v >> 16, v >> 24 };
+	FILE* fp;
+	int r;
+
+	if ((fp = fopen(path, "r+b")) == NULL) {
+		return -1;
+	}
+	r = fseek(fp, off, (off < 0)? SEEK_END: SEEK_SET) ||
+	    fwrite(b, 1, 4, fp) != 4;
+	return (fclose(fp) || r)? -1: 0;
+}
+
+// little endian u64 at off of the file end
+static uint64_t tail64(const char* path, long off) {
+	uint8_t b[8];
+	uint64_t v = 0;
+	FILE* fp;
+	int k;
+
+	if ((fp = fopen(path, "rb")) == NULL) {
+		return 0;
+	}
+	if (fseek(fp, off, SEEK_END) || fread(b, 1, 8, fp) != 8) {
+		memset(b, 0, sizeof b);
+	}
+	fclose(fp);
+	for (k = 7; k >= 0; k--) {
+		v = v << 8 | b[k];
+	}
+	return v;
+}
+
+static int check(const char* name, int ok) {
+	printf("%-9s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+int main(int argc, char* argv[]) {
+	char path[] = "/tmp/test_capture.XXXXXX";
+	rpi_capture_sum_t sum[RPI_CAPTURE_CH];
+	rpi_capture_info_t info;
+	rpi_capture_t* cap;
+	uint64_t from;
+	struct stat st;
+	int fd, i, k, n, fail = 0;
+
+	if ((fd = mkstemp(path)) < 0) {
+		return 1;
+	}
+	close(fd);
+
+	srand(1);
+	for (i = 0; i < COUNT; i++) {
+		acc[i].ts = T0 + i * NS_PER_MS;
+		acc[i].flags = RPI_SAMPLE_ACC | RPI_SAMPLE_GYR | RPI_SAMPLE_TEMP;
+		for (k = 0; k < 3; k++) {
+			acc[i].acc[k] = (int16_t)(rand() % 2001 - 1000);
+			acc[i].gyr[k] = (int16_t)(i * (k + 1));
+		}
+		acc[i].temp = 16 + i / 500;
+	}
+	for (i = 0; i < MAGS; i++) {
+		mag[i].ts = T0 + i * 100 * NS_PER_MS + 5;
+		mag[i].sensor = 3;
+		mag[i].flags = RPI_SAMPLE_MAG;
+		for (k = 0; k < 3; k++) {
+			mag[i].mag[k] = (int16_t)(rand() - RAND_MAX / 2);
+		}
+	}
+
+	fail += check("write", write_file(path));
+
+	// closed: the index, every sample and its unit come back
+	cap = rpi_capture_open(path);
+	i = cap != NULL;
+	if (i) {
+		rpi_capture_info(cap, &info);
+		i = info.indexed && info.t0 == T0 && info.t1 == acc[COUNT - 1].ts &&
+		    info.sensors == 0x09 && info.period_ns == PERIOD &&
+		    read_back(cap, 0, acc, COUNT) == COUNT &&
+		    read_back(cap, 3, mag, MAGS) == MAGS;
+	}
+	fail += check("roundtrip", i);
+
+	// headers only for a range on the period, cut chunks decoded
+	if (cap != NULL) {
+		from = T0 + PERIOD - (T0 + info.epoch_ns) % PERIOD;
+		n = rpi_capture_stats(cap, 0, from, from + 5 * PERIOD - 1, sum, NULL);
+		i = n == 0 && sum[0].n == 5 * PERIOD / NS_PER_MS;
+		i = i && stats_ok(cap, 0, SWITCH - 1) && stats_ok(cap, 10, 1234);
+		// counts of both units never mixed
+		i = i && rpi_capture_stats(cap, 0, T0, UINT64_MAX, sum, NULL) ==
+		         RPI_CAPTURE_E_UNIT;
+		rpi_capture_close(cap);
+	}
+	fail += check("stats", i);
+
+	// cut in the middle of a chunk: a scan finds the ones before
+	i = stat(path, &st) == 0 && truncate(path, st.st_size / 2) == 0 &&
+	    (cap = rpi_capture_open(path)) != NULL;
+	if (i) {
+		rpi_capture_info(cap, &info);
+		n = read_back(cap, 0, acc, -1);
+		i = !info.indexed && info.chunks > 0 && n > 0 && n < COUNT &&
+		    read_back(cap, 3, mag, -1) > 0;
+		rpi_capture_close(cap);
+	}
+	fail += check("rescan", i);
+
+	// chunk sizes past the buffer: a bad index is scanned around,
+	// a bad chunk header ends the scan, never read into the buffer
+	i = write_file(path);
+	from = tail64(path, -24);		// index_tail_t offset
+	i = i && from != 0 && patch32(path, from + 28, 400000) == 0 &&
+	    (cap = rpi_capture_open(path)) != NULL;
+	if (i) {
+		rpi_capture_info(cap, &info);
+		i = !info.indexed && read_back(cap, 0, acc, COUNT) == COUNT;
+		rpi_capture_close(cap);
+	}
+	i = i && patch32(path, 32 + 4, 400000) == 0;	// first chunk_head_t
+	if (i && (cap = rpi_capture_open(path)) != NULL) {
+		rpi_capture_info(cap, &info);
+		i = !info.indexed && info.chunks == 0 &&
+		    read_back(cap, 0, acc, 0) == 0;
+		rpi_capture_close(cap);
+	}
+	fail += check("corrupt", i);
+
+	unlink(path);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Sample block codec round trip test
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rpi_codec.h"
+
+#define BLOCKS		4096
+#define LOOPS		20
+
+static rpi_block_t blocks[BLOCKS];
+static uint8_t coded[BLOCKS][RPI_CODEC_MAX_BYTES];
+static size_t sizes[BLOCKS];
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// bytes a block takes as rpi_sample_t fields
+static size_t raw_size(const rpi_block_t* b) {
+	return b->count * (sizeof b->ts[0] + 11 * sizeof(int16_t));
+}
+
+static int same(const rpi_block_t* a, const rpi_block_t* b) {
+	int i, k;
+
+	if (a->count != b->count || a->sensor != b->sensor) {
+		return 0;
+	}
+	for (i = 0; i < a->count; i++) {
+		for (k = 0; k < 3; k++) {
+			if (a->acc[k][i] != b->acc[k][i] ||
+			    a->gyr[k][i] != b->gyr[k][i] ||
+			    a->mag[k][i] != b->mag[k][i]) {
+				return 0;
+			}
+		}
+		if (a->ts[i] != b->ts[i] || a->temp[i] != b->temp[i] ||
+		    a->flags[i] != b->flags[i]) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*
+ * kind 0: slow random walk, an IMU at rest
+ *      1: full range noise, the worst case
+ *      2: constant and ramps, no residuals
+ *      3: short block, timestamps with jitter and a wrap of int16
+ */
+static void fill(rpi_block_t* b, int kind, uint64_t* ts) {
+	int16_t v[9] = { 100, -200, 16384, 3, -5, 1, 300, -120, -800 };
+	int i, k;
+
+	memset(b, 0, sizeof *b);
+	b->count = (kind == 3)? 1 + rand() % RPI_BLOCK_LEN: RPI_BLOCK_LEN;
+	b->sensor = kind;
+	for (i = 0; i < b->count; i++) {
+		*ts += 1000000 + ((kind == 3)? rand() % 20000 - 10000: 0);
+		b->ts[i] = *ts;
+		b->flags[i] = RPI_SAMPLE_ACC | RPI_SAMPLE_GYR | RPI_SAMPLE_TEMP;
+		b->flags[i] |= (i % 10 == 0)? RPI_SAMPLE_MAG: 0;
+		for (k = 0; k < 9; k++) {
+			switch (kind) {
+			case 0: v[k] += rand() % 7 - 3; break;
+			case 1: v[k] = rand(); break;
+			case 2: v[k] += k; break;
+			default: v[k] += (k == 0)? 30000: rand() % 101 - 50; break;
+			}
+		}
+		b->acc[0][i] = v[0]; b->acc[1][i] = v[1]; b->acc[2][i] = v[2];
+		b->gyr[0][i] = v[3]; b->gyr[1][i] = v[4]; b->gyr[2][i] = v[5];
+		b->mag[0][i] = v[6]; b->mag[1][i] = v[7]; b->mag[2][i] = v[8];
+		b->temp[i] = 2000 + i / 16;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	static const char* names[] = { "random walk", "full noise", "ramps", "jitter" };
+	rpi_block_t out;
+	uint64_t ts = 1ULL << 40;
+	size_t raw, enc;
+	double t;
+	int kind, i, n, bad, fail = 0;
+
+	srand(1);
+	for (kind = 0; kind < 4; kind++) {
+		raw = enc = 0;
+		bad = 0;
+		for (i = 0; i < BLOCKS; i++) {
+			fill(&blocks[i], kind, &ts);
+			sizes[i] = rpi_codec_encode(&blocks[i], coded[i]);
+			raw += raw_size(&blocks[i]);
+			enc += sizes[i];
+
+			n = rpi_codec_decode(coded[i], sizes[i], &out);
+			bad += (n != (int)sizes[i] || !same(&blocks[i], &out));
+			// a truncated block must be refused
+			bad += (sizes[i] > 6 &&
+			        rpi_codec_decode(coded[i], sizes[i] - 1, &out) >= 0);
+		}
+
+		t = now();
+		for (n = 0; n < LOOPS; n++) {
+			for (i = 0; i < BLOCKS; i++) {
+				rpi_codec_encode(&blocks[i], coded[i]);
+			}
+		}
+		t = now() - t;
+
+		printf("%-12s: %s, ratio %5.1f, encode %7.1lf MB/s\n", names[kind],
+		       bad? "FAIL": "OK", (double)raw / enc,
+		       raw * (double)LOOPS / t / 1e6);
+		fail += bad;
+	}
+	return fail? 1: 0;
+}
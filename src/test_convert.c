@@ -0,0 +1,119 @@
+/*
+ * Batch conversion kernels test
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "rpi_convert.h"
+
+#define RAW_MAX		0x8000
+#define COUNT		100003		// not a multiple of any vector width
+#define LOOPS		200
+
+static const char* kernels[] = { "neon", "avx2", "ssse3", "scalar" };
+
+static int16_t raw[COUNT * 3];
+static float ox[COUNT], oy[COUNT], oz[COUNT];
+static float rx[COUNT], ry[COUNT], rz[COUNT];
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int same(float a, float b) {
+	return fabsf(a - b) <= 1e-5f * (1.0f + fabsf(b));
+}
+
+int main(int argc, char* argv[]) {
+	/* accel range 6000 mg like rpi_bmi088_get_accel() */
+	const double range = 6000.0;
+	const float scale[3] = {
+		range / RAW_MAX, range / RAW_MAX, range / RAW_MAX
+	};
+	const float offset[3] = { 12.5f, -3.0f, 7.25f };
+	const float align[9] = {
+		0.0f, -1.0f, 0.0f,
+		1.0f,  0.0f, 0.0f,
+		0.0f,  0.0f, 1.0f,
+	};
+	rpi_convert_t plain[1], full[1];
+	unsigned k;
+	int i, fail = 0;
+
+	srand(1);
+	for (i = 0; i < COUNT * 3; i++) {
+		raw[i] = (int16_t)(rand() & 0xFFFF);
+	}
+	/* corner cases */
+	raw[0] = -32768; raw[1] = 32767; raw[2] = 0;
+
+	rpi_convert_init(plain, scale, NULL, NULL);
+	rpi_convert_init(full, scale, offset, align);
+	rpi_convert_s16x3_scalar(full, raw, COUNT, rx, ry, rz);
+
+	for (k = 0; k < sizeof kernels / sizeof kernels[0]; k++) {
+		double t;
+		int bad = 0;
+
+		if (rpi_convert_use(kernels[k]) < 0) {
+			printf("%-6s: not supported, skipped\n", kernels[k]);
+			continue;
+		}
+
+		/* scalar double formula of the drivers */
+		rpi_convert_s16x3(plain, raw, COUNT, ox, oy, oz);
+		for (i = 0; i < COUNT; i++) {
+			bad += !same(ox[i], raw[i * 3 + 0] * range / RAW_MAX);
+			bad += !same(oy[i], raw[i * 3 + 1] * range / RAW_MAX);
+			bad += !same(oz[i], raw[i * 3 + 2] * range / RAW_MAX);
+		}
+
+		/* offset + alignment against the scalar kernel */
+		rpi_convert_s16x3(full, raw, COUNT, ox, oy, oz);
+		for (i = 0; i < COUNT; i++) {
+			bad += !same(ox[i], rx[i]);
+			bad += !same(oy[i], ry[i]);
+			bad += !same(oz[i], rz[i]);
+		}
+
+		t = now();
+		for (i = 0; i < LOOPS; i++) {
+			rpi_convert_s16x3(full, raw, COUNT, ox, oy, oz);
+		}
+		t = now() - t;
+
+		printf("%-6s: %s, %7.1lf Msamples/s\n", kernels[k],
+		       bad? "FAIL": "OK", COUNT * (double)LOOPS / t / 1e6);
+		fail += bad;
+	}
+	return fail? 1: 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Test of the deadband output stage
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rpi_deadband.h"
+
+#define NS_PER_MS	1000000ULL
+#define COUNT		630001		// 630s at 1kHz
+#define BAND		20
+#define HEARTBEAT	1000		// ms
+
+static rpi_sample_t in[COUNT];
+static rpi_block_t blk;
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* 1kHz acc + gyr, noise inside the band, every step-th sample moves by jump */
+static void make(int step, int jump) {
+	int16_t base = 1000;
+	int i, k;
+
+	memset(in, 0, sizeof in);
+	for (i = 0; i < COUNT; i++) {
+		if (step && i % step == step - 1) {
+			base += jump;
+		}
+		in[i].ts = i * NS_PER_MS;
+		in[i].flags = RPI_SAMPLE_ACC | RPI_SAMPLE_GYR;
+		for (k = 0; k < 3; k++) {
+			in[i].acc[k] = base + rand() % BAND;
+			in[i].gyr[k] = -base - rand() % BAND;
+			in[i].mag[k] = rand();		// not in the sample
+		}
+	}
+}
+
+/* per sample and in blocks, the same rows; return rows sent, <0: differ */
+static int run(double* rate) {
+	static uint8_t sent[COUNT];
+	rpi_deadband_t one[1], many[1];
+	uint8_t idx[RPI_BLOCK_LEN];
+	int i, j, m, len, bad = 0;
+	double t;
+
+	rpi_deadband_init(one, BAND, BAND, BAND, HEARTBEAT);
+	rpi_deadband_init(many, BAND, BAND, BAND, HEARTBEAT);
+	for (i = 0; i < COUNT; i++) {
+		sent[i] = rpi_deadband_sample(one, &in[i]);
+	}
+
+	t = now();
+	for (i = 0, len = 1; i < COUNT; len = len % RPI_BLOCK_LEN + 1) {
+		// every length, the tail of a group of 8 too
+		for (blk.count = 0; blk.count < len && i < COUNT; i++) {
+			rpi_block_add(&blk, &in[i]);
+		}
+		m = rpi_deadband_block(many, &blk, idx);
+		for (j = 0; j < m; j++) {
+			bad += !sent[i - blk.count + idx[j]];
+			sent[i - blk.count + idx[j]] = 0;
+		}
+	}
+	t = now() - t;
+	for (i = 0; i < COUNT; i++) {
+		bad += sent[i];
+	}
+	*rate = COUNT / t / 1e6;
+	return (bad || one->out != many->out || one->in != COUNT ||
+	        many->in != COUNT)? -1: (int)one->out;
+}
+
+static int check(const char* name, int ok, double rate) {
+	if (rate > 0) {
+		printf("%-6s: %s, %7.1lf Msamples/s\n", name, ok? "OK": "FAIL", rate);
+	} else {
+		printf("%-6s: %s\n", name, ok? "OK": "FAIL");
+	}
+	return !ok;
+}
+
+int main(int argc, char* argv[]) {
+	rpi_deadband_t db[1];
+	rpi_sample_t s;
+	double rate;
+	int n, fail = 0;
+
+	srand(1);
+
+	// stationary: the first one and a heartbeat a second
+	make(0, 0);
+	n = run(&rate);
+	fail += check("quiet", n == COUNT / HEARTBEAT + 1, rate);
+
+	// a move every 100ms, one more row each
+	make(100, 3 * BAND);
+	n = run(&rate);
+	fail += check("steps", n >= COUNT / 100 &&
+	              n <= COUNT / 100 + COUNT / HEARTBEAT + 1, rate);
+
+	// random walk, most rows go through
+	make(1, 2 * BAND);
+	n = run(&rate);
+	fail += check("moving", n == COUNT, rate);
+
+	// a sensor missing from the sample is never compared
+	rpi_deadband_init(db, BAND, BAND, 0, 0);
+	memset(&s, 0, sizeof s);
+	s.flags = RPI_SAMPLE_ACC;
+	n = rpi_deadband_sample(db, &s);
+	s.ts = 3600000 * NS_PER_MS;
+	s.mag[0] = 1000;
+	n += rpi_deadband_sample(db, &s);
+	s.acc[2] = BAND;
+	n += rpi_deadband_sample(db, &s) * 2;
+	s.acc[2] = BAND + 1;
+	n += rpi_deadband_sample(db, &s) * 4;
+	fail += check("flags", n == 1 + 4, 0.0);
+
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
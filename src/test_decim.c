@@ -0,0 +1,168 @@
+/*
+ * Test of the FIR and CIC decimators
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "rpi_decim.h"
+
+#define COUNT		40000		// a multiple of FACTOR
+#define FACTOR		40		// 8 kHz to 200 Hz
+#define TAPS		320
+#define LOOPS		20
+
+static float x[COUNT], y[COUNT], z[COUNT];
+static float ox[COUNT], oy[COUNT], oz[COUNT];
+static float cx[COUNT], cy[COUNT], cz[COUNT];
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int same(float a, float b) {
+	return fabsf(a - b) <= 1e-4f * (1.0f + fabsf(b));
+}
+
+/* the same input in uneven pieces, the history carries across */
+static int run_chunked(rpi_decim_t* d) {
+	static const int sizes[] = { 1, 7, 255, 256, 257, 39, 1000 };
+	size_t i = 0;
+	int k = 0, n, o = 0;
+
+	while (i < COUNT) {
+		n = sizes[k++ % (sizeof sizes / sizeof sizes[0])];
+		if (n > (int)(COUNT - i)) {
+			n = COUNT - i;
+		}
+		o += rpi_decim_run(d, x + i, y + i, z + i, n, cx + o, cy + o, cz + o);
+		i += n;
+	}
+	return o;
+}
+
+/* the output at input k, straight from the taps */
+static double fir_at(const rpi_decim_t* d, const float* in, int k) {
+	double s = 0.0;
+	int t, j;
+
+	for (t = 0; t < d->taps; t++) {
+		j = k - (d->taps - 1) + t;
+		if (j >= 0) {
+			s += d->coef[t] * (double)in[j];
+		}
+	}
+	return s;
+}
+
+/* settled outputs of a constant input equal it */
+static int dc_gain(rpi_decim_t* d, double level) {
+	int i, n, bad = 0;
+
+	for (i = 0; i < COUNT; i++) {
+		x[i] = y[i] = z[i] = level;
+	}
+	rpi_decim_reset(d);
+	n = rpi_decim_run(d, x, y, z, COUNT, ox, oy, oz);
+	for (i = TAPS / FACTOR + 1; i < n; i++) {
+		bad += fabs(ox[i] - level) > 1e-3 * level;
+	}
+	return bad;
+}
+
+int main(int argc, char* argv[]) {
+	rpi_decim_t fir[1], cic[1];
+	double t;
+	int i, n, m, bad, fail = 0;
+
+	srand(1);
+	for (i = 0; i < COUNT; i++) {
+		x[i] = (rand() % 32000) - 16000.0f;
+		y[i] = 1000.0f * sinf(i * 0.01f);
+		z[i] = 500.0f;
+	}
+
+	/* FIR: taps straight, whole block and pieces agree */
+	if (rpi_decim_fir_init(fir, FACTOR, TAPS, 0.0) < 0) {
+		printf("fir init : FAIL\n");
+		return 1;
+	}
+	n = rpi_decim_run(fir, x, y, z, COUNT, ox, oy, oz);
+	bad = (n != COUNT / FACTOR);
+	for (i = 0; i < n; i++) {
+		bad += !same(ox[i], fir_at(fir, x, i * FACTOR + FACTOR - 1));
+		bad += !same(oy[i], fir_at(fir, y, i * FACTOR + FACTOR - 1));
+		bad += !same(oz[i], fir_at(fir, z, i * FACTOR + FACTOR - 1));
+	}
+	rpi_decim_reset(fir);
+	m = run_chunked(fir);
+	bad += (m != n);
+	for (i = 0; i < n && i < m; i++) {
+		bad += ox[i] != cx[i] || oy[i] != cy[i] || oz[i] != cz[i];
+	}
+	printf("fir      : %d outputs %s\n", n, bad? "FAIL": "OK");
+	fail += bad;
+
+	/* CIC: whole block and pieces agree */
+	if (rpi_decim_cic_init(cic, FACTOR, 4, 16000.0) < 0) {
+		printf("cic init : FAIL\n");
+		return 1;
+	}
+	n = rpi_decim_run(cic, x, y, z, COUNT, ox, oy, oz);
+	rpi_decim_reset(cic);
+	m = run_chunked(cic);
+	bad = (n != COUNT / FACTOR) || (m != n);
+	for (i = 0; i < n && i < m; i++) {
+		bad += ox[i] != cx[i] || oy[i] != cy[i] || oz[i] != cz[i];
+	}
+	printf("cic      : %d outputs %s\n", n, bad? "FAIL": "OK");
+	fail += bad;
+
+	/* throughput, input samples per second of all three axes */
+	t = now();
+	for (i = 0; i < LOOPS; i++) {
+		rpi_decim_run(fir, x, y, z, COUNT, ox, oy, oz);
+	}
+	t = now() - t;
+	printf("fir speed: %7.1lf Msamples/s\n", COUNT * 3.0 * LOOPS / t / 1e6);
+
+	bad = dc_gain(fir, 1000.0);
+	printf("fir dc   : %s\n", bad? "FAIL": "OK");
+	fail += bad;
+	bad = dc_gain(cic, 1000.0);
+	printf("cic dc   : %s\n", bad? "FAIL": "OK");
+	fail += bad;
+
+	rpi_decim_free(fir);
+	rpi_decim_free(cic);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Test of the stream health checks
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "rpi_health.h"
+#include "rpi_shadow.h"
+#include "rpi_transport.h"
+
+#define WINDOW		100
+
+/* a self-test of three 5ms steps, its verdict from job->cfg[0] */
+static int fake_step(rpi_startup_t* job) {
+	if (job->state++ < 3) {
+		return 5;
+	}
+	job->rt = *(const int*)job->cfg[0];
+	return RPI_STARTUP_DONE;
+}
+
+static void feed(rpi_health_t* h, int n, int16_t base, int step) {
+	rpi_sample_t s;
+	int i;
+
+	memset(&s, 0, sizeof s);
+	s.flags = RPI_SAMPLE_ACC | RPI_SAMPLE_GYR;
+	for (i = 0; i < n; i++) {
+		s.acc[0] = s.acc[1] = s.acc[2] = base + i * step;
+		s.gyr[0] = s.gyr[1] = s.gyr[2] = -base - i * step;
+		rpi_health_sample(h, &s);
+	}
+}
+
+static int check(const char* name, int ok) {
+	printf("%-10s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+int main(int argc, char* argv[]) {
+	rpi_transport_t* tr = rpi_transport_emu();
+	rpi_startup_t job;
+	rpi_health_t h;
+	int verdict, i, runs, fail = 0;
+
+	rpi_health_init(&h);
+	h.window = WINDOW;
+	h.frozen = 10;
+
+	// one window of a live signal, nothing wrong
+	feed(&h, WINDOW, 100, 1);
+	fail += check("clean", rpi_health_get(&h) == 0);
+
+	// stuck at one value: ten repeats after the first, flagged right away
+	feed(&h, 10, 500, 0);
+	i = rpi_health_get(&h) & RPI_HEALTH_FROZEN;
+	feed(&h, 1, 500, 0);
+	i = !i && (rpi_health_get(&h) & RPI_HEALTH_FROZEN);
+	feed(&h, 1, 600, 0);
+	fail += check("frozen", i && !(rpi_health_get(&h) & RPI_HEALTH_FROZEN));
+
+	// full scale once, reported at the end of its window
+	feed(&h, WINDOW - 12 - 1, 100, 1);
+	feed(&h, 1, 32767, 0);
+	i = rpi_health_get(&h) & RPI_HEALTH_SATURATED;
+	feed(&h, WINDOW, 100, 1);
+	fail += check("saturated", i && !(rpi_health_get(&h) & RPI_HEALTH_SATURATED));
+
+	// driver status: an overflow and a bus error in one window
+	rpi_health_status(&h, RPI_STATUS_OVERFLOW);
+	rpi_health_status(&h, RPI_STATUS_COM_FAIL);
+	feed(&h, WINDOW, 100, 1);
+	i = rpi_health_get(&h) == (RPI_HEALTH_OVERFLOW | RPI_HEALTH_COM);
+	feed(&h, WINDOW, 100, 1);
+	fail += check("status", i && rpi_health_get(&h) == 0);
+
+	// sensor time stops counting, eight repeats
+	for (i = 0; i < 8; i++) {
+		rpi_health_time(&h, 1234);
+	}
+	i = !(rpi_health_get(&h) & RPI_HEALTH_STALLED);
+	rpi_health_time(&h, 1234);
+	i = i && (rpi_health_get(&h) & RPI_HEALTH_STALLED);
+	rpi_health_time(&h, 1235);
+	fail += check("stalled", i && !(rpi_health_get(&h) & RPI_HEALTH_STALLED));
+
+	// self-test every 100ms, 15ms long, only in a gap that fits
+	memset(&job, 0, sizeof job);
+	job.step = fake_step;
+	job.tr = tr;
+	job.cfg[0] = &verdict;
+	verdict = 1;
+	rpi_health_selftest(&h, &job, 100, 15);
+	i = rpi_health_gap(&h, 50) == 0;
+	rpi_tr_delay_ms(tr, 100);
+	i = i && rpi_health_gap(&h, 10) == 0;
+	i = i && rpi_health_gap(&h, 20) == 1 &&
+	    (rpi_health_get(&h) & RPI_HEALTH_TESTING);
+	for (runs = 0; rpi_health_poll(&h); runs++) {
+		rpi_tr_delay_ms(tr, 1);
+	}
+	i = i && runs >= 15 && rpi_health_get(&h) == RPI_HEALTH_SELFTEST;
+	// passed the next time, not due before another period
+	verdict = 0;
+	i = i && rpi_health_gap(&h, 20) == 0;
+	rpi_tr_delay_ms(tr, 100);
+	i = i && rpi_health_gap(&h, 20) == 1;
+	while (rpi_health_poll(&h)) {
+		rpi_tr_delay_ms(tr, 1);
+	}
+	fail += check("selftest", i && rpi_health_get(&h) == 0);
+
+	rpi_transport_close(tr);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * Test of the C++ sensor wrappers on the emulator
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <math.h>
+#include "rpi_icm20600.hpp"
+#include "rpi_bmi088.hpp"
+
+#define ICM		ICM20600_I2C_ADDR1
+#define ACC		BMI08X_ACCEL_I2C_ADDR_PRIMARY
+#define GYR		BMI08X_GYRO_I2C_ADDR_PRIMARY
+
+typedef rpi::icm20600<RANGE_16G, ACC_RATE_1K_BW_420,
+                      RANGE_2K_DPS, GYRO_RATE_1K_BW_176> icm_t;
+typedef rpi::bmi088<BMI088_ACCEL_RANGE_6G, BMI08X_ACCEL_ODR_100_HZ,
+                    BMI08X_GYRO_RANGE_1000_DPS, BMI08X_GYRO_BW_23_ODR_200_HZ> bmi_t;
+
+// folded at compile time
+static_assert(icm_t::acc_lsb == 16000.0 / 32768 && icm_t::gyro_lsb == 2000.0 / 32768,
+              "ICM20600 LSB weights");
+static_assert(icm_t::acc_hz == 1000.0 && icm_t::gyro_hz == 1000.0, "ICM20600 rates");
+static_assert(bmi_t::acc_lsb == 6000.0 / 32768 && bmi_t::gyro_lsb == 1000.0 / 32768,
+              "BMI088 LSB weights");
+static_assert(bmi_t::acc_hz == 100.0 && bmi_t::gyro_hz == 200.0, "BMI088 rates");
+
+// big endian words from reg on
+static void be_words(uint8_t* r, int reg, const int16_t* v, int n) {
+	for (int i = 0; i < n; i++) {
+		r[reg + 2 * i] = (uint16_t)v[i] >> 8;
+		r[reg + 2 * i + 1] = v[i] & 0xFF;
+	}
+}
+
+static bool near(double a, double b) {
+	return fabs(a - b) < 1e-3;
+}
+
+static int check(const char* name, int ok) {
+	printf("%-9s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+int main() {
+	const int16_t data[7] = { 1000, -2000, 16384, 0, 100, -100, 0 };
+	rpi::vec3<float> a, g;
+	rpi::vec3<int16_t> raw;
+	rpi_transport_t* tr;
+	uint8_t *r, *acc, *gyr;
+	float temp;
+	int i, rt, fail = 0;
+
+	tr = rpi_transport_emu();
+	r = rpi_transport_emu_regs(tr, ICM);
+	r[0x75] = 0x11;
+	be_words(r, 0x3B, data, 7);
+
+	icm_t icm(tr, ICM);
+	if (!icm || icm.id() != 0x11) {
+		printf("init     : FAIL\n");
+		return 1;
+	}
+
+	// through the C driver: busy until the configuration settled
+	for (i = 0; i < 100; i++) {
+		rpi_tr_delay_ms(tr, 1);
+		if ((rt = icm.read_motion(a, g, temp)) != RPI_ICM20600_E_BUSY) {
+			break;
+		}
+	}
+	fail += check("motion", rt == RPI_TR_OK &&
+		near(a.x, 1000 * icm_t::acc_lsb) && near(a.y, -2000 * icm_t::acc_lsb) &&
+		near(a.z, 8000.0) && near(g.x, 100 * icm_t::gyro_lsb) &&
+		near(g.z, 0.0) && near(temp, 25.0));
+	rt = icm.read_accel_raw(raw);
+	rt = (rt == RPI_TR_OK && raw.x == 1000 && raw.z == 16384)? icm.read_gyro(g): -1;
+	fail += check("axes", rt == RPI_TR_OK && near(g.y, -100 * icm_t::gyro_lsb));
+
+	// a bus fault and a chip reset show in the health of the driver
+	icm.health();
+	rpi_transport_emu_fail(tr, 1);
+	rt = icm.read_accel(a);
+	fail += check("fault", rt == RPI_TR_FAIL &&
+		(icm.health() & RPI_STATUS_COM_FAIL));
+	r[0x6B] = 0x41;
+	for (i = 0; i < RPI_CHECK_PERIOD + 1; i++) {
+		rpi_tr_delay_ms(tr, 1);
+		icm.read_accel(a);
+	}
+	fail += check("recover", r[0x6B] != 0x41 &&
+		(icm.health() & RPI_STATUS_RECOVERED));
+
+	// BMI088 at its power on values
+	acc = rpi_transport_emu_regs(tr, ACC);
+	gyr = rpi_transport_emu_regs(tr, GYR);
+	acc[BMI08X_ACCEL_CHIP_ID_REG] = BMI088_ACCEL_CHIP_ID;
+	gyr[BMI08X_GYRO_CHIP_ID_REG] = BMI08X_GYRO_CHIP_ID;
+	acc[0x40] = 0xA8;
+	acc[0x41] = 0x01;
+	acc[0x7C] = 0x03;
+	gyr[0x10] = 0x80;
+	{
+		bmi_t bmi(tr, ACC, GYR);
+
+		rt = bmi? bmi.read_accel(a): -1;
+		rt = (rt == BMI08X_OK)? bmi.read_gyro(g): rt;
+		fail += check("bmi088", bmi.status() == BMI08X_OK && rt == BMI08X_OK &&
+			bmi.handle()->tr == tr);
+	}
+
+	rpi_transport_close(tr);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * Test of ICM20600 wake on motion on the emulator
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "rpi_icm20600.h"
+#include "rpi_transport.h"
+
+#define ADDR		ICM20600_I2C_ADDR1
+#define SMPLRT_DIV	0x19
+#define ACCEL_XOUT_H	0x3B
+#define INT_ENABLE	0x38
+#define INT_STATUS	0x3A
+#define INTEL_CTRL	0x69
+#define WOM_X_THR	0x20
+#define INT_WOM		0xE0
+#define INT_DATA_RDY	0x01
+#define THR_MG		100
+#define QUIET_MS	50
+
+static const icm20600_cfg_t conf = {
+	RANGE_250_DPS, GYRO_RATE_1K_BW_176, GYRO_AVERAGE_1,
+	RANGE_4G, ACC_RATE_1K_BW_420, ACC_AVERAGE_4,
+	ICM_6AXIS_LOW_NOISE, 0
+};
+
+/*
+ * The chip as the test sets it: moving swings accel x by 1g per
+ * sample, ready raises DATA_RDY; reading INT_STATUS clears it and
+ * latches what the enabled interrupts see for the next read.
+ */
+static int moving, ready = 1, samples;
+
+static void on_access(rpi_transport_t* tr, uint8_t dev, uint8_t reg,
+                      uint16_t len, int is_read, void* arg) {
+	uint8_t* r = rpi_transport_emu_regs(tr, ADDR);
+
+	if (!is_read || dev != ADDR) {
+		return;
+	}
+	if (reg == INT_STATUS) {
+		r[INT_STATUS] = 0;
+		if (moving && (r[INT_ENABLE] & INT_WOM)) {
+			r[INT_STATUS] |= INT_WOM;
+		}
+		if (ready && (r[INT_ENABLE] & INT_DATA_RDY)) {
+			r[INT_STATUS] |= INT_DATA_RDY;
+		}
+	} else if (reg == ACCEL_XOUT_H) {
+		samples++;
+		r[ACCEL_XOUT_H] = (moving && (samples & 1))? 0x20: 0x00;
+	}
+}
+
+static int check(const char* name, int ok) {
+	printf("%-9s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+int main(int argc, char* argv[]) {
+	rpi_icm20600_motion_t m;
+	rpi_icm20600_t icm;
+	rpi_transport_t* tr;
+	rpi_sample_t s;
+	uint64_t t0;
+	uint8_t* r;
+	int i, n, rt, fail = 0;
+
+	tr = rpi_transport_emu();
+	r = rpi_transport_emu_regs(tr, ADDR);
+	r[0x75] = 0x11;
+	if (rpi_icm20600_init_tr(&icm, tr, ADDR, &conf) != 0x11) {
+		printf("init     : FAIL\n");
+		return 1;
+	}
+	rpi_transport_emu_hook(tr, on_access, NULL);
+
+	// accel low power, thresholds in 4mg steps, the motion interrupt
+	rt = rpi_icm20600_motion_init(&m, &icm, &conf, -1, THR_MG, 9, QUIET_MS);
+	fail += check("enter", rt == RPI_TR_OK && !m.active &&
+		r[SMPLRT_DIV] == 9 && r[WOM_X_THR] == THR_MG / 4 &&
+		r[INTEL_CTRL] == 0xC0 && r[INT_ENABLE] == INT_WOM);
+
+	// still: the host sleeps through the timeout, nothing read
+	samples = 0;
+	rt = rpi_icm20600_motion_wait(&m, &s, 100);
+	fail += check("still", rt == 0 && !m.active && samples == 0 &&
+		r[INT_ENABLE] == INT_WOM);
+
+	// motion: back to conf with data ready, samples follow
+	moving = 1;
+	rt = rpi_icm20600_motion_wait(&m, &s, 100);
+	fail += check("leave", rt == 1 && m.active &&
+		r[INTEL_CTRL] == 0x00 && r[INT_ENABLE] == INT_DATA_RDY &&
+		r[SMPLRT_DIV] == conf.divider);
+	for (i = 0, n = 0; i < 100; i++) {
+		n += rpi_icm20600_motion_wait(&m, &s, 100) == 1;
+	}
+	fail += check("moving", n == 100 && m.active);
+
+	// no data ready, no sample, even polled
+	ready = 0;
+	r[INT_STATUS] = 0;
+	samples = 0;
+	rt = rpi_icm20600_motion_wait(&m, &s, 5);
+	fail += check("no drdy", rt == 0 && samples == 0 && m.active);
+	ready = 1;
+
+	// quiet_ms without motion: wake on motion again
+	moving = 0;
+	t0 = rpi_tr_timestamp(tr);
+	for (i = 0; i < 1000 && m.active; i++) {
+		if (rpi_icm20600_motion_wait(&m, &s, 100) != 1) {
+			break;
+		}
+	}
+	fail += check("quiet", !m.active &&
+		rpi_tr_timestamp(tr) - t0 >= QUIET_MS * 1000000ULL &&
+		rpi_tr_timestamp(tr) - t0 < 2 * QUIET_MS * 1000000ULL &&
+		r[INT_ENABLE] == INT_WOM && r[INTEL_CTRL] == 0xC0);
+
+	// and back to sleep on the next call
+	samples = 0;
+	rt = rpi_icm20600_motion_wait(&m, &s, 50);
+	fail += check("asleep", rt == 0 && !m.active && samples == 0);
+
+	rpi_transport_close(tr);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Test of the bus planner
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "rpi_plan.h"
+#include "rpi_ak09918.h"
+#include "rpi_bmi088.h"
+#include "rpi_icm20600.h"
+
+#define NS_PER_MS	1000000ULL
+
+static const struct bmi08x_cfg acc_cfg = {
+	.power = BMI08X_ACCEL_PM_ACTIVE,
+	.range = BMI088_ACCEL_RANGE_6G,
+	.bw    = BMI08X_ACCEL_BW_NORMAL,
+	.odr   = BMI08X_ACCEL_ODR_400_HZ,
+};
+static const struct bmi08x_cfg gyr_cfg = {
+	.power = BMI08X_GYRO_PM_NORMAL,
+	.range = BMI08X_GYRO_RANGE_1000_DPS,
+	.bw    = BMI08X_GYRO_BW_47_ODR_400_HZ,
+	.odr   = BMI08X_GYRO_BW_47_ODR_400_HZ,
+};
+static const icm20600_cfg_t icm_cfg = {
+	RANGE_2K_DPS, GYRO_RATE_1K_BW_176, GYRO_AVERAGE_1,
+	RANGE_16G, ACC_RATE_1K_BW_420, ACC_AVERAGE_4,
+	ICM_6AXIS_LOW_NOISE, 0
+};
+
+static rpi_plan_t plan;
+
+// AK 100Hz, ICM 1kHz, BMI 400Hz on one 400kHz I2C bus
+static int fill(int fifo) {
+	rpi_plan_init(&plan, NULL, 0);
+	return rpi_ak09918_plan(&plan, AK09918_CONTINUOUS_100HZ) |
+	       rpi_icm20600_plan(&plan, &icm_cfg, fifo) |
+	       rpi_bmi088_plan(&plan, &acc_cfg, &gyr_cfg);
+}
+
+/*
+ * Slots one after the other within the cycle, every read of a task
+ * once per period, started after its release and done by its deadline
+ */
+static int slots_ok(void) {
+	int reads[RPI_PLAN_MAX_TASK] = { 0 };
+	uint64_t end = 0, release;
+	int i, t;
+
+	for (i = 0; i < plan.slots; i++) {
+		const rpi_plan_slot_t* s = &plan.slot[i];
+		const rpi_plan_task_t* k = &plan.task[s->task];
+
+		release = reads[s->task]++ * k->period_ns;
+		if (s->offset_ns < end || s->offset_ns < release ||
+		    s->offset_ns + k->cost_ns > release + k->deadline_ns) {
+			return 0;
+		}
+		end = s->offset_ns + k->cost_ns;
+	}
+	for (t = 0; t < plan.tasks; t++) {
+		if (reads[t] * plan.task[t].period_ns != plan.cycle_ns) {
+			return 0;
+		}
+	}
+	return end <= plan.cycle_ns;
+}
+
+static int check(const char* name, int ok) {
+	printf("%-9s: %s, load %5.1f%%, cycle %6.1f ms, %d reads\n", name,
+	       ok? "OK": "FAIL", plan.utilization * 100, plan.cycle_ns / 1e6,
+	       plan.slots);
+	return !ok;
+}
+
+int main(int argc, char* argv[]) {
+	double load;
+	int i, fail = 0;
+
+	// data registers, every sample a read of its own
+	i = fill(0) == 0 && rpi_plan_schedule(&plan) == 0;
+	load = plan.utilization;
+	i = i && plan.tasks == 4 && load > 0.635 && load < 0.645 &&
+	    plan.cycle_ns == 10 * NS_PER_MS && plan.slots == 1 + 10 + 4 + 4 &&
+	    slots_ok();
+	fail += check("registers", i);
+
+	// the ICM FIFO read in bursts, less per sample
+	i = fill(ICM20600_FIFO_ACCEL | ICM20600_FIFO_GYRO) == 0 &&
+	    rpi_plan_schedule(&plan) == 0;
+	i = i && plan.tasks == 4 && plan.task[1].burst > 1 &&
+	    plan.utilization < load && slots_ok();
+	fail += check("fifo", i);
+
+	// two more ICMs at 1kHz are more than the bus carries
+	fill(0);
+	rpi_icm20600_plan(&plan, &icm_cfg, 0);
+	rpi_icm20600_plan(&plan, &icm_cfg, 0);
+	fail += check("overload", rpi_plan_schedule(&plan) == RPI_PLAN_OVERLOAD);
+
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
@@ -0,0 +1,277 @@
+/*
+ * Test of the delta-angle and delta-velocity pre-integration
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "rpi_preint.h"
+
+#define SAMPLE_NS	500000ULL	// 2kHz
+#define PERIOD_NS	10000000ULL	// 100Hz
+#define FINE		50		// reference steps per sample
+#define OUTPUTS		200
+#define LOOPS		2000
+
+static rpi_block_t block;
+static rpi_preint_delta_t deltas[RPI_BLOCK_LEN];
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * kind 0: coning, x and y rates 90 degrees apart at 40Hz
+ *      1: sculling, x rate and y accel in phase at 40Hz
+ */
+static void motion(int kind, double t, double w[3], double a[3]) {
+	double s = sin(2 * M_PI * 40 * t), c = cos(2 * M_PI * 40 * t);
+
+	w[0] = 2.0 * s;
+	w[1] = kind == 0? 2.0 * c: 0.0;
+	w[2] = 0.1;
+	a[0] = 0.0;
+	a[1] = kind == 1? 20.0 * s: 0.0;
+	a[2] = 9.80665;
+}
+
+static void mat_mul(double r[9], const double a[9], const double b[9]) {
+	double t[9];
+	int i, j;
+
+	for (i = 0; i < 3; i++) {
+		for (j = 0; j < 3; j++) {
+			t[i * 3 + j] = a[i * 3] * b[j] + a[i * 3 + 1] * b[3 + j] + a[i * 3 + 2] * b[6 + j];
+		}
+	}
+	for (i = 0; i < 9; i++) {
+		r[i] = t[i];
+	}
+}
+
+// rotation of the vector v, Rodrigues
+static void mat_exp(double r[9], const double v[3]) {
+	double th = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+	double s = th > 1e-12? sin(th) / th: 1.0;
+	double c = th > 1e-6? (1 - cos(th)) / (th * th): 0.5;
+	double k[9] = { 0, -v[2], v[1], v[2], 0, -v[0], -v[1], v[0], 0 }, kk[9];
+	int i;
+
+	mat_mul(kk, k, k);
+	for (i = 0; i < 9; i++) {
+		r[i] = (i % 4 == 0) + s * k[i] + c * kk[i];
+	}
+}
+
+// rotation vector of r, angles well below pi
+static void mat_log(double v[3], const double r[9]) {
+	double c = (r[0] + r[4] + r[8] - 1) / 2;
+	double th = acos(c > 1? 1: c), k = th > 1e-9? th / (2 * sin(th)): 0.5;
+
+	v[0] = k * (r[7] - r[5]);
+	v[1] = k * (r[2] - r[6]);
+	v[2] = k * (r[3] - r[1]);
+}
+
+static double norm_diff(const float a[3], const double b[3]) {
+	double x = a[0] - b[0], y = a[1] - b[1], z = a[2] - b[2];
+
+	return sqrt(x * x + y * y + z * z);
+}
+
+/*
+ * The motion integrated FINE times finer than the samples, which are
+ * the means over their interval as an IMU with a matched filter has.
+ * Errors of the increments against it, and of plain sums.
+ */
+static int accuracy(int kind) {
+	const double h = SAMPLE_NS * 1e-9 / FINE;
+	double rot[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 }, step[9], v[3], w[3], a[3];
+	double dv_ref[3] = { 0 }, th_ref[3], e_th = 0, e_th0 = 0, e_v = 0, e_v0 = 0;
+	float gyr[3], acc[3], sum_a[3] = { 0 }, sum_v[3] = { 0 };
+	rpi_preint_t p;
+	rpi_preint_delta_t d;
+	uint64_t ts = 0;
+	int j, k, n = 0;
+
+	rpi_preint_init(&p, SAMPLE_NS, PERIOD_NS);
+	while (n < OUTPUTS) {
+		double mw[3] = { 0 }, ma[3] = { 0 };
+
+		for (j = 0; j < FINE; j++) {
+			motion(kind, ts * 1e-9 + (j + 0.5) * h, w, a);
+			for (k = 0; k < 3; k++) {
+				mw[k] += w[k] / FINE;
+				ma[k] += a[k] / FINE;
+				dv_ref[k] += h * (rot[k * 3] * a[0] + rot[k * 3 + 1] * a[1] + rot[k * 3 + 2] * a[2]);
+				v[k] = w[k] * h;
+			}
+			mat_exp(step, v);
+			mat_mul(rot, rot, step);
+		}
+		ts += SAMPLE_NS;
+		for (k = 0; k < 3; k++) {
+			gyr[k] = mw[k];
+			acc[k] = ma[k];
+			sum_a[k] += gyr[k] * SAMPLE_NS * 1e-9f;
+			sum_v[k] += acc[k] * SAMPLE_NS * 1e-9f;
+		}
+		if (!rpi_preint_sample(&p, ts, gyr, acc, &d)) {
+			continue;
+		}
+
+		// the first one starts at the first sample, not an output edge
+		if (!(d.flags & RPI_PREINT_SHORT)) {
+			mat_log(th_ref, rot);
+			e_th += norm_diff(d.dtheta, th_ref);
+			e_th0 += norm_diff(sum_a, th_ref);
+			e_v += norm_diff(d.dvel, dv_ref);
+			e_v0 += norm_diff(sum_v, dv_ref);
+			n++;
+		}
+		for (k = 0; k < 9; k++) {
+			rot[k] = (k % 4 == 0);
+		}
+		for (k = 0; k < 3; k++) {
+			dv_ref[k] = sum_a[k] = sum_v[k] = 0;
+		}
+	}
+
+	printf("%-9s angle %.2e rad (sums %.2e), velocity %.2e m/s (sums %.2e)\n",
+		kind == 0? "coning": "sculling",
+		e_th / n, e_th0 / n, e_v / n, e_v0 / n);
+	// the compensation takes out most of what plain sums miss
+	if (kind == 0) {
+		return e_th * 10 < e_th0? 0: 1;
+	}
+	return e_v * 10 < e_v0? 0: 1;
+}
+
+/*
+ * A range switch within a block: the rows after it in the new scale
+ * give what rows in one scale all along give
+ */
+static int range_switch(void) {
+	rpi_preint_delta_t ref[RPI_BLOCK_LEN], got[RPI_BLOCK_LEN];
+	rpi_preint_t p, q;
+	int i, k, row, stops = 0, n = 0, m = 0, bad = 0;
+
+	rpi_preint_init(&p, SAMPLE_NS, SAMPLE_NS * 8);
+	rpi_preint_init(&q, SAMPLE_NS, SAMPLE_NS * 8);
+	rpi_preint_scale(&p, 1000.0, 12000.0);
+	rpi_preint_scale(&q, 1000.0, 12000.0);
+	memset(&block, 0, sizeof block);
+	block.count = RPI_BLOCK_LEN;
+	for (i = 0; i < RPI_BLOCK_LEN; i++) {
+		int wide = (i >= 40);
+
+		block.ts[i] = (i + 1) * SAMPLE_NS;
+		block.flags[i] = RPI_SAMPLE_ACC | RPI_SAMPLE_GYR;
+		block.flags[i] |= (i == 40)? RPI_SAMPLE_RANGE: 0;
+		// the same motion, half the counts at twice the range
+		block.gyr[0][i] = (3000 * sin(i * 0.3)) / (1 + wide);
+		block.gyr[2][i] = 400 / (1 + wide);
+		block.acc[1][i] = (800 * sin(i * 0.3)) / (1 + wide);
+		block.acc[2][i] = 2730 / (1 + wide);
+	}
+
+	// the reference converts every row at its own scale
+	for (i = 0; i < RPI_BLOCK_LEN; i++) {
+		float gyr[3], acc[3];
+		int wide = (i >= 40);
+
+		for (k = 0; k < 3; k++) {
+			gyr[k] = block.gyr[k][i] * q.gyr_k * (1 + wide);
+			acc[k] = block.acc[k][i] * q.acc_k * (1 + wide);
+		}
+		n += rpi_preint_sample(&q, block.ts[i], gyr, acc, &ref[n]);
+	}
+
+	for (row = 0; row < block.count; stops++) {
+		m += rpi_preint_block(&p, &block, &row, &got[m]);
+		if (row < block.count) {
+			bad += (row != 40);
+			rpi_preint_scale(&p, 2000.0, 24000.0);
+		}
+	}
+	for (i = 0; i < n && i < m; i++) {
+		for (k = 0; k < 3; k++) {
+			bad += fabsf(got[i].dtheta[k] - ref[i].dtheta[k]) > 1e-6f;
+			bad += fabsf(got[i].dvel[k] - ref[i].dvel[k]) > 1e-5f;
+		}
+	}
+	bad += (m != n || stops != 2);
+	printf("range     stopped %d times, %d increments %s\n", stops - 1, m,
+		bad? "FAIL": "OK");
+	return bad? 1: 0;
+}
+
+int main(int argc, char* argv[]) {
+	rpi_preint_t p;
+	double t;
+	long outs = 0;
+	int i, l, row, fail = 0;
+
+	fail += accuracy(0);
+	fail += accuracy(1);
+	fail += range_switch();
+
+	// 2kHz BMI088 rows, 2000dps and 24g
+	rpi_preint_init(&p, SAMPLE_NS, PERIOD_NS);
+	rpi_preint_scale(&p, 2000.0, 24000.0);
+	block.count = RPI_BLOCK_LEN;
+	for (i = 0; i < RPI_BLOCK_LEN; i++) {
+		block.flags[i] = RPI_SAMPLE_ACC | RPI_SAMPLE_GYR;
+		block.gyr[0][i] = 3000 * sin(i * 0.3);
+		block.gyr[1][i] = 3000 * cos(i * 0.3);
+		block.gyr[2][i] = 40;
+		block.acc[1][i] = 800 * sin(i * 0.3);
+		block.acc[2][i] = 1365;
+	}
+	t = now();
+	for (l = 0; l < LOOPS; l++) {
+		block.ts[0] = ((uint64_t)l * RPI_BLOCK_LEN + 1) * SAMPLE_NS;
+		for (i = 1; i < RPI_BLOCK_LEN; i++) {
+			block.ts[i] = block.ts[i - 1] + SAMPLE_NS;
+		}
+		row = 0;
+		outs += rpi_preint_block(&p, &block, &row, deltas);
+	}
+	t = now() - t;
+	printf("block     %ld increments, %.1f ns/sample\n",
+		outs, t * 1e9 / ((double)LOOPS * RPI_BLOCK_LEN));
+	if (outs != (long)LOOPS * RPI_BLOCK_LEN * SAMPLE_NS / PERIOD_NS) {
+		fail++;
+	}
+
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * Test of the ICM20600 configuration traffic, through the record transport
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "rpi_icm20600.h"
+#include "rpi_transport.h"
+
+#define ADDR		ICM20600_I2C_ADDR1
+#define MARK		0x50		// no device, phases of the log
+#define SMPLRT_DIV	0x19
+#define GYRO_CONFIG	0x1B
+#define PWR_MGMT_1	0x6B
+#define PHASES		8
+
+static const icm20600_cfg_t conf = {
+	RANGE_250_DPS, GYRO_RATE_1K_BW_176, GYRO_AVERAGE_1,
+	RANGE_4G, ACC_RATE_1K_BW_420, ACC_AVERAGE_4,
+	ICM_6AXIS_LOW_NOISE, 0
+};
+
+// a record of the log, as rpi_transport_record() writes it
+typedef struct {
+	uint8_t op;		// 'R' or 'W'
+	uint8_t dev;
+	uint8_t reg;
+	int8_t status;
+	uint16_t len;
+	uint16_t reserved;
+	uint64_t ts;
+} record_t;
+
+// transactions of one phase
+typedef struct {
+	int reads;		// of the ICM, besides WHO_AM_I
+	int writes;
+	uint8_t reg[16];	// of the writes
+	uint16_t len[16];
+} phase_t;
+
+static phase_t phase[PHASES];
+
+static void mark(rpi_transport_t* tr, int n) {
+	rpi_tr_read_byte(tr, MARK, n);
+}
+
+// the log by phase, return phases seen, <0: not a log
+static int parse(const char* path) {
+	char magic[8];
+	uint8_t data[4096];
+	record_t r;
+	phase_t* p = &phase[0];
+	int n = 1;
+	FILE* fp;
+
+	if ((fp = fopen(path, "rb")) == NULL) {
+		return -1;
+	}
+	if (fread(magic, 8, 1, fp) != 1 || memcmp(magic, "RPITR001", 8)) {
+		fclose(fp);
+		return -1;
+	}
+	while (fread(&r, sizeof r, 1, fp) == 1 && r.len <= sizeof data &&
+	       fread(data, 1, r.len, fp) == r.len) {
+		if (r.dev == MARK) {
+			p = &phase[(r.reg < PHASES)? r.reg: 0];
+			n++;
+		} else if (r.dev != ADDR) {
+			continue;
+		} else if (r.op == 'R' && r.reg != 0x75) {
+			p->reads++;
+		} else if (r.op == 'W' && p->writes < 16) {
+			p->reg[p->writes] = r.reg;
+			p->len[p->writes++] = r.len;
+		}
+	}
+	fclose(fp);
+	return n;
+}
+
+// one write of len at reg in phase n
+static int has_write(int n, uint8_t reg, uint16_t len) {
+	int i;
+
+	for (i = 0; i < phase[n].writes; i++) {
+		if (phase[n].reg[i] == reg && phase[n].len[i] == len) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int check(const char* name, int ok) {
+	printf("%-9s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+int main(int argc, char* argv[]) {
+	char path[] = "/tmp/test_record.XXXXXX";
+	icm20600_cfg_t other = conf;
+	rpi_transport_t *emu, *tr;
+	rpi_icm20600_t icm;
+	int fd, n, fail = 0;
+
+	if ((fd = mkstemp(path)) < 0) {
+		return 1;
+	}
+	close(fd);
+
+	emu = rpi_transport_emu();
+	rpi_transport_emu_regs(emu, ADDR)[0x75] = 0x11;
+	tr = rpi_transport_record(emu, path);
+	if (tr == NULL) {
+		return 1;
+	}
+
+	// 0: init, 1: a setter, 2: the same value again,
+	// 3: three neighbours changed, 4: power mode
+	n = rpi_icm20600_init_tr(&icm, tr, ADDR, &conf) == 0x11;
+	mark(tr, 1);
+	n = n && icm20600_set_gyro_range(&icm, RANGE_2K_DPS) == 0;
+	mark(tr, 2);
+	n = n && icm20600_set_gyro_range(&icm, RANGE_2K_DPS) == 0;
+	mark(tr, 3);
+	other.gyro_range = RANGE_1K_DPS;
+	other.acc_range = RANGE_16G;
+	other.acc_rate = ACC_RATE_1K_BW_218;
+	n = n && rpi_icm20600_configure(&icm, &other) == 0;
+	mark(tr, 4);
+	n = n && icm20600_set_power_mode(&icm, ICM_ACC_LOW_POWER) == 0;
+	rpi_transport_close(tr);
+	rpi_transport_close(emu);
+	if (!n || parse(path) != 5) {
+		printf("record   : FAIL\n");
+		unlink(path);
+		return 1;
+	}
+
+	// nothing read back, the configuration in a few bursts
+	fail += check("init", phase[0].reads == 0 && phase[0].writes <= 5 &&
+		has_write(0, SMPLRT_DIV, 6));
+
+	// a setter writes its register only, unchanged it writes nothing
+	fail += check("setter", phase[1].reads == 0 && phase[1].writes == 1 &&
+		has_write(1, GYRO_CONFIG, 1));
+	fail += check("same", phase[2].reads == 0 && phase[2].writes == 0);
+
+	// GYRO_CONFIG .. ACCEL_CONFIG2 changed: one write of three
+	fail += check("burst", phase[3].reads == 0 && phase[3].writes == 1 &&
+		has_write(3, GYRO_CONFIG, 3));
+
+	// PWR_MGMT_1 and 2 together
+	fail += check("power", phase[4].reads == 0 && phase[4].writes == 1 &&
+		has_write(4, PWR_MGMT_1, 2));
+
+	unlink(path);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
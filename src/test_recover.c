@@ -0,0 +1,141 @@
+/*
+ * Test of BMI088 fault recovery on the emulator
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "rpi_bmi088.h"
+
+#define ACC		BMI08X_ACCEL_I2C_ADDR_PRIMARY
+#define GYR		BMI08X_GYRO_I2C_ADDR_PRIMARY
+
+/* gyro bandwidth left at its reset value, 532Hz */
+static const struct bmi08x_cfg acc_cfg = {
+	.power = BMI08X_ACCEL_PM_ACTIVE,
+	.range = BMI088_ACCEL_RANGE_6G,
+	.bw    = BMI08X_ACCEL_BW_NORMAL,
+	.odr   = BMI08X_ACCEL_ODR_400_HZ,
+};
+static const struct bmi08x_cfg gyr_cfg = {
+	.power = BMI08X_GYRO_PM_NORMAL,
+	.range = BMI08X_GYRO_RANGE_1000_DPS,
+	.bw    = BMI08X_GYRO_BW_532_ODR_2000_HZ,
+	.odr   = BMI08X_GYRO_BW_532_ODR_2000_HZ,
+};
+
+/* virtual times the accel power registers were written */
+static uint64_t pwr_conf_ts, pwr_ctrl_ts;
+
+static void on_access(rpi_transport_t* tr, uint8_t dev, uint8_t reg,
+                      uint16_t len, int is_read, void* arg) {
+	if (is_read || dev != ACC) {
+		return;
+	}
+	if (reg == 0x7C) {
+		pwr_conf_ts = rpi_tr_timestamp(tr);
+	} else if (reg == 0x7D) {
+		pwr_ctrl_ts = rpi_tr_timestamp(tr);
+	}
+}
+
+/* power on values of the configuration registers */
+static void chip_reset(uint8_t* acc, uint8_t* gyr) {
+	if (acc != NULL) {
+		acc[0x40] = 0xA8;
+		acc[0x41] = 0x01;
+		acc[0x7C] = 0x03;
+		acc[0x7D] = 0x00;
+	}
+	if (gyr != NULL) {
+		gyr[0x0F] = 0x00;
+		gyr[0x10] = 0x80;
+		gyr[0x11] = 0x00;
+	}
+}
+
+static int check(const char* name, int ok) {
+	printf("%-12s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+int main(int argc, char* argv[]) {
+	rpi_bmi088_t bmi;
+	rpi_transport_t* tr;
+	uint8_t *acc, *gyr;
+	double x, y, z;
+	int st, fail = 0;
+
+	tr = rpi_transport_emu();
+	acc = rpi_transport_emu_regs(tr, ACC);
+	gyr = rpi_transport_emu_regs(tr, GYR);
+	acc[BMI08X_ACCEL_CHIP_ID_REG] = BMI088_ACCEL_CHIP_ID;
+	gyr[BMI08X_GYRO_CHIP_ID_REG] = BMI08X_GYRO_CHIP_ID;
+	chip_reset(acc, gyr);
+
+	if (rpi_bmi088_init_tr(&bmi, tr, ACC, GYR, &acc_cfg, &gyr_cfg) != BMI08X_OK) {
+		printf("init        : FAIL\n");
+		return 1;
+	}
+	/* the configuration through the driver's own shadow, all written */
+	rpi_bmi088_reconfigure(&bmi, &acc_cfg, &gyr_cfg);
+	rpi_bmi088_get_gyro(&bmi, &x, &y, &z);
+	rpi_bmi088_status(&bmi);
+
+	/* a failed read drops the sample, the chips kept their setup */
+	rpi_tr_delay_ms(tr, RPI_TEMP_PERIOD / 1000000);
+	rpi_transport_emu_fail(tr, 1);
+	st = rpi_bmi088_get_accel(&bmi, &x, &y, &z);
+	fail += check("bus fault", st != BMI08X_OK &&
+		rpi_bmi088_status(&bmi) == RPI_STATUS_COM_FAIL);
+
+	/* gyro alone back at power on, bandwidth still reads 0x80 */
+	chip_reset(NULL, gyr);
+	st = rpi_bmi088_recover(&bmi);
+	fail += check("gyro reset", st == BMI08X_OK &&
+		rpi_bmi088_status(&bmi) == (RPI_STATUS_RESET | RPI_STATUS_RECOVERED) &&
+		gyr[0x0F] == gyr_cfg.range);
+
+	/* accel powered up again with its settle times */
+	chip_reset(acc, NULL);
+	rpi_transport_emu_hook(tr, on_access, NULL);
+	st = rpi_bmi088_recover(&bmi);
+	fail += check("accel reset", st == BMI08X_OK &&
+		rpi_bmi088_status(&bmi) == (RPI_STATUS_RESET | RPI_STATUS_RECOVERED) &&
+		acc[0x7D] == BMI08X_ACCEL_POWER_ENABLE);
+	fail += check("accel power", pwr_conf_ts != 0 &&
+		pwr_ctrl_ts - pwr_conf_ts >= 5000000ULL &&
+		rpi_tr_timestamp(tr) - pwr_ctrl_ts >= 5000000ULL);
+
+	/* nothing wrong, nothing done */
+	st = rpi_bmi088_recover(&bmi);
+	fail += check("no reset", st == BMI08X_OK && rpi_bmi088_status(&bmi) == 0);
+
+	rpi_bmi088_deinit(&bmi);
+	rpi_transport_close(tr);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
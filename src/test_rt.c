@@ -0,0 +1,130 @@
+/*
+ * Test of the wake-up jitter statistics
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rpi_rt.h"
+
+static uint64_t now_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void add(rpi_rt_jitter_t* j, int n, uint64_t late) {
+	while (n-- > 0) {
+		rpi_rt_jitter_add(j, late);
+	}
+}
+
+// lines of the report, the first one in head
+static int report(const rpi_rt_jitter_t* j, char* head, size_t len, char** text) {
+	size_t size;
+	FILE* fp;
+	char* p;
+	int lines = 0;
+
+	fp = open_memstream(text, &size);
+	rpi_rt_jitter_report(j, fp);
+	fclose(fp);
+	for (p = *text; *p; p++) {
+		lines += (*p == '\n');
+	}
+	snprintf(head, len, "%.*s", (int)strcspn(*text, "\n"), *text);
+	return lines;
+}
+
+static int check(const char* name, int ok) {
+	printf("%-9s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+int main(int argc, char* argv[]) {
+	rpi_rt_jitter_t j;
+	char head[256];
+	char* text;
+	uint64_t t;
+	int lines, i, fail = 0;
+
+	// 1us, 15us, 150us and one beyond the last bucket
+	memset(&j, 0, sizeof j);
+	add(&j, 900, 1000);
+	add(&j, 90, 15000);
+	add(&j, 9, 150000);
+	add(&j, 1, 500000);
+	i = j.count == 1000 && j.max == 500000 &&
+	    j.hist[0] == 900 && j.hist[7] == 90 && j.hist[75] == 9 &&
+	    j.hist[RPI_RT_BUCKETS - 1] == 1;
+	fail += check("add", i);
+
+	// bucket upper bounds, the open one reports the max
+	i = rpi_rt_jitter_quantile(&j, 0.50) == 2000 &&
+	    rpi_rt_jitter_quantile(&j, 0.99) == 16000 &&
+	    rpi_rt_jitter_quantile(&j, 0.999) == 152000 &&
+	    rpi_rt_jitter_quantile(&j, 1.0) == 500000;
+	fail += check("quantile", i);
+
+	// a bound is never above the largest one seen
+	memset(&j, 0, sizeof j);
+	add(&j, 10, 700);
+	i = rpi_rt_jitter_quantile(&j, 0.5) == 700;
+	memset(&j, 0, sizeof j);
+	i = i && rpi_rt_jitter_quantile(&j, 0.5) == 0;
+	fail += check("bounds", i);
+
+	// summary, then rows of 10us up to the last one used
+	lines = report(&j, head, sizeof head, &text);
+	i = lines == 1 && strcmp(head, "no wake-ups") == 0;
+	free(text);
+	add(&j, 900, 1000);
+	add(&j, 100, 25000);
+	lines = report(&j, head, sizeof head, &text);
+	i = i && lines == 1 + 3 &&
+	    strstr(head, "wake-ups 1000, mean 3.4 us, p50 2.0 us") == head &&
+	    strstr(text, "  0 -  10 us        900 ###") != NULL &&
+	    strstr(text, " 20 -  30 us        100 #####\n") != NULL;
+	free(text);
+	add(&j, 1, 300000);
+	lines = report(&j, head, sizeof head, &text);
+	i = i && lines == 1 + (RPI_RT_BUCKETS - 1) / 5 + 1 &&
+	    strstr(text, "   >= 200 us          1 #\n") != NULL;
+	free(text);
+	fail += check("report", i);
+
+	// never early
+	t = now_ns() + 2000000;
+	rpi_rt_sleep_until(t);
+	fail += check("sleep", now_ns() >= t);
+
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * Test of the Welch spectrum
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <math.h>
+#include "rpi_spectrum.h"
+
+#define FS		1000.0f
+#define N		256
+#define HOP		(N / 2)
+#define COUNT		(N * 16)
+#define TONE		125.0f		// on bin 32
+#define AMP		2.0f
+#define DC		5.0f
+
+static float x[COUNT], y[COUNT], z[COUNT];
+static float psd[N / 2 + 1];
+
+static int near(double a, double b, double tol) {
+	return fabs(a - b) <= tol * fabs(b);
+}
+
+int main(int argc, char* argv[]) {
+	static const float edges[] = { 0.0f, 100.0f, 150.0f, 500.0f };
+	rpi_spectrum_summary_t sum;
+	rpi_spectrum_t sp;
+	double power;
+	int i, n, frames, bad, fail = 0;
+
+	// x: tone on a DC offset, y: quiet, z: tone at a quarter amplitude
+	for (i = 0; i < COUNT; i++) {
+		x[i] = DC + AMP * sinf(2 * M_PI * TONE * i / FS);
+		y[i] = 0.0f;
+		z[i] = AMP / 4 * sinf(2 * M_PI * TONE * i / FS);
+	}
+	if (rpi_spectrum_init(&sp, N, HOP, FS) < 0) {
+		printf("init     : FAIL\n");
+		return 1;
+	}
+
+	// in two calls, a frame completes across them
+	frames = rpi_spectrum_push(&sp, x, y, z, COUNT / 2 + 7);
+	frames += rpi_spectrum_push(&sp, x + COUNT / 2 + 7, y + COUNT / 2 + 7,
+		z + COUNT / 2 + 7, COUNT / 2 - 7);
+	bad = frames != (COUNT - N) / HOP + 1;
+	printf("frames   : %d %s\n", frames, bad? "FAIL": "OK");
+	fail += bad;
+
+	// Parseval: the one-sided PSD sums to the tone's power A^2 / 2
+	n = rpi_spectrum_psd(&sp, 0, psd);
+	for (i = 1, power = 0.0; i < n; i++) {
+		power += psd[i] * FS / N;
+	}
+	bad = n != N / 2 + 1 || !near(power, AMP * AMP / 2, 0.05);
+	printf("psd      : %.3f %s\n", power, bad? "FAIL": "OK");
+	fail += bad;
+
+	// the summary leaves DC out and finds the tone in its band
+	bad = rpi_spectrum_summary(&sp, edges, 3, &sum) != 0;
+	bad += !near(sum.rms[0], AMP / sqrt(2.0), 0.05) ||
+	       !near(sum.rms[2], AMP / 4 / sqrt(2.0), 0.05) ||
+	       sum.rms[1] != 0.0f;
+	bad += !near(sum.peak_hz[0], TONE, 0.01) || !near(sum.peak_hz[2], TONE, 0.01);
+	bad += !near(sum.band[0][1], AMP * AMP / 2, 0.05) ||
+	       sum.band[0][2] > 0.01 * sum.band[0][1];
+	printf("summary  : rms %.3f peak %.1f Hz %s\n",
+		sum.rms[0], sum.peak_hz[0], bad? "FAIL": "OK");
+	fail += bad;
+
+	// a new average starts empty
+	rpi_spectrum_clear(&sp);
+	bad = rpi_spectrum_summary(&sp, edges, 3, &sum) == 0;
+	printf("clear    : %s\n", bad? "FAIL": "OK");
+	fail += bad;
+
+	rpi_spectrum_free(&sp);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
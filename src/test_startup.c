@@ -0,0 +1,118 @@
+/*
+ * Test of the parallel startup on the emulator
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include "rpi_bmi088.h"
+#include "rpi_icm20600.h"
+
+#define BMI_COUNT	3
+#define NS_PER_MS	1000000ULL
+
+/*
+ * One register space stands for several buses, so every chip gets
+ * an address of its own: accels from 0x18, gyros from 0x6A.
+ */
+#define ACC_ADDR(i)	(BMI08X_ACCEL_I2C_ADDR_PRIMARY + (i))
+#define GYR_ADDR(i)	(0x6A + (i))
+#define ICM_ADDR	ICM20600_I2C_ADDR0
+
+static const struct bmi08x_cfg acc_cfg = {
+	.power = BMI08X_ACCEL_PM_ACTIVE,
+	.range = BMI088_ACCEL_RANGE_6G,
+	.bw    = BMI08X_ACCEL_BW_NORMAL,
+	.odr   = BMI08X_ACCEL_ODR_400_HZ,
+};
+static const struct bmi08x_cfg gyr_cfg = {
+	.power = BMI08X_GYRO_PM_NORMAL,
+	.range = BMI08X_GYRO_RANGE_1000_DPS,
+	.bw    = BMI08X_GYRO_BW_47_ODR_400_HZ,
+	.odr   = BMI08X_GYRO_BW_47_ODR_400_HZ,
+};
+static const icm20600_cfg_t icm_cfg = {
+	RANGE_2K_DPS, GYRO_RATE_1K_BW_176, GYRO_AVERAGE_1,
+	RANGE_16G, ACC_RATE_1K_BW_420, ACC_AVERAGE_4,
+	ICM_6AXIS_LOW_NOISE, 0
+};
+
+static rpi_bmi088_t bmi[BMI_COUNT];
+static rpi_icm20600_t icm;
+
+static void jobs_fill(rpi_startup_t* jobs, rpi_transport_t* tr) {
+	int i;
+
+	for (i = 0; i < BMI_COUNT; i++) {
+		rpi_bmi088_startup(&jobs[i], &bmi[i], tr,
+			ACC_ADDR(i), GYR_ADDR(i), &acc_cfg, &gyr_cfg);
+	}
+	rpi_icm20600_startup(&jobs[i], &icm, tr, ICM_ADDR, &icm_cfg);
+}
+
+int main(int argc, char* argv[]) {
+	rpi_startup_t jobs[BMI_COUNT + 1];
+	rpi_transport_t* tr;
+	uint64_t t0, serial, parallel;
+	int i, failed, fail = 0;
+
+	tr = rpi_transport_emu();
+	for (i = 0; i < BMI_COUNT; i++) {
+		rpi_transport_emu_regs(tr, ACC_ADDR(i))[BMI08X_ACCEL_CHIP_ID_REG] =
+			BMI088_ACCEL_CHIP_ID;
+		rpi_transport_emu_regs(tr, GYR_ADDR(i))[BMI08X_GYRO_CHIP_ID_REG] =
+			BMI08X_GYRO_CHIP_ID;
+	}
+	rpi_transport_emu_regs(tr, ICM_ADDR)[0x75] = 0x11;
+
+	// one after the other
+	jobs_fill(jobs, tr);
+	t0 = rpi_tr_timestamp(tr);
+	for (i = failed = 0; i < BMI_COUNT + 1; i++) {
+		failed += rpi_startup_run(&jobs[i], 1);
+	}
+	serial = rpi_tr_timestamp(tr) - t0;
+	printf("serial   : %3llu ms %s\n", (unsigned long long)(serial / NS_PER_MS),
+		failed? "FAIL": "OK");
+	fail += failed != 0;
+
+	// all at once, up after the longest single startup, the gyro's 30ms
+	jobs_fill(jobs, tr);
+	t0 = rpi_tr_timestamp(tr);
+	failed = rpi_startup_run(jobs, BMI_COUNT + 1);
+	parallel = rpi_tr_timestamp(tr) - t0;
+	i = failed == 0 && jobs[BMI_COUNT].rt == 0x11 &&
+	    parallel >= 30 * NS_PER_MS && parallel <= 31 * NS_PER_MS;
+	printf("parallel : %3llu ms %s\n", (unsigned long long)(parallel / NS_PER_MS),
+		i? "OK": "FAIL");
+	fail += !i;
+
+	for (i = 0; i < BMI_COUNT; i++) {
+		rpi_bmi088_deinit(&bmi[i]);
+	}
+	rpi_transport_close(tr);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
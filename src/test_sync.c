@@ -0,0 +1,157 @@
+/*
+ * Test of BMI088 data sync on the emulator
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "rpi_bmi088.h"
+
+#define ACC		BMI08X_ACCEL_I2C_ADDR_PRIMARY
+#define GYR		BMI08X_GYRO_I2C_ADDR_PRIMARY
+#define ACC_CONF	0x40
+#define GYRO_BW		0x10
+#define READS		(2 * RPI_CHECK_PERIOD + 1)
+
+static const struct bmi08x_cfg acc_cfg = {
+	.power = BMI08X_ACCEL_PM_ACTIVE,
+	.range = BMI088_ACCEL_RANGE_6G,
+	.bw    = BMI08X_ACCEL_BW_NORMAL,
+	.odr   = BMI08X_ACCEL_ODR_400_HZ,
+};
+static const struct bmi08x_cfg gyr_cfg = {
+	.power = BMI08X_GYRO_PM_NORMAL,
+	.range = BMI08X_GYRO_RANGE_1000_DPS,
+	.bw    = BMI08X_GYRO_BW_532_ODR_2000_HZ,
+	.odr   = BMI08X_GYRO_BW_532_ODR_2000_HZ,
+};
+
+/* writes per register since the last clear */
+static int acc_writes[256], gyr_writes[256];
+
+static void on_access(rpi_transport_t* tr, uint8_t dev, uint8_t reg,
+                      uint16_t len, int is_read, void* arg) {
+	if (!is_read && dev == ACC) {
+		acc_writes[reg]++;
+	} else if (!is_read && dev == GYR) {
+		gyr_writes[reg]++;
+	}
+}
+
+static void writes_clear(void) {
+	memset(acc_writes, 0, sizeof acc_writes);
+	memset(gyr_writes, 0, sizeof gyr_writes);
+}
+
+/* power on values of the configuration registers */
+static void chip_reset(uint8_t* acc, uint8_t* gyr) {
+	acc[0x40] = 0xA8;
+	acc[0x41] = 0x01;
+	acc[0x7C] = 0x03;
+	acc[0x7D] = 0x00;
+	gyr[0x0F] = 0x00;
+	gyr[0x10] = 0x80;
+	gyr[0x11] = 0x00;
+}
+
+/* n pairs, every one read, return -1: any failed */
+static int read_pairs(rpi_bmi088_t* bmi, int n) {
+	double acc[3], gyr[3];
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (rpi_bmi088_get_sync(bmi, acc, gyr) != BMI08X_OK) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int check(const char* name, int ok) {
+	printf("%-9s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+int main(int argc, char* argv[]) {
+	rpi_bmi088_t bmi;
+	rpi_transport_t* tr;
+	uint8_t *acc, *gyr;
+	uint8_t acc_conf, gyro_bw;
+	double a[3], g[3];
+	int st, fail = 0;
+
+	tr = rpi_transport_emu();
+	acc = rpi_transport_emu_regs(tr, ACC);
+	gyr = rpi_transport_emu_regs(tr, GYR);
+	acc[BMI08X_ACCEL_CHIP_ID_REG] = BMI088_ACCEL_CHIP_ID;
+	gyr[BMI08X_GYRO_CHIP_ID_REG] = BMI08X_GYRO_CHIP_ID;
+	chip_reset(acc, gyr);
+
+	if (rpi_bmi088_init_tr(&bmi, tr, ACC, GYR, &acc_cfg, &gyr_cfg) != BMI08X_OK) {
+		printf("init     : FAIL\n");
+		return 1;
+	}
+	rpi_transport_emu_hook(tr, on_access, NULL);
+
+	/* no pair before data sync is on */
+	st = rpi_bmi088_get_sync(&bmi, a, g);
+	fail += check("off", st == BMI08X_E_INVALID_CONFIG);
+
+	/* the sync rate goes to both chips */
+	writes_clear();
+	st = rpi_bmi088_set_sync(&bmi, BMI08X_ACCEL_DATA_SYNC_MODE_2000HZ);
+	acc_conf = acc[ACC_CONF];
+	gyro_bw = gyr[GYRO_BW];
+	fail += check("writes", st == BMI08X_OK &&
+		acc_writes[ACC_CONF] > 0 &&
+		gyr_writes[GYRO_BW] > 0);
+
+	/* health checks on the way find the chips as set_sync left them */
+	writes_clear();
+	rpi_bmi088_status(&bmi);
+	st = read_pairs(&bmi, READS);
+	fail += check("check", st == 0 && rpi_bmi088_status(&bmi) == 0 &&
+		acc_writes[ACC_CONF] == 0 &&
+		gyr_writes[GYRO_BW] == 0 &&
+		acc[ACC_CONF] == acc_conf &&
+		gyr[GYRO_BW] == gyro_bw);
+
+	/* both chips reset: sync loaded again, then the checks stay quiet */
+	chip_reset(acc, gyr);
+	st = rpi_bmi088_recover(&bmi);
+	fail += check("recover", st == BMI08X_OK &&
+		rpi_bmi088_status(&bmi) == (RPI_STATUS_RESET | RPI_STATUS_RECOVERED) &&
+		acc[ACC_CONF] == acc_conf &&
+		gyr[GYRO_BW] == gyro_bw);
+	st = read_pairs(&bmi, READS);
+	fail += check("resync", st == 0 && rpi_bmi088_status(&bmi) == 0 &&
+		acc[ACC_CONF] == acc_conf);
+
+	rpi_bmi088_deinit(&bmi);
+	rpi_transport_close(tr);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * Test of the temperature compensation
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "rpi_tcomp.h"
+
+#define RAW_MAX		0x8000
+#define COUNT		1000
+
+static int16_t raw[COUNT * 3];
+static float ox[COUNT], oy[COUNT], oz[COUNT];
+
+static int same(double a, double b) {
+	return fabs(a - b) <= 1e-3 * (1.0 + fabs(b));
+}
+
+/*
+ * The folded batch conversion against the per sample path of the
+ * drivers: converted, compensated, then aligned.
+ */
+static int fold(const rpi_tcomp_t* tc, float t, const float* align) {
+	const float scale[3] = {
+		6000.0f / RAW_MAX, 6000.0f / RAW_MAX, 6000.0f / RAW_MAX
+	};
+	const float offset[3] = { 12.5f, -3.0f, 7.25f };
+	rpi_tconvert_t tcv;
+	double v[3], w[3];
+	int i, a, bad = 0;
+
+	rpi_tconvert_init(&tcv, tc, scale, offset, align);
+	rpi_convert_s16x3(rpi_tconvert_at(&tcv, t), raw, COUNT, ox, oy, oz);
+	for (i = 0; i < COUNT; i++) {
+		for (a = 0; a < 3; a++) {
+			v[a] = raw[i * 3 + a] * (double)scale[a] + offset[a];
+		}
+		rpi_tcomp_apply(tc, t, v);
+		for (a = 0; a < 3; a++) {
+			w[a] = align[a * 3] * v[0] + align[a * 3 + 1] * v[1] +
+			       align[a * 3 + 2] * v[2];
+		}
+		bad += !same(ox[i], w[0]) || !same(oy[i], w[1]) || !same(oz[i], w[2]);
+	}
+	return bad;
+}
+
+int main(int argc, char* argv[]) {
+	static const float identity[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+	static const float rotate[9] = { 0, -1, 0, 1, 0, 0, 0, 0, 1 };
+	rpi_tcomp_t poly = { 0 }, lut;
+	float bias[3], gain[3];
+	int i, a, bad, fail = 0;
+
+	srand(1);
+	for (i = 0; i < COUNT * 3; i++) {
+		raw[i] = (int16_t)(rand() & 0xFFFF);
+	}
+
+	// bias 20 mg + 0.5 mg/C, gain 1e-4/C around 25C
+	poly.type = RPI_TCOMP_POLY;
+	poly.order = 1;
+	poly.t_ref = 25.0f;
+	for (a = 0; a < 3; a++) {
+		poly.bias[a][0] = 20.0f;
+		poly.bias[a][1] = 0.5f;
+		poly.gain[a][1] = 1e-4f;
+	}
+
+	// the same line in a table, 0 .. 75C every 5C
+	bad = rpi_tcomp_lut_init(&lut, 0.0f, 0.0f, 16) == 0;
+	bad += rpi_tcomp_lut_init(&lut, 0.0f, 5.0f, RPI_TCOMP_POINTS + 1) == 0;
+	bad += rpi_tcomp_lut_init(&lut, 0.0f, 5.0f, 16) != 0;
+	for (i = 0; i < lut.points; i++) {
+		rpi_tcomp_eval(&poly, lut.t0 + i * lut.dt, lut.lut_bias[i], lut.lut_gain[i]);
+	}
+	printf("lut init : %s\n", bad? "FAIL": "OK");
+	fail += bad;
+
+	// linear in between, clamped outside
+	rpi_tcomp_eval(&lut, 37.5f, bias, gain);
+	bad = !same(bias[0], 26.25) || !same(gain[2], 1.25e-3);
+	rpi_tcomp_eval(&lut, -40.0f, bias, gain);
+	bad += !same(bias[1], 7.5);
+	rpi_tcomp_eval(&lut, 120.0f, bias, gain);
+	bad += !same(bias[1], 45.0);
+	printf("lut eval : %s\n", bad? "FAIL": "OK");
+	fail += bad;
+
+	bad = fold(&poly, 41.3f, identity) + fold(&poly, -5.0f, rotate) +
+	      fold(&lut, 63.0f, rotate);
+	printf("fold     : %s\n", bad? "FAIL": "OK");
+	fail += bad;
+
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * Test of the latency trace, built with make TRACE=1
+ *
+ * Author      : Peter Yang
+ * Create Time : Oct 2026
+ * Change Log  :
+ *     10:00 2026/10/19 Initial version
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software", to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "rpi_trace.h"
+
+#define T0		1000000000ULL
+#define SHORT_NS	300		// bucket 8
+#define LONG_NS		5000		// bucket 12
+#define SPANS		100
+#define WORKER_SPANS	50
+
+static int check(const char* name, int ok) {
+	printf("%-9s: %s\n", name, ok? "OK": "FAIL");
+	return !ok;
+}
+
+static uint64_t hist_total(int stage) {
+	uint64_t hist[RPI_TRACE_BUCKETS], n = 0;
+	int i;
+
+	rpi_trace_hist(stage, hist);
+	for (i = 0; i < RPI_TRACE_BUCKETS; i++) {
+		n += hist[i];
+	}
+	return n;
+}
+
+#if RPI_TRACE
+static void* worker(void* arg) {
+	int i;
+
+	rpi_trace_thread("worker");
+	for (i = 0; i < WORKER_SPANS; i++) {
+		RPI_TRACE_SPAN(RPI_TRACE_ENQUEUE, T0 + i * 1000, T0 + i * 1000 + SHORT_NS);
+	}
+	return NULL;
+}
+
+// occurrences of what in the file at path, -1: unreadable
+static int count_in(const char* path, const char* what, char* text, size_t size) {
+	const char* p;
+	size_t len;
+	FILE* fp;
+	int n = 0;
+
+	if ((fp = fopen(path, "r")) == NULL) {
+		return -1;
+	}
+	len = fread(text, 1, size - 1, fp);
+	fclose(fp);
+	text[len] = '\0';
+	for (p = text; (p = strstr(p, what)) != NULL; p += strlen(what)) {
+		n++;
+	}
+	return n;
+}
+#endif
+
+int main(int argc, char* argv[]) {
+	char path[] = "/tmp/test_trace.XXXXXX";
+	uint64_t hist[RPI_TRACE_BUCKETS];
+	int fd, i, fail = 0;
+#if RPI_TRACE
+	size_t size = 1 << 20;
+	pthread_t th;
+	char* text;
+	int n;
+#endif
+
+	if ((fd = mkstemp(path)) < 0) {
+		return 1;
+	}
+	close(fd);
+
+#if RPI_TRACE
+	// spans of known lengths land in their power of 2 buckets
+	rpi_trace_thread("main");
+	for (i = 0; i < SPANS; i++) {
+		RPI_TRACE_SPAN(RPI_TRACE_XFER, T0 + i * 10000, T0 + i * 10000 +
+			((i & 1)? LONG_NS: SHORT_NS));
+	}
+	// other clocks and an end without its begin are dropped
+	RPI_TRACE_SPAN(RPI_TRACE_XFER, 0, T0);
+	RPI_TRACE_SPAN(RPI_TRACE_XFER, T0 + 1, T0);
+	RPI_TRACE_END(RPI_TRACE_DECODE);
+	rpi_trace_hist(RPI_TRACE_XFER, hist);
+	fail += check("hist", hist[8] == SPANS / 2 && hist[12] == SPANS / 2 &&
+		hist_total(RPI_TRACE_XFER) == SPANS &&
+		hist_total(RPI_TRACE_DECODE) == 0);
+
+	// begin and end of this thread
+	for (i = 0; i < 10; i++) {
+		RPI_TRACE_BEGIN(RPI_TRACE_DECODE);
+		RPI_TRACE_END(RPI_TRACE_DECODE);
+	}
+	fail += check("begin end", hist_total(RPI_TRACE_DECODE) == 10);
+
+	// a second thread adds to the same histograms
+	i = pthread_create(&th, NULL, worker, NULL) == 0 &&
+	    pthread_join(th, NULL) == 0;
+	fail += check("threads", i && hist_total(RPI_TRACE_ENQUEUE) == WORKER_SPANS);
+
+	// every event as a complete event, both threads named
+	text = malloc(size);
+	i = text != NULL && rpi_trace_export(path) == 0;
+	n = i? count_in(path, "\"ph\":\"X\"", text, size): -1;
+	i = i && n == SPANS + 10 + WORKER_SPANS &&
+	    strncmp(text, "{\"traceEvents\":[", 16) == 0 &&
+	    strstr(text, "\"args\":{\"name\":\"main\"}") != NULL &&
+	    strstr(text, "\"args\":{\"name\":\"worker\"}") != NULL &&
+	    strstr(text, "\"name\":\"xfer\",\"cat\":\"rpi\",\"ph\":\"X\","
+	                 "\"ts\":1000000.000,\"dur\":0.300") != NULL &&
+	    strstr(text, "\"displayTimeUnit\":\"ns\"}") != NULL;
+	fail += check("export", i);
+	free(text);
+#else
+	// hooks empty, nothing to export
+	RPI_TRACE_SPAN(RPI_TRACE_XFER, T0, T0 + SHORT_NS);
+	rpi_trace_hist(RPI_TRACE_XFER, hist);
+	for (i = 0; i < RPI_TRACE_BUCKETS && hist[i] == 0; i++) {
+	}
+	fail += check("off", i == RPI_TRACE_BUCKETS && rpi_trace_export(path) < 0 &&
+		hist_total(RPI_TRACE_XFER) == 0);
+#endif
+
+	unlink(path);
+	printf("%s\n", fail? "FAIL": "OK");
+	return fail? 1: 0;
+}